@@ -26,6 +26,11 @@ struct Settings {
   bool dart_non_checked_mode = false;
   bool enable_software_rendering = false;
   bool using_blink = true;
+  // The budget of the GPU raster cache. Zero selects the default budget.
+  uint32_t raster_cache_max_megabytes = 0;
+  // Whether a frame that the GPU thread has not picked up yet is replaced by
+  // a newer one instead of delaying the newer one.
+  bool latest_frame_wins = false;
   std::string aot_shared_library_path;
   std::string aot_snapshot_path;
   std::string aot_vm_snapshot_data_filename;
@@ -4,6 +4,7 @@
 
 #include "flutter/common/threads.h"
 
+#include <atomic>
 #include <utility>
 
 namespace blink {
@@ -11,6 +12,8 @@ namespace {
 
 Threads* g_threads = nullptr;
 
+std::atomic<size_t> g_next_image_decode(0);
+
 }  // namespace
 
 Threads::Threads() {}
@@ -24,6 +27,17 @@ Threads::Threads(fxl::RefPtr<fxl::TaskRunner> platform,
       ui_(std::move(ui)),
       io_(std::move(io)) {}
 
+Threads::Threads(fxl::RefPtr<fxl::TaskRunner> platform,
+                 fxl::RefPtr<fml::TaskRunner> gpu,
+                 fxl::RefPtr<fml::TaskRunner> ui,
+                 fxl::RefPtr<fxl::TaskRunner> io)
+    : platform_(std::move(platform)),
+      gpu_(gpu),
+      ui_(ui),
+      io_(std::move(io)),
+      prioritized_gpu_(std::move(gpu)),
+      prioritized_ui_(std::move(ui)) {}
+
 Threads::~Threads() {}
 
 const fxl::RefPtr<fxl::TaskRunner>& Threads::Platform() {
@@ -42,6 +56,50 @@ const fxl::RefPtr<fxl::TaskRunner>& Threads::IO() {
   return Get().io_;
 }
 
+void Threads::PostGpuTask(fxl::Closure task, fml::TaskPriority priority) {
+  const Threads& threads = Get();
+  if (threads.prioritized_gpu_) {
+    threads.prioritized_gpu_->PostTask(std::move(task), priority);
+  } else {
+    threads.gpu_->PostTask(std::move(task));
+  }
+}
+
+void Threads::PostUITask(fxl::Closure task, fml::TaskPriority priority) {
+  const Threads& threads = Get();
+  if (threads.prioritized_ui_) {
+    threads.prioritized_ui_->PostTask(std::move(task), priority);
+  } else {
+    threads.ui_->PostTask(std::move(task));
+  }
+}
+
+void Threads::PostUITaskForTime(fxl::Closure task,
+                                fxl::TimePoint target_time,
+                                fml::TaskPriority priority) {
+  const Threads& threads = Get();
+  if (threads.prioritized_ui_) {
+    threads.prioritized_ui_->PostTaskForTime(std::move(task), target_time,
+                                             priority);
+  } else {
+    threads.ui_->PostTaskForTime(std::move(task), target_time);
+  }
+}
+
+fxl::RefPtr<fxl::TaskRunner> Threads::ImageDecode() {
+  const Threads& threads = Get();
+  if (threads.image_decode_.empty()) {
+    return threads.io_;
+  }
+  const size_t index = g_next_image_decode++ % threads.image_decode_.size();
+  return threads.image_decode_[index];
+}
+
+const fxl::RefPtr<fxl::TaskRunner>& Threads::TextLayout() {
+  const Threads& threads = Get();
+  return threads.text_layout_ ? threads.text_layout_ : threads.io_;
+}
+
 const Threads& Threads::Get() {
   FXL_CHECK(g_threads);
   return *g_threads;
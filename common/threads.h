@@ -5,6 +5,9 @@
 #ifndef FLUTTER_COMMON_THREADS_H_
 #define FLUTTER_COMMON_THREADS_H_
 
+#include <vector>
+
+#include "flutter/fml/task_runner.h"
 #include "lib/fxl/tasks/task_runner.h"
 
 #define ASSERT_IS_PLATFORM_THREAD \
@@ -25,6 +28,12 @@ class Threads {
           fxl::RefPtr<fxl::TaskRunner> gpu,
           fxl::RefPtr<fxl::TaskRunner> ui,
           fxl::RefPtr<fxl::TaskRunner> io);
+  // Threads whose GPU and UI threads run fml message loops, so that tasks can
+  // be posted to them with a priority.
+  Threads(fxl::RefPtr<fxl::TaskRunner> platform,
+          fxl::RefPtr<fml::TaskRunner> gpu,
+          fxl::RefPtr<fml::TaskRunner> ui,
+          fxl::RefPtr<fxl::TaskRunner> io);
   ~Threads();
 
   static const fxl::RefPtr<fxl::TaskRunner>& Platform();
@@ -32,8 +41,36 @@ class Threads {
   static const fxl::RefPtr<fxl::TaskRunner>& UI();
   static const fxl::RefPtr<fxl::TaskRunner>& IO();
 
+  // Post |task| to the GPU or UI thread with |priority|. The priority is
+  // dropped if the thread does not run an fml message loop.
+  static void PostGpuTask(fxl::Closure task, fml::TaskPriority priority);
+  static void PostUITask(fxl::Closure task, fml::TaskPriority priority);
+  static void PostUITaskForTime(fxl::Closure task,
+                                fxl::TimePoint target_time,
+                                fml::TaskPriority priority);
+
+  // Returns one of the image decode task runners, picking a different one on
+  // each call. Falls back to the IO task runner if there are none.
+  static fxl::RefPtr<fxl::TaskRunner> ImageDecode();
+
+  // Returns the task runner that paragraphs are laid out on when they are laid
+  // out asynchronously. Falls back to the IO task runner if there is none.
+  static const fxl::RefPtr<fxl::TaskRunner>& TextLayout();
+
   static void Set(const Threads& settings);
 
+  // Task runners that images are decoded on in parallel. Must be called
+  // before |Set|.
+  void set_image_decode(std::vector<fxl::RefPtr<fxl::TaskRunner>> runners) {
+    image_decode_ = std::move(runners);
+  }
+
+  // Task runner that paragraphs are laid out on asynchronously. Must be called
+  // before |Set|.
+  void set_text_layout(fxl::RefPtr<fxl::TaskRunner> runner) {
+    text_layout_ = std::move(runner);
+  }
+
  private:
   static const Threads& Get();
 
@@ -41,6 +78,11 @@ class Threads {
   fxl::RefPtr<fxl::TaskRunner> gpu_;
   fxl::RefPtr<fxl::TaskRunner> ui_;
   fxl::RefPtr<fxl::TaskRunner> io_;
+  // The GPU and UI task runners if they are fml task runners, or null.
+  fxl::RefPtr<fml::TaskRunner> prioritized_gpu_;
+  fxl::RefPtr<fml::TaskRunner> prioritized_ui_;
+  std::vector<fxl::RefPtr<fxl::TaskRunner>> image_decode_;
+  fxl::RefPtr<fxl::TaskRunner> text_layout_;
 };
 
 }  // namespace blink
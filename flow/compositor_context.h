@@ -62,6 +62,11 @@ class CompositorContext {
 
   RasterCache& raster_cache() { return raster_cache_; }
 
+  // Byte usage and hit/miss counts of the raster cache.
+  const RasterCache::Metrics& raster_cache_metrics() const {
+    return raster_cache_.metrics();
+  }
+
   TextureRegistry& texture_registry() { return *texture_registry_; }
 
   const Counter& frame_count() const { return frame_count_; }
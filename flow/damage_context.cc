@@ -0,0 +1,139 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/damage_context.h"
+
+#include "flutter/flow/fingerprint.h"
+#include "lib/fxl/logging.h"
+
+namespace flow {
+
+DamageContext::DamageContext()
+    : previous_frame_size_{},
+      current_frame_size_{},
+      has_previous_frame_(false),
+      has_current_frame_(false) {}
+
+DamageContext::~DamageContext() = default;
+
+DamageContext::AutoProperties::AutoProperties(DamageContext* context,
+                                              uint64_t properties)
+    : context_(context) {
+  const uint64_t parent =
+      context_->properties_.empty() ? 0 : context_->properties_.back();
+  context_->properties_.push_back(Fingerprint(properties, parent));
+}
+
+DamageContext::AutoProperties::~AutoProperties() {
+  FXL_DCHECK(!context_->properties_.empty());
+  context_->properties_.pop_back();
+}
+
+void DamageContext::Reset() {
+  current_entries_.clear();
+  has_current_frame_ = false;
+}
+
+void DamageContext::BeginFrame(const SkISize& frame_size) {
+  FXL_DCHECK(properties_.empty());
+
+  previous_entries_.swap(current_entries_);
+  current_entries_.clear();
+
+  previous_frame_size_ = current_frame_size_;
+  current_frame_size_ = frame_size;
+
+  has_previous_frame_ = has_current_frame_;
+  has_current_frame_ = true;
+}
+
+void DamageContext::AddContent(uint64_t content_id,
+                               const SkRect& bounds,
+                               const SkMatrix& matrix) {
+  uint64_t fingerprint = properties_.empty() ? 0 : properties_.back();
+  fingerprint = Fingerprint(content_id, fingerprint);
+  fingerprint = Fingerprint(bounds, fingerprint);
+
+  current_entries_.push_back({fingerprint, matrix.mapRect(bounds), false});
+}
+
+void DamageContext::AddVolatileContent(const SkRect& bounds,
+                                       const SkMatrix& matrix) {
+  // The fingerprint is only used to line up the entries of successive frames.
+  // Volatile entries are damaged regardless of whether they line up.
+  const uint64_t fingerprint = properties_.empty() ? 0 : properties_.back();
+
+  current_entries_.push_back({fingerprint, matrix.mapRect(bounds), true});
+}
+
+bool DamageContext::IsSameEntry(const Entry& a, const Entry& b) {
+  return a.fingerprint == b.fingerprint && a.bounds == b.bounds &&
+         a.is_volatile == b.is_volatile;
+}
+
+SkRect DamageContext::ComputeDamage() const {
+  const SkRect frame_rect = SkRect::Make(current_frame_size_);
+
+  if (!has_previous_frame_ || previous_frame_size_ != current_frame_size_) {
+    return frame_rect;
+  }
+
+  // Line up the entries of both frames by skipping the common prefix and
+  // suffix. Everything in between was inserted, removed or changed. This
+  // handles the common cases of content changing in place and of layers
+  // appearing or disappearing without a quadratic diff.
+  const size_t previous_count = previous_entries_.size();
+  const size_t current_count = current_entries_.size();
+
+  size_t prefix = 0;
+  while (prefix < previous_count && prefix < current_count &&
+         IsSameEntry(previous_entries_[prefix], current_entries_[prefix])) {
+    prefix++;
+  }
+
+  size_t suffix = 0;
+  while (suffix < previous_count - prefix && suffix < current_count - prefix &&
+         IsSameEntry(previous_entries_[previous_count - suffix - 1],
+                     current_entries_[current_count - suffix - 1])) {
+    suffix++;
+  }
+
+  SkRect damage = SkRect::MakeEmpty();
+
+  for (size_t i = prefix; i < previous_count - suffix; i++) {
+    damage.join(previous_entries_[i].bounds);
+  }
+
+  for (size_t i = prefix; i < current_count - suffix; i++) {
+    damage.join(current_entries_[i].bounds);
+  }
+
+  for (const auto& entry : previous_entries_) {
+    if (entry.is_volatile) {
+      damage.join(entry.bounds);
+    }
+  }
+
+  for (const auto& entry : current_entries_) {
+    if (entry.is_volatile) {
+      damage.join(entry.bounds);
+    }
+  }
+
+  if (damage.isEmpty()) {
+    return SkRect::MakeEmpty();
+  }
+
+  // Anti-aliased edges may touch the pixels just outside the bounds.
+  damage.outset(1.0, 1.0);
+  damage.roundOut(&damage);
+
+  if (!damage.intersect(frame_rect)) {
+    return SkRect::MakeEmpty();
+  }
+
+  return damage;
+}
+
+}  // namespace flow
@@ -0,0 +1,93 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DAMAGE_CONTEXT_H_
+#define FLUTTER_FLOW_DAMAGE_CONTEXT_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "lib/fxl/macros.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkSize.h"
+
+namespace flow {
+
+// Collects a flattened description of what a prerolled layer tree paints so
+// that it may be compared against the description of the previous frame. The
+// difference between the two is the damage: the area of the frame that has to
+// be repainted when the contents of the previous frame are still present on
+// the surface.
+class DamageContext {
+ public:
+  DamageContext();
+
+  ~DamageContext();
+
+  // Pushes the properties of a container layer (transform, opacity, clip,
+  // ...) that affect how all of its descendants are painted. Any change in
+  // these properties damages the bounds of every descendant.
+  class AutoProperties {
+   public:
+    AutoProperties(DamageContext* context, uint64_t properties);
+
+    ~AutoProperties();
+
+   private:
+    DamageContext* context_;
+
+    FXL_DISALLOW_COPY_AND_ASSIGN(AutoProperties);
+  };
+
+  // Forgets the contents of the previous frame. The next call to
+  // |ComputeDamage| will damage the entire frame. This must be called
+  // whenever the contents of the surface are not the ones rendered for the
+  // last frame.
+  void Reset();
+
+  // Begins collecting entries for a new frame. The entries of the last frame
+  // are retained for comparison in |ComputeDamage|.
+  void BeginFrame(const SkISize& frame_size);
+
+  // Adds content that is fully described by |content_id| (and the current
+  // properties) and covers |bounds| in the coordinate space of |matrix|.
+  void AddContent(uint64_t content_id,
+                  const SkRect& bounds,
+                  const SkMatrix& matrix);
+
+  // Adds content that may change from frame to frame without any visible
+  // change in the layer tree (textures, the performance overlay, backdrop
+  // filters). Volatile content is always damaged.
+  void AddVolatileContent(const SkRect& bounds, const SkMatrix& matrix);
+
+  // Returns the area (in the root coordinate space of the layer tree) that
+  // changed between the last and the current frame. The area is rounded out
+  // to whole pixels. Returns an empty rect if nothing changed.
+  SkRect ComputeDamage() const;
+
+ private:
+  struct Entry {
+    uint64_t fingerprint;
+    SkRect bounds;
+    bool is_volatile;
+  };
+
+  std::vector<Entry> previous_entries_;
+  std::vector<Entry> current_entries_;
+  std::vector<uint64_t> properties_;
+  SkISize previous_frame_size_;
+  SkISize current_frame_size_;
+  bool has_previous_frame_;
+  bool has_current_frame_;
+
+  static bool IsSameEntry(const Entry& a, const Entry& b);
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(DamageContext);
+};
+
+}  // namespace flow
+
+#endif  // FLUTTER_FLOW_DAMAGE_CONTEXT_H_
@@ -0,0 +1,85 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/damage_context.h"
+#include "flutter/flow/fingerprint.h"
+#include "gtest/gtest.h"
+
+TEST(DamageContext, FirstFrameIsFullyDamaged) {
+  flow::DamageContext context;
+  context.BeginFrame(SkISize::Make(100, 100));
+  context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+  ASSERT_EQ(context.ComputeDamage(), SkRect::MakeWH(100, 100));
+}
+
+TEST(DamageContext, IdenticalFramesAreNotDamaged) {
+  flow::DamageContext context;
+  for (int i = 0; i < 2; i++) {
+    context.BeginFrame(SkISize::Make(100, 100));
+    context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+    context.AddContent(2, SkRect::MakeXYWH(50, 50, 10, 10), SkMatrix::I());
+  }
+  ASSERT_TRUE(context.ComputeDamage().isEmpty());
+}
+
+TEST(DamageContext, ChangedContentIsDamaged) {
+  flow::DamageContext context;
+  context.BeginFrame(SkISize::Make(100, 100));
+  context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+  context.AddContent(2, SkRect::MakeXYWH(50, 50, 10, 10), SkMatrix::I());
+
+  context.BeginFrame(SkISize::Make(100, 100));
+  context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+  context.AddContent(3, SkRect::MakeXYWH(50, 50, 10, 10), SkMatrix::I());
+
+  ASSERT_EQ(context.ComputeDamage(), SkRect::MakeXYWH(49, 49, 12, 12));
+}
+
+TEST(DamageContext, RemovedContentIsDamaged) {
+  flow::DamageContext context;
+  context.BeginFrame(SkISize::Make(100, 100));
+  context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+  context.AddContent(2, SkRect::MakeXYWH(50, 50, 10, 10), SkMatrix::I());
+  context.AddContent(3, SkRect::MakeXYWH(80, 80, 10, 10), SkMatrix::I());
+
+  context.BeginFrame(SkISize::Make(100, 100));
+  context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+  context.AddContent(3, SkRect::MakeXYWH(80, 80, 10, 10), SkMatrix::I());
+
+  ASSERT_EQ(context.ComputeDamage(), SkRect::MakeXYWH(49, 49, 12, 12));
+}
+
+TEST(DamageContext, ChangedPropertiesDamageDescendants) {
+  flow::DamageContext context;
+  for (int alpha = 0; alpha < 2; alpha++) {
+    context.BeginFrame(SkISize::Make(100, 100));
+    context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+    flow::DamageContext::AutoProperties properties(
+        &context, flow::Fingerprint(alpha, 0));
+    context.AddContent(2, SkRect::MakeXYWH(50, 50, 10, 10), SkMatrix::I());
+  }
+  ASSERT_EQ(context.ComputeDamage(), SkRect::MakeXYWH(49, 49, 12, 12));
+}
+
+TEST(DamageContext, VolatileContentIsAlwaysDamaged) {
+  flow::DamageContext context;
+  for (int i = 0; i < 2; i++) {
+    context.BeginFrame(SkISize::Make(100, 100));
+    context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+    context.AddVolatileContent(SkRect::MakeXYWH(50, 50, 10, 10),
+                               SkMatrix::I());
+    context.AddContent(2, SkRect::MakeXYWH(80, 80, 10, 10), SkMatrix::I());
+  }
+  ASSERT_EQ(context.ComputeDamage(), SkRect::MakeXYWH(49, 49, 12, 12));
+}
+
+TEST(DamageContext, ResetDamagesEntireFrame) {
+  flow::DamageContext context;
+  context.BeginFrame(SkISize::Make(100, 100));
+  context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+  context.Reset();
+  context.BeginFrame(SkISize::Make(100, 100));
+  context.AddContent(1, SkRect::MakeXYWH(10, 10, 10, 10), SkMatrix::I());
+  ASSERT_EQ(context.ComputeDamage(), SkRect::MakeWH(100, 100));
+}
@@ -0,0 +1,60 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/fingerprint.h"
+
+namespace flow {
+
+uint64_t FingerprintBytes(const void* data, size_t length, uint64_t seed) {
+  // 64-bit FNV-1a.
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = seed ^ 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+void FingerprintBuilder::AddBytes(const void* data, size_t length) {
+  fingerprint_ = FingerprintBytes(data, length, fingerprint_);
+  if (description_) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    description_->insert(description_->end(), bytes, bytes + length);
+  }
+}
+
+// The number of points SkPath::RawIter::next returns for |verb|, including
+// the last point of the previous verb.
+static int PointCount(SkPath::Verb verb) {
+  switch (verb) {
+    case SkPath::kMove_Verb:
+      return 1;
+    case SkPath::kLine_Verb:
+      return 2;
+    case SkPath::kQuad_Verb:
+    case SkPath::kConic_Verb:
+      return 3;
+    case SkPath::kCubic_Verb:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+void FingerprintBuilder::AddPath(const SkPath& path) {
+  Add(path.getFillType());
+  SkPath::RawIter iter(path);
+  SkPoint points[4];
+  SkPath::Verb verb;
+  while ((verb = iter.next(points)) != SkPath::kDone_Verb) {
+    Add(verb);
+    AddBytes(points, PointCount(verb) * sizeof(SkPoint));
+    if (verb == SkPath::kConic_Verb) {
+      Add(iter.conicWeight());
+    }
+  }
+}
+
+}  // namespace flow
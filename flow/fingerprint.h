@@ -0,0 +1,61 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_FINGERPRINT_H_
+#define FLUTTER_FLOW_FINGERPRINT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+#include <vector>
+
+#include "third_party/skia/include/core/SkPath.h"
+
+namespace flow {
+
+// Combines |length| bytes at |data| into the 64-bit fingerprint |seed|.
+uint64_t FingerprintBytes(const void* data, size_t length, uint64_t seed);
+
+// Combines the bytes of |value| into the 64-bit fingerprint |seed|.
+template <typename T>
+uint64_t Fingerprint(const T& value, uint64_t seed) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Only plain values may be fingerprinted by their bytes.");
+  return FingerprintBytes(&value, sizeof(T), seed);
+}
+
+// Combines values into a fingerprint. If |description| is not null, the bytes
+// of the values are also appended to it. Unlike the fingerprint, the
+// description identifies the values exactly.
+class FingerprintBuilder {
+ public:
+  explicit FingerprintBuilder(uint64_t seed,
+                              std::vector<uint8_t>* description = nullptr)
+      : fingerprint_(seed), description_(description) {}
+
+  void AddBytes(const void* data, size_t length);
+
+  template <typename T>
+  void Add(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only plain values may be fingerprinted by their bytes.");
+    AddBytes(&value, sizeof(T));
+  }
+
+  // Adds the fill type, verbs and points of |path|. Equal paths add the same
+  // bytes, unlike their generation IDs, which differ between copies made in
+  // different frames.
+  void AddPath(const SkPath& path);
+
+  uint64_t fingerprint() const { return fingerprint_; }
+
+ private:
+  uint64_t fingerprint_;
+  std::vector<uint8_t>* description_;
+};
+
+}  // namespace flow
+
+#endif  // FLUTTER_FLOW_FINGERPRINT_H_
@@ -0,0 +1,55 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "flutter/flow/fingerprint.h"
+#include "gtest/gtest.h"
+
+static SkPath GetSamplePath(SkScalar radius) {
+  SkPath path;
+  path.moveTo(10, 10);
+  path.lineTo(50, 10);
+  path.conicTo(80, 10, 80, 40, 0.5f);
+  path.addCircle(40, 40, radius);
+  return path;
+}
+
+TEST(Fingerprint, EqualPathsHaveEqualDescriptions) {
+  // Paths built separately, as in successive frames, have different
+  // generation IDs.
+  SkPath path = GetSamplePath(20);
+  SkPath same_path = GetSamplePath(20);
+  ASSERT_NE(path.getGenerationID(), same_path.getGenerationID());
+
+  std::vector<uint8_t> description;
+  flow::FingerprintBuilder builder(0, &description);
+  builder.AddPath(path);
+
+  std::vector<uint8_t> same_description;
+  flow::FingerprintBuilder same_builder(0, &same_description);
+  same_builder.AddPath(same_path);
+
+  ASSERT_EQ(builder.fingerprint(), same_builder.fingerprint());
+  ASSERT_EQ(description, same_description);
+}
+
+TEST(Fingerprint, DifferentPathsHaveDifferentDescriptions) {
+  std::vector<uint8_t> description;
+  flow::FingerprintBuilder builder(0, &description);
+  builder.AddPath(GetSamplePath(20));
+
+  std::vector<uint8_t> other_description;
+  flow::FingerprintBuilder other_builder(0, &other_description);
+  other_builder.AddPath(GetSamplePath(21));
+
+  ASSERT_NE(builder.fingerprint(), other_builder.fingerprint());
+  ASSERT_NE(description, other_description);
+
+  SkPath even_odd_path = GetSamplePath(20);
+  even_odd_path.setFillType(SkPath::kEvenOdd_FillType);
+  flow::FingerprintBuilder even_odd_builder(0);
+  even_odd_builder.AddPath(even_odd_path);
+  ASSERT_NE(builder.fingerprint(), even_odd_builder.fingerprint());
+}
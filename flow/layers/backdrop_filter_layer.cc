@@ -12,6 +12,21 @@ BackdropFilterLayer::BackdropFilterLayer() = default;
 
 BackdropFilterLayer::~BackdropFilterLayer() = default;
 
+void BackdropFilterLayer::Preroll(PrerollContext* context,
+                                  const SkMatrix& matrix) {
+  ContainerLayer::Preroll(context, matrix);
+
+  // The output depends on everything painted before this layer.
+  set_fingerprint(0);
+}
+
+void BackdropFilterLayer::CollectDamage(DamageContext* context,
+                                        const SkMatrix& matrix) const {
+  // The filtered backdrop depends on everything painted before this layer.
+  context->AddVolatileContent(paint_bounds(), matrix);
+  CollectDamageChildren(context, matrix);
+}
+
 void BackdropFilterLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "BackdropFilterLayer::Paint");
   FXL_DCHECK(needs_painting());
@@ -16,8 +16,17 @@ class BackdropFilterLayer : public ContainerLayer {
 
   void set_filter(sk_sp<SkImageFilter> filter) { filter_ = std::move(filter); }
 
+  void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
+
   void Paint(PaintContext& context) const override;
 
+  // The filter applies to the whole backdrop within the clip, not just to the
+  // bounds of the children.
+  bool paints_within_bounds() const override { return false; }
+
+  void CollectDamage(DamageContext* context,
+                     const SkMatrix& matrix) const override;
+
  private:
   sk_sp<SkImageFilter> filter_;
 
@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/clip_path_layer.h"
 
+#include "flutter/flow/fingerprint.h"
+
 #if defined(OS_FUCHSIA)
 
 #include "lib/ui/scenic/fidl_helpers.h"  // nogncheck
@@ -23,6 +25,10 @@ void ClipPathLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   if (child_paint_bounds.intersect(clip_path_.getBounds())) {
     set_paint_bounds(child_paint_bounds);
   }
+
+  // Caching the clipped subtree avoids the anti-aliased clip and the
+  // offscreen layer it requires.
+  PrerollCachedSubtree(context, matrix, CachedSubtree::kLayer);
 }
 
 #if defined(OS_FUCHSIA)
@@ -44,10 +50,22 @@ void ClipPathLayer::UpdateScene(SceneUpdateContext& context) {
 
 #endif  // defined(OS_FUCHSIA)
 
+void ClipPathLayer::AddProperties(FingerprintBuilder* builder) const {
+  builder->AddPath(clip_path_);
+}
+
 void ClipPathLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ClipPathLayer::Paint");
   FXL_DCHECK(needs_painting());
 
+  auto paint_clipped = [this](PaintContext& subtree_context) {
+    subtree_context.canvas.clipPath(clip_path_, true);
+    PaintChildren(subtree_context);
+  };
+  if (PaintCachedSubtree(context, nullptr, paint_clipped)) {
+    return;
+  }
+
   Layer::AutoSaveLayer save(context, paint_bounds(), nullptr);
   context.canvas.clipPath(clip_path_, true);
   PaintChildren(context);
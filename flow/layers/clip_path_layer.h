@@ -24,6 +24,9 @@ class ClipPathLayer : public ContainerLayer {
   void UpdateScene(SceneUpdateContext& context) override;
 #endif  // defined(OS_FUCHSIA)
 
+ protected:
+  void AddProperties(FingerprintBuilder* builder) const override;
+
  private:
   SkPath clip_path_;
 
@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/clip_rect_layer.h"
 
+#include "flutter/flow/fingerprint.h"
+
 namespace flow {
 
 ClipRectLayer::ClipRectLayer() = default;
@@ -35,6 +37,10 @@ void ClipRectLayer::UpdateScene(SceneUpdateContext& context) {
 
 #endif  // defined(OS_FUCHSIA)
 
+void ClipRectLayer::AddProperties(FingerprintBuilder* builder) const {
+  builder->Add(clip_rect_);
+}
+
 void ClipRectLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ClipRectLayer::Paint");
   FXL_DCHECK(needs_painting());
@@ -23,6 +23,9 @@ class ClipRectLayer : public ContainerLayer {
   void UpdateScene(SceneUpdateContext& context) override;
 #endif  // defined(OS_FUCHSIA)
 
+ protected:
+  void AddProperties(FingerprintBuilder* builder) const override;
+
  private:
   SkRect clip_rect_;
 
@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/clip_rrect_layer.h"
 
+#include "flutter/flow/fingerprint.h"
+
 namespace flow {
 
 ClipRRectLayer::ClipRRectLayer() = default;
@@ -42,6 +44,10 @@ void ClipRRectLayer::UpdateScene(SceneUpdateContext& context) {
 
 #endif  // defined(OS_FUCHSIA)
 
+void ClipRRectLayer::AddProperties(FingerprintBuilder* builder) const {
+  builder->Add(clip_rrect_);
+}
+
 void ClipRRectLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ClipRRectLayer::Paint");
   FXL_DCHECK(needs_painting());
@@ -4,12 +4,19 @@
 
 #include "flutter/flow/layers/color_filter_layer.h"
 
+#include "flutter/flow/fingerprint.h"
+
 namespace flow {
 
 ColorFilterLayer::ColorFilterLayer() = default;
 
 ColorFilterLayer::~ColorFilterLayer() = default;
 
+void ColorFilterLayer::AddProperties(FingerprintBuilder* builder) const {
+  builder->Add(color_);
+  builder->Add(blend_mode_);
+}
+
 void ColorFilterLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ColorFilterLayer::Paint");
   FXL_DCHECK(needs_painting());
@@ -20,6 +20,9 @@ class ColorFilterLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+ protected:
+  void AddProperties(FingerprintBuilder* builder) const override;
+
  private:
   SkColor color_;
   SkBlendMode blend_mode_;
@@ -4,9 +4,14 @@
 
 #include "flutter/flow/layers/container_layer.h"
 
+#include "flutter/flow/fingerprint.h"
+
 namespace flow {
 
-ContainerLayer::ContainerLayer() {}
+ContainerLayer::ContainerLayer()
+    : children_fingerprint_(0),
+      first_child_picture_(0),
+      cached_subtree_fingerprint_(0) {}
 
 ContainerLayer::~ContainerLayer() = default;
 
@@ -26,6 +31,11 @@ void ContainerLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
 void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      const SkMatrix& child_matrix,
                                      SkRect* child_paint_bounds) {
+  if (context->raster_cache_pictures) {
+    first_child_picture_ = context->raster_cache_pictures->size();
+  }
+
+  uint64_t children_fingerprint = Fingerprint(layers_.size(), 0);
   for (auto& layer : layers_) {
     PrerollContext child_context = *context;
     layer->Preroll(&child_context, child_matrix);
@@ -34,7 +44,109 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
       set_needs_system_composite(true);
     }
     child_paint_bounds->join(layer->paint_bounds());
+
+    if (children_fingerprint != 0) {
+      children_fingerprint =
+          layer->fingerprint() == 0
+              ? 0
+              : Fingerprint(layer->fingerprint(), children_fingerprint);
+    }
   }
+
+  children_fingerprint_ = children_fingerprint;
+  set_fingerprint(children_fingerprint_ == 0
+                      ? 0
+                      : HashProperties(children_fingerprint_));
+}
+
+void ContainerLayer::AddProperties(FingerprintBuilder* builder) const {}
+
+uint64_t ContainerLayer::HashProperties(uint64_t seed) const {
+  FingerprintBuilder builder(seed);
+  AddProperties(&builder);
+  return builder.fingerprint();
+}
+
+void ContainerLayer::DescribeSubtree(std::vector<uint8_t>* description) const {
+  FingerprintBuilder builder(0, description);
+  AddProperties(&builder);
+  builder.Add(layers_.size());
+  for (auto& layer : layers_) {
+    layer->DescribeSubtree(description);
+  }
+}
+
+void ContainerLayer::PrerollCachedSubtree(PrerollContext* context,
+                                          const SkMatrix& matrix,
+                                          CachedSubtree subtree) {
+  cached_subtree_fingerprint_ = 0;
+  const uint64_t fingerprint = subtree == CachedSubtree::kChildren
+                                   ? children_fingerprint_
+                                   : this->fingerprint();
+  if (context->raster_cache == nullptr || fingerprint == 0) {
+    return;
+  }
+
+  // The raster cache compares the full description of the subtree with that
+  // of the cached image, so that subtrees with colliding fingerprints are
+  // never drawn from each other's images.
+  std::vector<uint8_t> description;
+  if (subtree == CachedSubtree::kChildren) {
+    for (auto& layer : layers_) {
+      layer->DescribeSubtree(&description);
+    }
+  } else {
+    DescribeSubtree(&description);
+  }
+
+  if (context->raster_cache->PrerollLayer(fingerprint, description, matrix)) {
+    cached_subtree_fingerprint_ = fingerprint;
+    cached_subtree_matrix_ = matrix;
+    // The pictures of the subtree are drawn as part of its image.
+    if (context->raster_cache_pictures) {
+      context->raster_cache_pictures->resize(first_child_picture_);
+    }
+  }
+}
+
+bool ContainerLayer::PaintCachedSubtree(
+    PaintContext& context,
+    const SkPaint* paint,
+    const std::function<void(PaintContext&)>& paint_function) const {
+  if (cached_subtree_fingerprint_ == 0 || context.raster_cache == nullptr) {
+    return false;
+  }
+
+  RasterCacheResult result = context.raster_cache->GetRasterizedLayer(
+      cached_subtree_fingerprint_, cached_subtree_matrix_, paint_bounds(),
+      context.gr_context, context.canvas.imageInfo().colorSpace(),
+      [&context, &paint_function](SkCanvas* canvas) {
+        PaintContext subtree_context = {*canvas,
+                                        context.frame_time,
+                                        context.engine_time,
+                                        context.memory_usage,
+                                        context.texture_registry,
+                                        context.checkerboard_offscreen_layers,
+                                        context.raster_cache,
+                                        context.gr_context,
+                                        false};
+        paint_function(subtree_context);
+      });
+
+  if (!result.is_valid()) {
+    return false;
+  }
+
+  SkPaint image_paint = paint ? *paint : SkPaint();
+  image_paint.setFilterQuality(kLow_SkFilterQuality);
+  context.canvas.drawImageRect(
+      result.image(),                      // image
+      result.source_rect(),                // source
+      result.destination_rect(),           // destination
+      &image_paint,                        // paint
+      SkCanvas::kStrict_SrcRectConstraint  // source constraint
+  );
+  return true;
 }
 
 void ContainerLayer::PaintChildren(PaintContext& context) const {
@@ -43,12 +155,31 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   // Intentionally not tracing here as there should be no self-time
   // and the trace event on this common function has a small overhead.
   for (auto& layer : layers_) {
-    if (layer->needs_painting()) {
+    // Children entirely outside the damaged area of a partial repaint need
+    // not be painted at all.
+    if (layer->needs_painting() &&
+        (!context.cull_outside_clip || !layer->paints_within_bounds() ||
+         !context.canvas.quickReject(layer->paint_bounds()))) {
       layer->Paint(context);
     }
   }
 }
 
+void ContainerLayer::CollectDamage(DamageContext* context,
+                                   const SkMatrix& matrix) const {
+  DamageContext::AutoProperties properties(context, HashProperties(0));
+  CollectDamageChildren(context, matrix);
+}
+
+void ContainerLayer::CollectDamageChildren(DamageContext* context,
+                                           const SkMatrix& child_matrix) const {
+  for (auto& layer : layers_) {
+    if (layer->needs_painting()) {
+      layer->CollectDamage(context, child_matrix);
+    }
+  }
+}
+
 #if defined(OS_FUCHSIA)
 
 void ContainerLayer::UpdateScene(SceneUpdateContext& context) {
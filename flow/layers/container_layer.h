@@ -5,7 +5,9 @@
 #ifndef FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
 #define FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
 
+#include <functional>
 #include <vector>
+#include "flutter/flow/fingerprint.h"
 #include "flutter/flow/layers/layer.h"
 
 namespace flow {
@@ -19,6 +21,11 @@ class ContainerLayer : public Layer {
 
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
 
+  void CollectDamage(DamageContext* context,
+                     const SkMatrix& matrix) const override;
+
+  void DescribeSubtree(std::vector<uint8_t>* description) const override;
+
 #if defined(OS_FUCHSIA)
   void UpdateScene(SceneUpdateContext& context) override;
 #endif  // defined(OS_FUCHSIA)
@@ -26,10 +33,47 @@ class ContainerLayer : public Layer {
   const std::vector<std::unique_ptr<Layer>>& layers() const { return layers_; }
 
  protected:
+  // Prerolls all children and sets the fingerprint of this layer from the
+  // fingerprints of the children and |AddProperties|.
   void PrerollChildren(PrerollContext* context,
                        const SkMatrix& child_matrix,
                        SkRect* child_paint_bounds);
   void PaintChildren(PaintContext& context) const;
+  void CollectDamageChildren(DamageContext* context,
+                             const SkMatrix& child_matrix) const;
+
+  // Adds the properties of this layer that affect how its children are
+  // painted (transform, opacity, clip, ...) to |builder|.
+  virtual void AddProperties(FingerprintBuilder* builder) const;
+
+  // Combines the properties of this layer into the fingerprint |seed|.
+  uint64_t HashProperties(uint64_t seed) const;
+
+  // The combined fingerprint of the children, or zero if any of them has no
+  // fingerprint. Valid after PrerollChildren.
+  uint64_t children_fingerprint() const { return children_fingerprint_; }
+
+  // What PrerollCachedSubtree caches: the children alone, to which this layer
+  // applies its properties when drawing the cached image, or the children
+  // with the properties of this layer applied.
+  enum class CachedSubtree { kChildren, kLayer };
+
+  // Records a use of |subtree| in the raster cache. Must be called after
+  // PrerollChildren. Subtrees used in enough frames are drawn from the cache
+  // by PaintCachedSubtree, and the pictures within them are not cached on
+  // their own.
+  void PrerollCachedSubtree(PrerollContext* context,
+                            const SkMatrix& matrix,
+                            CachedSubtree subtree);
+
+  // Draws the cached image of the subtree prerolled by PrerollCachedSubtree
+  // over the paint bounds of this layer using |paint| (which may be null).
+  // The image is rasterized using |paint_function| if it is not cached yet.
+  // Returns false if the subtree must be painted directly instead.
+  bool PaintCachedSubtree(
+      PaintContext& context,
+      const SkPaint* paint,
+      const std::function<void(PaintContext&)>& paint_function) const;
 
 #if defined(OS_FUCHSIA)
   void UpdateSceneChildren(SceneUpdateContext& context);
@@ -37,6 +81,12 @@ class ContainerLayer : public Layer {
 
  private:
   std::vector<std::unique_ptr<Layer>> layers_;
+  uint64_t children_fingerprint_;
+  // The number of pictures queued in the PrerollContext before the children
+  // were prerolled.
+  size_t first_child_picture_;
+  uint64_t cached_subtree_fingerprint_;
+  SkMatrix cached_subtree_matrix_;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(ContainerLayer);
 };
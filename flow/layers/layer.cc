@@ -12,12 +12,20 @@ namespace flow {
 Layer::Layer()
     : parent_(nullptr),
       needs_system_composite_(false),
-      paint_bounds_(SkRect::MakeEmpty()) {}
+      paint_bounds_(SkRect::MakeEmpty()),
+      fingerprint_(0) {}
 
 Layer::~Layer() = default;
 
 void Layer::Preroll(PrerollContext* context, const SkMatrix& matrix) {}
 
+void Layer::CollectDamage(DamageContext* context,
+                          const SkMatrix& matrix) const {
+  context->AddVolatileContent(paint_bounds(), matrix);
+}
+
+void Layer::DescribeSubtree(std::vector<uint8_t>* description) const {}
+
 #if defined(OS_FUCHSIA)
 void Layer::UpdateScene(SceneUpdateContext& context) {}
 #endif  // defined(OS_FUCHSIA)
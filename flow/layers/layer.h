@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 
+#include "flutter/flow/damage_context.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
 #include "flutter/flow/texture.h"
@@ -35,6 +36,7 @@
 namespace flow {
 
 class ContainerLayer;
+class PictureLayer;
 
 // Represents a single composited layer. Created on the UI thread but then
 // subquently used on the Rasterizer thread.
@@ -51,6 +53,9 @@ class Layer {
     GrContext* gr_context;
     SkColorSpace* dst_color_space;
     SkRect child_paint_bounds;
+    // Pictures that are prerolled into the raster cache after the whole tree
+    // has been prerolled, unless an ancestor caches them as part of a subtree.
+    std::vector<PictureLayer*>* raster_cache_pictures;
   };
 
   virtual void Preroll(PrerollContext* context, const SkMatrix& matrix);
@@ -62,6 +67,15 @@ class Layer {
     const CounterValues& memory_usage;
     TextureRegistry& texture_registry;
     const bool checkerboard_offscreen_layers;
+    // Layers that were prerolled into the raster cache are drawn from it.
+    // May be null, in which case all layers are painted directly.
+    RasterCache* raster_cache;
+    GrContext* gr_context;
+    // Whether containers skip children that lie entirely outside the clip.
+    // Only set when painting is clipped to the damaged area of a partial
+    // repaint. Otherwise few children are outside the clip and checking
+    // every child costs more than it saves.
+    const bool cull_outside_clip;
   };
 
   // Calls SkCanvas::saveLayer and restores the layer upon destruction. Also
@@ -84,6 +98,13 @@ class Layer {
 
   virtual void Paint(PaintContext& context) const = 0;
 
+  // Describes what this layer paints (in the coordinate space of |matrix|) to
+  // the damage context so that the frame can be diffed against the previous
+  // one. Must be called after Preroll. By default, the paint bounds of the
+  // layer are assumed to change every frame.
+  virtual void CollectDamage(DamageContext* context,
+                             const SkMatrix& matrix) const;
+
 #if defined(OS_FUCHSIA)
   // Updates the system composited scene.
   virtual void UpdateScene(SceneUpdateContext& context);
@@ -108,10 +129,30 @@ class Layer {
 
   bool needs_painting() const { return !paint_bounds_.isEmpty(); }
 
+  // Whether everything this layer paints lies within its paint bounds. Layers
+  // whose effect reaches beyond them (such as backdrop filters, which filter
+  // everything up to the clip) must not be culled by their paint bounds.
+  virtual bool paints_within_bounds() const { return true; }
+
+  // A hash of everything that affects what this layer paints, or zero if the
+  // output of the layer may change without any change to the layer tree (for
+  // instance, because it shows a texture). Layers with equal non-zero
+  // fingerprints paint the same. Valid after Preroll().
+  uint64_t fingerprint() const { return fingerprint_; }
+
+  void set_fingerprint(uint64_t fingerprint) { fingerprint_ = fingerprint; }
+
+  // Appends the bytes the fingerprint of this layer is computed from to
+  // |description|. Layers with equal descriptions paint the same, even if
+  // their fingerprints collide with those of other layers. Only called on
+  // layers that have a fingerprint.
+  virtual void DescribeSubtree(std::vector<uint8_t>* description) const;
+
  private:
   ContainerLayer* parent_;
   bool needs_system_composite_;
   SkRect paint_bounds_;
+  uint64_t fingerprint_;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(Layer);
 };
@@ -4,7 +4,9 @@
 
 #include "flutter/flow/layers/layer_tree.h"
 
+#include "flutter/flow/fingerprint.h"
 #include "flutter/flow/layers/layer.h"
+#include "flutter/flow/layers/picture_layer.h"
 #include "flutter/glue/trace_event.h"
 
 namespace flow {
@@ -46,6 +48,7 @@ void LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       frame.canvas() ? frame.canvas()->imageInfo().colorSpace() : nullptr;
   frame.context().raster_cache().SetCheckboardCacheImages(
       checkerboard_raster_cache_images_);
+  std::vector<PictureLayer*> raster_cache_pictures;
   Layer::PrerollContext context = {
 #if defined(OS_FUCHSIA)
     metrics,
@@ -54,9 +57,19 @@ void LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
     frame.gr_context(),
     color_space,
     SkRect::MakeEmpty(),
+    &raster_cache_pictures,
   };
 
   root_layer_->Preroll(&context, SkMatrix::I());
+
+  if (context.raster_cache) {
+    for (PictureLayer* picture : raster_cache_pictures) {
+      picture->PrerollRasterCache(&context);
+    }
+
+    // Pictures may have been queued for rasterization on worker threads.
+    context.raster_cache->RasterizePending();
+  }
 }
 
 #if defined(OS_FUCHSIA)
@@ -81,17 +94,34 @@ void LayerTree::UpdateScene(SceneUpdateContext& context,
 }
 #endif
 
-void LayerTree::Paint(CompositorContext::ScopedFrame& frame) const {
+void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
+                      bool cull_outside_clip) const {
   Layer::PaintContext context = {*frame.canvas(),
                                  frame.context().frame_time(),
                                  frame.context().engine_time(),
                                  frame.context().memory_usage(),
                                  frame.context().texture_registry(),
-                                 checkerboard_offscreen_layers_};
+                                 checkerboard_offscreen_layers_,
+                                 &frame.context().raster_cache(),
+                                 frame.gr_context(),
+                                 cull_outside_clip};
   TRACE_EVENT0("flutter", "LayerTree::Paint");
 
   if (root_layer_->needs_painting())
     root_layer_->Paint(context);
 }
 
+void LayerTree::CollectDamage(DamageContext* context) const {
+  TRACE_EVENT0("flutter", "LayerTree::CollectDamage");
+
+  // Toggling the checkerboards changes how every layer is painted.
+  uint64_t hash = Fingerprint(checkerboard_raster_cache_images_, 0);
+  hash = Fingerprint(checkerboard_offscreen_layers_, hash);
+
+  DamageContext::AutoProperties properties(context, hash);
+  if (root_layer_->needs_painting()) {
+    root_layer_->CollectDamage(context, SkMatrix::I());
+  }
+}
+
 }  // namespace flow
@@ -48,7 +48,14 @@ class LayerTree {
                    scenic_lib::ContainerNode& container);
 #endif
 
-  void Paint(CompositorContext::ScopedFrame& frame) const;
+  // Children entirely outside the clip of the canvas are skipped if
+  // |cull_outside_clip| is set. See Layer::PaintContext.
+  void Paint(CompositorContext::ScopedFrame& frame,
+             bool cull_outside_clip = false) const;
+
+  // Describes the contents of the prerolled tree to the damage context. The
+  // context must have begun a new frame.
+  void CollectDamage(DamageContext* context) const;
 
   Layer* root_layer() const { return root_layer_.get(); }
 
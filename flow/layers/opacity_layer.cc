@@ -4,12 +4,26 @@
 
 #include "flutter/flow/layers/opacity_layer.h"
 
+#include "flutter/flow/fingerprint.h"
+
 namespace flow {
 
 OpacityLayer::OpacityLayer() = default;
 
 OpacityLayer::~OpacityLayer() = default;
 
+void OpacityLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
+  ContainerLayer::Preroll(context, matrix);
+
+  // The children are cached without the opacity so that animating the opacity
+  // composites the same cached image with a different alpha.
+  PrerollCachedSubtree(context, matrix, CachedSubtree::kChildren);
+}
+
+void OpacityLayer::AddProperties(FingerprintBuilder* builder) const {
+  builder->Add(alpha_);
+}
+
 void OpacityLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "OpacityLayer::Paint");
   FXL_DCHECK(needs_painting());
@@ -17,6 +31,13 @@ void OpacityLayer::Paint(PaintContext& context) const {
   SkPaint paint;
   paint.setAlpha(alpha_);
 
+  auto paint_children = [this](PaintContext& subtree_context) {
+    PaintChildren(subtree_context);
+  };
+  if (PaintCachedSubtree(context, &paint, paint_children)) {
+    return;
+  }
+
   Layer::AutoSaveLayer save(context, paint_bounds(), &paint);
   PaintChildren(context);
 }
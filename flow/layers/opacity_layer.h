@@ -16,11 +16,16 @@ class OpacityLayer : public ContainerLayer {
 
   void set_alpha(int alpha) { alpha_ = alpha; }
 
+  void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
+
   void Paint(PaintContext& context) const override;
 
   // TODO(chinmaygarde): Once MZ-139 is addressed, introduce a new node in the
   // session scene hierarchy.
 
+ protected:
+  void AddProperties(FingerprintBuilder* builder) const override;
+
  private:
   int alpha_;
 
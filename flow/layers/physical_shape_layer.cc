@@ -4,6 +4,7 @@
 
 #include "flutter/flow/layers/physical_shape_layer.h"
 
+#include "flutter/flow/fingerprint.h"
 #include "flutter/flow/paint_utils.h"
 #include "third_party/skia/include/utils/SkShadowUtils.h"
 
@@ -77,6 +78,24 @@ void PhysicalShapeLayer::UpdateScene(SceneUpdateContext& context) {
 
 #endif  // defined(OS_FUCHSIA)
 
+void PhysicalShapeLayer::CollectDamage(DamageContext* context,
+                                       const SkMatrix& matrix) const {
+  const uint64_t properties_hash = HashProperties(0);
+
+  // The shape and its shadow.
+  context->AddContent(properties_hash, paint_bounds(), matrix);
+
+  DamageContext::AutoProperties properties(context, properties_hash);
+  CollectDamageChildren(context, matrix);
+}
+
+void PhysicalShapeLayer::AddProperties(FingerprintBuilder* builder) const {
+  builder->AddPath(path_);
+  builder->Add(elevation_);
+  builder->Add(color_);
+  builder->Add(device_pixel_ratio_);
+}
+
 void PhysicalShapeLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "PhysicalShapeLayer::Paint");
   FXL_DCHECK(needs_painting());
@@ -31,10 +31,16 @@ class PhysicalShapeLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void CollectDamage(DamageContext* context,
+                     const SkMatrix& matrix) const override;
+
 #if defined(OS_FUCHSIA)
   void UpdateScene(SceneUpdateContext& context) override;
 #endif  // defined(OS_FUCHSIA)
 
+ protected:
+  void AddProperties(FingerprintBuilder* builder) const override;
+
  private:
   float elevation_;
   SkColor color_;
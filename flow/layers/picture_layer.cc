@@ -5,7 +5,9 @@
 #include "flutter/flow/layers/picture_layer.h"
 
 #include "flutter/common/threads.h"
+#include "flutter/flow/fingerprint.h"
 #include "lib/fxl/logging.h"
+#include "lib/fxl/time/time_point.h"
 
 namespace flow {
 
@@ -21,17 +23,35 @@ PictureLayer::~PictureLayer() {
 }
 
 void PictureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
-  if (auto cache = context->raster_cache) {
-    raster_cache_result_ = cache->GetPrerolledImage(
-        context->gr_context, picture_.get(), matrix, context->dst_color_space,
-#if defined(OS_FUCHSIA)
-        context->metrics,
-#endif
-        is_complex_, will_change_);
+  raster_cache_result_ = RasterCacheResult();
+  if (context->raster_cache && context->raster_cache_pictures) {
+    matrix_ = matrix;
+    context->raster_cache_pictures->push_back(this);
   }
 
   SkRect bounds = picture_->cullRect().makeOffset(offset_.x(), offset_.y());
   set_paint_bounds(bounds);
+  set_fingerprint(Fingerprint(offset_, Fingerprint(picture_->uniqueID(), 0)));
+}
+
+void PictureLayer::PrerollRasterCache(PrerollContext* context) {
+  context->raster_cache->PrerollPicture(
+      context->gr_context, picture_.get(), matrix_, context->dst_color_space,
+#if defined(OS_FUCHSIA)
+      context->metrics,
+#endif
+      is_complex_, will_change_, &raster_cache_result_);
+}
+
+void PictureLayer::DescribeSubtree(std::vector<uint8_t>* description) const {
+  FingerprintBuilder builder(0, description);
+  builder.Add(picture_->uniqueID());
+  builder.Add(offset_);
+}
+
+void PictureLayer::CollectDamage(DamageContext* context,
+                                 const SkMatrix& matrix) const {
+  context->AddContent(picture_->uniqueID(), paint_bounds(), matrix);
 }
 
 void PictureLayer::Paint(PaintContext& context) const {
@@ -42,6 +62,17 @@ void PictureLayer::Paint(PaintContext& context) const {
   SkAutoCanvasRestore save(&context.canvas, true);
   context.canvas.translate(offset_.x(), offset_.y());
 
+  // The draw times are only measured for the raster cache policy that uses
+  // them.
+  RasterCache* measuring_cache =
+      context.raster_cache &&
+              context.raster_cache->admission_policy() ==
+                  RasterCache::AdmissionPolicy::kMeasuredCost
+          ? context.raster_cache
+          : nullptr;
+  const fxl::TimePoint start =
+      measuring_cache ? fxl::TimePoint::Now() : fxl::TimePoint();
+
   if (raster_cache_result_.is_valid()) {
     SkPaint paint;
     paint.setFilterQuality(kLow_SkFilterQuality);
@@ -52,8 +83,16 @@ void PictureLayer::Paint(PaintContext& context) const {
         &paint,                                   // paint
         SkCanvas::kStrict_SrcRectConstraint       // source constraint
     );
+    if (measuring_cache) {
+      measuring_cache->RecordImageDrawTime(*raster_cache_result_.image(),
+                                           fxl::TimePoint::Now() - start);
+    }
   } else {
     context.canvas.drawPicture(picture_.get());
+    if (measuring_cache) {
+      measuring_cache->RecordPictureDrawTime(*picture_,
+                                             fxl::TimePoint::Now() - start);
+    }
   }
 }
 
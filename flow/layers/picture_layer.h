@@ -27,8 +27,19 @@ class PictureLayer : public Layer {
 
   void Paint(PaintContext& context) const override;
 
+  void CollectDamage(DamageContext* context,
+                     const SkMatrix& matrix) const override;
+
+  void DescribeSubtree(std::vector<uint8_t>* description) const override;
+
+  // Prerolls the picture into the raster cache. Called at the end of the
+  // preroll of the layer tree for the pictures that are not cached as part of
+  // a layer subtree.
+  void PrerollRasterCache(PrerollContext* context);
+
  private:
   SkPoint offset_;
+  SkMatrix matrix_;
   sk_sp<SkPicture> picture_;
   bool is_complex_ = false;
   bool will_change_ = false;
@@ -10,6 +10,20 @@ ShaderMaskLayer::ShaderMaskLayer() = default;
 
 ShaderMaskLayer::~ShaderMaskLayer() = default;
 
+void ShaderMaskLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
+  ContainerLayer::Preroll(context, matrix);
+
+  // The shader is opaque to the layer tree.
+  set_fingerprint(0);
+}
+
+void ShaderMaskLayer::CollectDamage(DamageContext* context,
+                                    const SkMatrix& matrix) const {
+  // The shader is opaque to the damage context. Repaint the mask every frame.
+  context->AddVolatileContent(paint_bounds(), matrix);
+  CollectDamageChildren(context, matrix);
+}
+
 void ShaderMaskLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ShaderMaskLayer::Paint");
   FXL_DCHECK(needs_painting());
@@ -22,8 +22,13 @@ class ShaderMaskLayer : public ContainerLayer {
 
   void set_blend_mode(SkBlendMode blend_mode) { blend_mode_ = blend_mode; }
 
+  void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
+
   void Paint(PaintContext& context) const override;
 
+  void CollectDamage(DamageContext* context,
+                     const SkMatrix& matrix) const override;
+
  private:
   sk_sp<SkShader> shader_;
   SkRect mask_rect_;
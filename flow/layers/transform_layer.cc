@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/transform_layer.h"
 
+#include "flutter/flow/fingerprint.h"
+
 namespace flow {
 
 TransformLayer::TransformLayer() = default;
@@ -32,6 +34,21 @@ void TransformLayer::UpdateScene(SceneUpdateContext& context) {
 
 #endif  // defined(OS_FUCHSIA)
 
+void TransformLayer::CollectDamage(DamageContext* context,
+                                   const SkMatrix& matrix) const {
+  SkMatrix child_matrix;
+  child_matrix.setConcat(matrix, transform_);
+
+  DamageContext::AutoProperties properties(context, HashProperties(0));
+  CollectDamageChildren(context, child_matrix);
+}
+
+void TransformLayer::AddProperties(FingerprintBuilder* builder) const {
+  SkScalar transform_values[9];
+  transform_.get9(transform_values);
+  builder->Add(transform_values);
+}
+
 void TransformLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "TransformLayer::Paint");
   FXL_DCHECK(needs_painting());
@@ -20,10 +20,16 @@ class TransformLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void CollectDamage(DamageContext* context,
+                     const SkMatrix& matrix) const override;
+
 #if defined(OS_FUCHSIA)
   void UpdateScene(SceneUpdateContext& context) override;
 #endif  // defined(OS_FUCHSIA)
 
+ protected:
+  void AddProperties(FingerprintBuilder* builder) const override;
+
  private:
   SkMatrix transform_;
 
@@ -4,12 +4,15 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
+#include <atomic>
 #include <vector>
 
 #include "flutter/common/threads.h"
 #include "flutter/flow/paint_utils.h"
 #include "flutter/glue/trace_event.h"
 #include "lib/fxl/logging.h"
+#include "lib/fxl/synchronization/waitable_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkColorSpaceXformCanvas.h"
 #include "third_party/skia/include/core/SkImage.h"
@@ -18,8 +21,16 @@
 
 namespace flow {
 
-RasterCache::RasterCache(size_t threshold)
-    : threshold_(threshold), checkerboard_images_(false), weak_factory_(this) {}
+RasterCache::RasterCache(size_t threshold,
+                         size_t max_bytes,
+                         size_t max_unused_frames)
+    : threshold_(threshold),
+      max_unused_frames_(max_unused_frames),
+      max_bytes_(max_bytes),
+      frame_count_(0),
+      admission_policy_(AdmissionPolicy::kOpCount),
+      checkerboard_images_(false),
+      weak_factory_(this) {}
 
 RasterCache::~RasterCache() = default;
 
@@ -69,36 +80,45 @@ static bool IsPictureWorthRasterizing(SkPicture* picture,
   return picture->approximateOpCount() > 10;
 }
 
-RasterCacheResult RasterizePicture(SkPicture* picture,
-                                   GrContext* context,
-                                   const MatrixDecomposition& matrix,
-                                   SkColorSpace* dst_color_space,
-#if defined(OS_FUCHSIA)
-                                   scenic::Metrics* metrics,
-#endif
-                                   bool checkerboard) {
-  TRACE_EVENT0("flutter", "RasterCachePopulate");
-
+static SkRect PhysicalRect(const SkRect& logical_rect,
+                           const MatrixDecomposition& matrix,
+                           float metrics_scale_x,
+                           float metrics_scale_y) {
   const SkVector3& scale = matrix.scale();
-
-  const SkRect logical_rect = picture->cullRect();
-
-#if defined(OS_FUCHSIA)
-  float metrics_scale_x = metrics->scale_x;
-  float metrics_scale_y = metrics->scale_y;
-#else
-  float metrics_scale_x = 1.f;
-  float metrics_scale_y = 1.f;
-#endif
-
-  const SkRect physical_rect = SkRect::MakeWH(
+  return SkRect::MakeWH(
       std::fabs(logical_rect.width() * metrics_scale_x * scale.x()),
       std::fabs(logical_rect.height() * metrics_scale_y * scale.y()));
+}
 
-  const SkImageInfo image_info = SkImageInfo::MakeN32Premul(
+static SkImageInfo PhysicalImageInfo(const SkRect& physical_rect) {
+  return SkImageInfo::MakeN32Premul(
       std::ceil(physical_rect.width()),  // physical width
       std::ceil(physical_rect.height())  // physical height
   );
+}
+
+static size_t ImageByteSize(const SkImageInfo& info) {
+  return static_cast<size_t>(info.width()) * info.height() *
+         info.bytesPerPixel();
+}
+
+static RasterCacheResult Rasterize(
+    GrContext* context,
+    const MatrixDecomposition& matrix,
+    SkColorSpace* dst_color_space,
+    float metrics_scale_x,
+    float metrics_scale_y,
+    const SkRect& logical_rect,
+    bool checkerboard,
+    const std::function<void(SkCanvas*)>& draw_function) {
+  TRACE_EVENT0("flutter", "RasterCachePopulate");
+
+  const SkVector3& scale = matrix.scale();
+
+  const SkRect physical_rect =
+      PhysicalRect(logical_rect, matrix, metrics_scale_x, metrics_scale_y);
+
+  const SkImageInfo image_info = PhysicalImageInfo(physical_rect);
 
   sk_sp<SkSurface> surface =
       context
@@ -123,7 +143,7 @@ RasterCacheResult RasterizePicture(SkPicture* picture,
   canvas->scale(std::abs(scale.x() * metrics_scale_x),
                 std::abs(scale.y() * metrics_scale_y));
   canvas->translate(-logical_rect.left(), -logical_rect.top());
-  canvas->drawPicture(picture);
+  draw_function(canvas);
 
   if (checkerboard) {
     DrawCheckerboard(canvas, logical_rect);
@@ -136,6 +156,28 @@ RasterCacheResult RasterizePicture(SkPicture* picture,
   };
 }
 
+RasterCacheResult RasterizePicture(SkPicture* picture,
+                                   GrContext* context,
+                                   const MatrixDecomposition& matrix,
+                                   SkColorSpace* dst_color_space,
+#if defined(OS_FUCHSIA)
+                                   scenic::Metrics* metrics,
+#endif
+                                   bool checkerboard) {
+#if defined(OS_FUCHSIA)
+  float metrics_scale_x = metrics->scale_x;
+  float metrics_scale_y = metrics->scale_y;
+#else
+  float metrics_scale_x = 1.f;
+  float metrics_scale_y = 1.f;
+#endif
+
+  return Rasterize(
+      context, matrix, dst_color_space, metrics_scale_x, metrics_scale_y,
+      picture->cullRect(), checkerboard,
+      [picture](SkCanvas* canvas) { canvas->drawPicture(picture); });
+}
+
 static inline size_t ClampSize(size_t value, size_t min, size_t max) {
   if (value > max) {
     return max;
@@ -148,6 +190,131 @@ static inline size_t ClampSize(size_t value, size_t min, size_t max) {
   return value;
 }
 
+// The number of accesses after which an entry is considered to be reused
+// in every frame.
+static constexpr size_t kMaxAccessCount = 16;
+
+// The time that must be saved to justify taking up the entire byte budget.
+static constexpr double kFullBudgetMilliseconds = 8.0;
+
+void RasterCache::RecordAccess(Entry& entry) {
+  entry.access_count = ClampSize(entry.access_count + 1, 0,
+                                 std::max(threshold_, kMaxAccessCount));
+  entry.last_used_frame = frame_count_;
+}
+
+bool RasterCache::TouchEntry(Entry& entry) {
+  RecordAccess(entry);
+
+  if (entry.access_count < threshold_ || threshold_ == 0) {
+    // Frame threshold has not yet been reached.
+    metrics_.miss_count++;
+    return false;
+  }
+
+  return true;
+}
+
+bool RasterCache::TouchPictureEntry(Entry& entry,
+                                    const SkPicture& picture,
+                                    size_t bytes) {
+  RecordAccess(entry);
+
+  if (entry.image.is_valid() || entry.pending) {
+    return true;
+  }
+
+  auto found = picture_costs_.find(picture.uniqueID());
+  if (found == picture_costs_.end() || entry.access_count < threshold_ ||
+      threshold_ == 0 || max_bytes_ == 0) {
+    // Not drawn directly yet, or the frame threshold has not been reached.
+    metrics_.miss_count++;
+    return false;
+  }
+
+  // Every frame the picture is drawn from the cache saves the difference
+  // between drawing it and drawing its image. The cost of the image is
+  // estimated from the images drawn so far. Weigh the time saved in the
+  // frames the picture was used in so far against the share of the budget
+  // its image would take.
+  const double saved_per_frame =
+      found->second.draw_time.ToMillisecondsF() -
+      bytes * image_draw_nanoseconds_per_byte_ / 1e6;
+  const double saved = saved_per_frame * entry.access_count;
+  const double memory_cost = kFullBudgetMilliseconds * bytes / max_bytes_;
+
+  if (saved_per_frame <= 0.0 || saved < memory_cost) {
+    metrics_.miss_count++;
+    return false;
+  }
+
+  return true;
+}
+
+void RasterCache::RecordImageDrawTime(const SkImage& image,
+                                      fxl::TimeDelta time) {
+  const size_t bytes =
+      ImageByteSize(SkImageInfo::MakeN32Premul(image.width(), image.height()));
+  if (bytes == 0) {
+    return;
+  }
+  const double nanoseconds_per_byte =
+      static_cast<double>(time.ToNanoseconds()) / bytes;
+  if (image_draw_count_ == 0) {
+    image_draw_nanoseconds_per_byte_ = nanoseconds_per_byte;
+  } else {
+    // Smooth out the noise of individual measurements.
+    image_draw_nanoseconds_per_byte_ =
+        (image_draw_nanoseconds_per_byte_ * 3 + nanoseconds_per_byte) / 4;
+  }
+  image_draw_count_++;
+}
+
+void RasterCache::RecordPictureDrawTime(const SkPicture& picture,
+                                        fxl::TimeDelta time) {
+  auto inserted = picture_costs_.emplace(picture.uniqueID(), PictureCost());
+  PictureCost& cost = inserted.first->second;
+  if (inserted.second) {
+    cost.draw_time = time;
+  } else {
+    // Smooth out the noise of individual measurements.
+    cost.draw_time = fxl::TimeDelta::FromNanoseconds(
+        (cost.draw_time.ToNanoseconds() * 3 + time.ToNanoseconds()) / 4);
+  }
+  cost.last_used_frame = frame_count_;
+}
+
+RasterCacheResult RasterCache::PopulateEntry(
+    Entry& entry,
+    size_t bytes,
+    const std::function<RasterCacheResult()>& rasterize) {
+  if (entry.image.is_valid()) {
+    metrics_.hit_count++;
+    return entry.image;
+  }
+
+  metrics_.miss_count++;
+
+  // Entries used in this frame (including this one) are never evicted, so the
+  // reference to the entry remains valid.
+  if (!EvictUntilFits(bytes)) {
+    // The image does not fit in the budget. Draw the contents directly
+    // instead.
+    return {};
+  }
+
+  entry.image = rasterize();
+
+  if (entry.image.is_valid()) {
+    entry.bytes = bytes;
+    metrics_.current_bytes += bytes;
+    metrics_.peak_bytes = std::max(metrics_.peak_bytes, metrics_.current_bytes);
+    metrics_.image_count++;
+  }
+
+  return entry.image;
+}
+
 RasterCacheResult RasterCache::GetPrerolledImage(
     GrContext* context,
     SkPicture* picture,
@@ -158,7 +325,50 @@ RasterCacheResult RasterCache::GetPrerolledImage(
 #endif
     bool is_complex,
     bool will_change) {
-  if (!IsPictureWorthRasterizing(picture, will_change, is_complex)) {
+  return GetPictureImage(context, picture, transformation_matrix,
+                         dst_color_space,
+#if defined(OS_FUCHSIA)
+                         metrics,
+#endif
+                         is_complex, will_change, nullptr);
+}
+
+void RasterCache::PrerollPicture(GrContext* context,
+                                 SkPicture* picture,
+                                 const SkMatrix& transformation_matrix,
+                                 SkColorSpace* dst_color_space,
+#if defined(OS_FUCHSIA)
+                                 scenic::Metrics* metrics,
+#endif
+                                 bool is_complex,
+                                 bool will_change,
+                                 RasterCacheResult* result) {
+  *result = GetPictureImage(context, picture, transformation_matrix,
+                            dst_color_space,
+#if defined(OS_FUCHSIA)
+                            metrics,
+#endif
+                            is_complex, will_change, result);
+}
+
+RasterCacheResult RasterCache::GetPictureImage(
+    GrContext* context,
+    SkPicture* picture,
+    const SkMatrix& transformation_matrix,
+    SkColorSpace* dst_color_space,
+#if defined(OS_FUCHSIA)
+    scenic::Metrics* metrics,
+#endif
+    bool is_complex,
+    bool will_change,
+    RasterCacheResult* deferred_result) {
+  // The framework hint takes precedence over measurements.
+  const bool use_measured_cost =
+      !is_complex && admission_policy_ == AdmissionPolicy::kMeasuredCost;
+
+  if (use_measured_cost ? will_change || !CanRasterizePicture(picture)
+                        : !IsPictureWorthRasterizing(picture, will_change,
+                                                     is_complex)) {
     // We only deal with pictures that are worthy of rasterization.
     return {};
   }
@@ -178,44 +388,319 @@ RasterCacheResult RasterCache::GetPrerolledImage(
 #endif
                            matrix);
 
-  Entry& entry = cache_[cache_key];
-  entry.access_count = ClampSize(entry.access_count + 1, 0, threshold_);
-  entry.used_this_frame = true;
+#if defined(OS_FUCHSIA)
+  const SkRect physical_rect = PhysicalRect(picture->cullRect(), matrix,
+                                            metrics->scale_x, metrics->scale_y);
+#else
+  const SkRect physical_rect =
+      PhysicalRect(picture->cullRect(), matrix, 1.f, 1.f);
+#endif
+  const size_t bytes = ImageByteSize(PhysicalImageInfo(physical_rect));
 
-  if (entry.access_count < threshold_ || threshold_ == 0) {
-    // Frame threshold has not yet been reached.
+  Entry& entry = cache_[cache_key];
+  const bool admitted = use_measured_cost
+                            ? TouchPictureEntry(entry, *picture, bytes)
+                            : TouchEntry(entry);
+  if (!admitted) {
     return {};
   }
 
-  if (!entry.image.is_valid()) {
-    entry.image = RasterizePicture(picture, context, matrix, dst_color_space,
+  // Only the software backend may rasterize off the current thread. Skia GPU
+  // contexts are bound to a single thread.
+  if (deferred_result != nullptr && context == nullptr &&
+      !worker_task_runners_.empty()) {
+    // The deferred rasterization outlives this call, so it holds on to its own
+    // copies of the arguments.
+    DeferEntry(
+        entry, bytes,
+        [picture = sk_ref_sp(picture), transformation_matrix,
+         color_space = sk_ref_sp(dst_color_space),
+#if defined(OS_FUCHSIA)
+         metrics,
+#endif
+         checkerboard = checkerboard_images_]() {
+          return RasterizePicture(picture.get(), nullptr,
+                                  MatrixDecomposition(transformation_matrix),
+                                  color_space.get(),
 #if defined(OS_FUCHSIA)
-                                   metrics,
+                                  metrics,
 #endif
-                                   checkerboard_images_);
+                                  checkerboard);
+        },
+        deferred_result);
+    return entry.image;
   }
 
-  return entry.image;
+  return PopulateEntry(entry, bytes, [&]() {
+    return RasterizePicture(picture, context, matrix, dst_color_space,
+#if defined(OS_FUCHSIA)
+                            metrics,
+#endif
+                            checkerboard_images_);
+  });
+}
+
+void RasterCache::DeferEntry(Entry& entry,
+                             size_t bytes,
+                             std::function<RasterCacheResult()> rasterize,
+                             RasterCacheResult* result) {
+  if (entry.image.is_valid()) {
+    metrics_.hit_count++;
+    return;
+  }
+
+  if (entry.pending) {
+    // Another layer of this frame draws the same picture at the same scale.
+    for (auto& pending : pending_) {
+      if (pending.entry == &entry) {
+        pending.results.push_back(result);
+        break;
+      }
+    }
+    return;
+  }
+
+  metrics_.miss_count++;
+
+  if (!EvictUntilFits(bytes)) {
+    return;
+  }
+
+  // Reserve the bytes right away so that the budget accounts for all images
+  // of the frame before any of them is rasterized.
+  metrics_.current_bytes += bytes;
+  entry.pending = true;
+  pending_.push_back({&entry, bytes, std::move(rasterize), {}, {result}});
+}
+
+void RasterCache::RasterizePending() {
+  if (pending_.empty()) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "RasterCache::RasterizePending");
+
+  std::vector<PendingRasterization> pending;
+  pending.swap(pending_);
+
+  // Start with the largest images as they take the longest to rasterize.
+  std::sort(pending.begin(), pending.end(),
+            [](const PendingRasterization& a, const PendingRasterization& b) {
+              return a.bytes > b.bytes;
+            });
+
+  std::atomic<size_t> next(0);
+  auto rasterize = [&pending, &next]() {
+    for (size_t i = next++; i < pending.size(); i = next++) {
+      pending[i].image = pending[i].rasterize();
+    }
+  };
+
+  // The calling thread takes part as well, so one worker less is needed.
+  const size_t worker_count =
+      std::min(worker_task_runners_.size(), pending.size() - 1);
+  std::atomic<size_t> running_workers(worker_count);
+  fxl::AutoResetWaitableEvent workers_done;
+  for (size_t i = 0; i < worker_count; i++) {
+    worker_task_runners_[i]->PostTask(
+        [&rasterize, &running_workers, &workers_done]() {
+          rasterize();
+          if (--running_workers == 0) {
+            workers_done.Signal();
+          }
+        });
+  }
+
+  rasterize();
+
+  if (worker_count > 0) {
+    workers_done.Wait();
+  }
+
+  // Entries used in this frame are never evicted, so all entries of the
+  // pending rasterizations are still present.
+  for (auto& rasterization : pending) {
+    Entry& entry = *rasterization.entry;
+    entry.pending = false;
+
+    if (!rasterization.image.is_valid()) {
+      metrics_.current_bytes -= rasterization.bytes;
+      continue;
+    }
+
+    entry.image = rasterization.image;
+    entry.bytes = rasterization.bytes;
+    metrics_.peak_bytes = std::max(metrics_.peak_bytes, metrics_.current_bytes);
+    metrics_.image_count++;
+
+    for (RasterCacheResult* result : rasterization.results) {
+      *result = entry.image;
+    }
+  }
+}
+
+void RasterCache::SetWorkerTaskRunners(
+    std::vector<fxl::RefPtr<fxl::TaskRunner>> task_runners) {
+  worker_task_runners_ = std::move(task_runners);
+}
+
+static RasterCacheKey LayerKey(uint64_t layer_fingerprint,
+                               const MatrixDecomposition& matrix) {
+  // Layers are only drawn from the cache when painted directly to the frame
+  // canvas, which is never scaled by the system compositor metrics.
+  return RasterCacheKey(RasterCacheKey::Kind::kLayer, layer_fingerprint,
+#if defined(OS_FUCHSIA)
+                        1.f, 1.f,
+#endif
+                        matrix);
+}
+
+bool RasterCache::PrerollLayer(uint64_t layer_fingerprint,
+                               const std::vector<uint8_t>& layer_description,
+                               const SkMatrix& transformation_matrix) {
+  if (layer_fingerprint == 0) {
+    // The output of the subtree is not fully described by the layer tree.
+    return false;
+  }
+
+  const MatrixDecomposition matrix(transformation_matrix);
+
+  if (!matrix.IsValid()) {
+    return false;
+  }
+
+  Entry& entry = cache_[LayerKey(layer_fingerprint, matrix)];
+  if (entry.access_count == 0) {
+    entry.layer_description = layer_description;
+  } else if (entry.layer_description != layer_description) {
+    // A different subtree with the same fingerprint.
+    metrics_.miss_count++;
+    return false;
+  }
+
+  return TouchEntry(entry);
+}
+
+RasterCacheResult RasterCache::GetRasterizedLayer(
+    uint64_t layer_fingerprint,
+    const SkMatrix& transformation_matrix,
+    const SkRect& bounds,
+    GrContext* context,
+    SkColorSpace* dst_color_space,
+    const std::function<void(SkCanvas*)>& paint_function) {
+  if (bounds.isEmpty() || !bounds.isFinite()) {
+    return {};
+  }
+
+  const MatrixDecomposition matrix(transformation_matrix);
+
+  if (!matrix.IsValid()) {
+    return {};
+  }
+
+  auto found = cache_.find(LayerKey(layer_fingerprint, matrix));
+  if (found == cache_.end()) {
+    // The layer was not prerolled in this frame.
+    return {};
+  }
+
+  const size_t bytes =
+      ImageByteSize(PhysicalImageInfo(PhysicalRect(bounds, matrix, 1.f, 1.f)));
+
+  return PopulateEntry(found->second, bytes, [&]() {
+    return Rasterize(context, matrix, dst_color_space, 1.f, 1.f, bounds,
+                     checkerboard_images_, paint_function);
+  });
+}
+
+bool RasterCache::EvictUntilFits(size_t bytes) {
+  if (bytes > max_bytes_) {
+    return false;
+  }
+
+  if (metrics_.current_bytes + bytes <= max_bytes_) {
+    return true;
+  }
+
+  // Collect the rasterized entries that were not used in this frame and evict
+  // them least recently used first. Among entries last used in the same
+  // frame, the largest one goes first.
+  std::vector<RasterCacheKey::Map<Entry>::iterator> candidates;
+  for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+    const Entry& entry = it->second;
+    if (entry.last_used_frame != frame_count_ && entry.image.is_valid()) {
+      candidates.push_back(it);
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const RasterCacheKey::Map<Entry>::iterator& a,
+               const RasterCacheKey::Map<Entry>::iterator& b) {
+              if (a->second.last_used_frame != b->second.last_used_frame) {
+                return a->second.last_used_frame < b->second.last_used_frame;
+              }
+              return a->second.bytes > b->second.bytes;
+            });
+
+  for (auto it : candidates) {
+    if (metrics_.current_bytes + bytes <= max_bytes_) {
+      break;
+    }
+    EvictEntry(it);
+    metrics_.eviction_count++;
+  }
+
+  return metrics_.current_bytes + bytes <= max_bytes_;
+}
+
+void RasterCache::EvictEntry(RasterCacheKey::Map<Entry>::iterator it) {
+  const Entry& entry = it->second;
+  if (entry.image.is_valid()) {
+    FXL_DCHECK(metrics_.current_bytes >= entry.bytes);
+    metrics_.current_bytes -= entry.bytes;
+    metrics_.image_count--;
+  }
+  cache_.erase(it);
 }
 
 void RasterCache::SweepAfterFrame() {
   std::vector<RasterCacheKey::Map<Entry>::iterator> dead;
 
   for (auto it = cache_.begin(); it != cache_.end(); ++it) {
-    Entry& entry = it->second;
-    if (!entry.used_this_frame) {
+    const Entry& entry = it->second;
+    if (frame_count_ - entry.last_used_frame > max_unused_frames_) {
       dead.push_back(it);
     }
-    entry.used_this_frame = false;
   }
 
   for (auto it : dead) {
-    cache_.erase(it);
+    EvictEntry(it);
   }
+
+  for (auto it = picture_costs_.begin(); it != picture_costs_.end();) {
+    if (frame_count_ - it->second.last_used_frame > max_unused_frames_) {
+      it = picture_costs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  frame_count_++;
 }
 
 void RasterCache::Clear() {
+  pending_.clear();
   cache_.clear();
+  metrics_.current_bytes = 0;
+  metrics_.image_count = 0;
+}
+
+void RasterCache::SetMaxBytes(size_t max_bytes) {
+  max_bytes_ = max_bytes;
+
+  // Shrink to the new budget right away. Entries that are in use in the
+  // current frame (if any) are evicted in subsequent frames instead.
+  EvictUntilFits(0);
 }
 
 void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
@@ -5,16 +5,22 @@
 #ifndef FLUTTER_FLOW_RASTER_CACHE_H_
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache_key.h"
 #include "lib/fxl/macros.h"
+#include "lib/fxl/memory/ref_ptr.h"
 #include "lib/fxl/memory/weak_ptr.h"
+#include "lib/fxl/tasks/task_runner.h"
+#include "lib/fxl/time/time_delta.h"
 #if defined(OS_FUCHSIA)
 #include "lib/ui/scenic/fidl/events.fidl.h"
 #endif
+#include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -49,7 +55,47 @@ class RasterCacheResult {
 
 class RasterCache {
  public:
-  explicit RasterCache(size_t threshold = 3);
+  // The default budget for the bytes held by all rasterized images.
+  static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+  // The default number of consecutive frames an entry may go unused before it
+  // is swept.
+  static constexpr size_t kDefaultMaxUnusedFrames = 3;
+
+  struct Metrics {
+    // The bytes currently held by rasterized images.
+    size_t current_bytes = 0;
+    // The largest value of |current_bytes| since the cache was created.
+    size_t peak_bytes = 0;
+    // The number of rasterized images currently held.
+    size_t image_count = 0;
+    // The number of prerolls that found an already rasterized image.
+    size_t hit_count = 0;
+    // The number of prerolls of pictures worth rasterizing that did not find
+    // a rasterized image.
+    size_t miss_count = 0;
+    // The number of images evicted to stay within the byte budget.
+    size_t eviction_count = 0;
+  };
+
+  // Decides which pictures that are not marked as complex by the framework
+  // are rasterized.
+  enum class AdmissionPolicy {
+    // Pictures with more than a handful of operations are rasterized once
+    // they were used in |threshold| frames.
+    kOpCount,
+    // Pictures used in |threshold| frames are rasterized if the time saved
+    // by drawing their image instead (see |RecordPictureDrawTime| and
+    // |RecordImageDrawTime|) outweighs the share of the byte budget the image
+    // would take. Only meaningful where drawing a picture rasterizes it, which
+    // is the case for the software backend but not for the GPU backend, where
+    // the measured time only covers recording the GPU work.
+    kMeasuredCost,
+  };
+
+  explicit RasterCache(size_t threshold = 3,
+                       size_t max_bytes = kDefaultMaxBytes,
+                       size_t max_unused_frames = kDefaultMaxUnusedFrames);
 
   ~RasterCache();
 
@@ -63,24 +109,164 @@ class RasterCache {
                                       bool is_complex,
                                       bool will_change);
 
+  // Like |GetPrerolledImage|, but pictures drawn without a GrContext may be
+  // rasterized concurrently with other pictures of the same frame on the
+  // worker task runners. In that case, |result| is left empty until
+  // |RasterizePending| assigns the rasterized image to it, so it must outlive
+  // that call.
+  void PrerollPicture(GrContext* context,
+                      SkPicture* picture,
+                      const SkMatrix& transformation_matrix,
+                      SkColorSpace* dst_color_space,
+#if defined(OS_FUCHSIA)
+                      scenic::Metrics* metrics,
+#endif
+                      bool is_complex,
+                      bool will_change,
+                      RasterCacheResult* result);
+
+  // Rasterizes all pictures deferred by |PrerollPicture| in the current
+  // frame, spreading them over the worker task runners and the calling
+  // thread, and waits for them. Must be called after preroll and before
+  // paint.
+  void RasterizePending();
+
+  // Sets the task runners that deferred rasterizations are performed on. No
+  // rasterization is deferred if there are none.
+  void SetWorkerTaskRunners(
+      std::vector<fxl::RefPtr<fxl::TaskRunner>> task_runners);
+
+  // Layer subtrees are cached in two steps. During preroll, |PrerollLayer|
+  // records a use of the subtree identified by |layer_fingerprint| (see
+  // |Layer::fingerprint|) in the coordinate space of |transformation_matrix|.
+  // It returns true if the subtree has been used in enough frames to be drawn
+  // from the cache. In that case, the image must be obtained during paint
+  // from |GetRasterizedLayer|, which rasterizes the subtree within |bounds|
+  // using |paint_function| if it is not cached yet.
+  //
+  // |layer_description| (see |Layer::DescribeSubtree|) must match that of the
+  // subtree the entry was created for. A subtree whose fingerprint collides
+  // with that of another subtree is not cached.
+  bool PrerollLayer(uint64_t layer_fingerprint,
+                    const std::vector<uint8_t>& layer_description,
+                    const SkMatrix& transformation_matrix);
+
+  RasterCacheResult GetRasterizedLayer(
+      uint64_t layer_fingerprint,
+      const SkMatrix& transformation_matrix,
+      const SkRect& bounds,
+      GrContext* context,
+      SkColorSpace* dst_color_space,
+      const std::function<void(SkCanvas*)>& paint_function);
+
+  // Records how long drawing |picture| directly (without the cache) took.
+  // Only the most recent measurements of the pictures used in the last few
+  // frames are retained.
+  void RecordPictureDrawTime(const SkPicture& picture, fxl::TimeDelta time);
+
+  // Records how long drawing a rasterized image took. Until the first image
+  // is drawn, drawing images is taken to be free.
+  void RecordImageDrawTime(const SkImage& image, fxl::TimeDelta time);
+
+  void SetAdmissionPolicy(AdmissionPolicy policy) {
+    admission_policy_ = policy;
+  }
+
+  AdmissionPolicy admission_policy() const { return admission_policy_; }
+
   void SweepAfterFrame();
 
   void Clear();
 
   void SetCheckboardCacheImages(bool checkerboard);
 
+  // Sets the budget for the bytes held by all rasterized images. Least
+  // recently used images are evicted to make room for new ones. Images used
+  // in the current frame are never evicted; pictures that do not fit are
+  // drawn directly instead.
+  void SetMaxBytes(size_t max_bytes);
+
+  size_t max_bytes() const { return max_bytes_; }
+
+  const Metrics& metrics() const { return metrics_; }
+
  private:
   struct Entry {
-    bool used_this_frame = false;
+    size_t last_used_frame = 0;
     size_t access_count = 0;
+    size_t bytes = 0;
+    // Whether the image is being rasterized in |pending_|.
+    bool pending = false;
     RasterCacheResult image;
+    // The description of the layer subtree of a layer entry.
+    std::vector<uint8_t> layer_description;
+  };
+
+  struct PictureCost {
+    size_t last_used_frame = 0;
+    fxl::TimeDelta draw_time;
+  };
+
+  struct PendingRasterization {
+    Entry* entry;
+    size_t bytes;
+    std::function<RasterCacheResult()> rasterize;
+    RasterCacheResult image;
+    std::vector<RasterCacheResult*> results;
   };
 
   const size_t threshold_;
+  const size_t max_unused_frames_;
+  size_t max_bytes_;
+  size_t frame_count_;
+  Metrics metrics_;
+  AdmissionPolicy admission_policy_;
   RasterCacheKey::Map<Entry> cache_;
+  std::unordered_map<uint32_t, PictureCost> picture_costs_;
+  double image_draw_nanoseconds_per_byte_ = 0.0;
+  size_t image_draw_count_ = 0;
   bool checkerboard_images_;
+  std::vector<fxl::RefPtr<fxl::TaskRunner>> worker_task_runners_;
+  std::vector<PendingRasterization> pending_;
   fxl::WeakPtrFactory<RasterCache> weak_factory_;
 
+  void RecordAccess(Entry& entry);
+
+  // Records an access to the entry. Returns true if the entry has been
+  // accessed in enough frames to be rasterized.
+  bool TouchEntry(Entry& entry);
+
+  // Records an access to the entry of |picture|. Returns true if the measured
+  // cost of drawing the picture justifies rasterizing it into |bytes|.
+  bool TouchPictureEntry(Entry& entry, const SkPicture& picture, size_t bytes);
+
+  RasterCacheResult PopulateEntry(
+      Entry& entry,
+      size_t bytes,
+      const std::function<RasterCacheResult()>& rasterize);
+
+  RasterCacheResult GetPictureImage(GrContext* context,
+                                    SkPicture* picture,
+                                    const SkMatrix& transformation_matrix,
+                                    SkColorSpace* dst_color_space,
+#if defined(OS_FUCHSIA)
+                                    scenic::Metrics* metrics,
+#endif
+                                    bool is_complex,
+                                    bool will_change,
+                                    RasterCacheResult* deferred_result);
+
+  // Reserves room for the image of the entry and queues its rasterization.
+  // |result| is assigned the image by |RasterizePending|.
+  void DeferEntry(Entry& entry,
+                  size_t bytes,
+                  std::function<RasterCacheResult()> rasterize,
+                  RasterCacheResult* result);
+
+  bool EvictUntilFits(size_t bytes);
+
+  void EvictEntry(RasterCacheKey::Map<Entry>::iterator it);
+
   FXL_DISALLOW_COPY_AND_ASSIGN(RasterCache);
 };
 
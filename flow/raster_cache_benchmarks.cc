@@ -0,0 +1,104 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "flutter/flow/raster_cache.h"
+#include "lib/fxl/time/time_point.h"
+#include "third_party/benchmark/include/benchmark/benchmark_api.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkBlurMaskFilter.h"
+
+namespace flow {
+
+// Many operations that are cheap to draw. Cached by the op count policy.
+static sk_sp<SkPicture> MakeCheapPicture(SkColor color) {
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(100, 100));
+  SkPaint paint;
+  paint.setColor(color);
+  for (int i = 0; i < 20; i++) {
+    canvas->drawRect(SkRect::MakeXYWH(i * 5, i * 5, 5, 5), paint);
+  }
+  return recorder.finishRecordingAsPicture();
+}
+
+// A single operation that is expensive to draw. Never cached by the op count
+// policy.
+static sk_sp<SkPicture> MakeExpensivePicture(SkColor color) {
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(300, 300));
+  SkPaint paint;
+  paint.setColor(color);
+  paint.setAntiAlias(true);
+  paint.setMaskFilter(SkBlurMaskFilter::Make(kNormal_SkBlurStyle, 20));
+  SkPath path;
+  path.addCircle(150, 150, 100);
+  path.addCircle(120, 120, 60);
+  canvas->drawPath(path, paint);
+  return recorder.finishRecordingAsPicture();
+}
+
+// Prerolls and paints the pictures the way PictureLayer does.
+static void DrawFrame(RasterCache& cache,
+                      SkCanvas* canvas,
+                      const std::vector<sk_sp<SkPicture>>& pictures) {
+  const SkMatrix matrix = SkMatrix::I();
+  for (const auto& picture : pictures) {
+    RasterCacheResult result = cache.GetPrerolledImage(
+        nullptr, picture.get(), matrix, nullptr, false, false);
+    const fxl::TimePoint start = fxl::TimePoint::Now();
+    if (result.is_valid()) {
+      SkPaint paint;
+      paint.setFilterQuality(kLow_SkFilterQuality);
+      canvas->drawImageRect(result.image(), result.source_rect(),
+                            result.destination_rect(), &paint,
+                            SkCanvas::kStrict_SrcRectConstraint);
+      cache.RecordImageDrawTime(*result.image(),
+                                fxl::TimePoint::Now() - start);
+    } else {
+      canvas->drawPicture(picture.get());
+      cache.RecordPictureDrawTime(*picture, fxl::TimePoint::Now() - start);
+    }
+  }
+  cache.SweepAfterFrame();
+}
+
+// Each iteration is one frame of a scene that does not change. Reports the
+// hit rate of the cache in the label.
+static void BM_RasterCacheAdmission(benchmark::State& state) {
+  std::vector<sk_sp<SkPicture>> pictures;
+  for (int i = 0; i < 16; i++) {
+    pictures.push_back(MakeCheapPicture(SkColorSetARGB(255, i * 16, 0, 0)));
+  }
+  for (int i = 0; i < 4; i++) {
+    pictures.push_back(MakeExpensivePicture(SkColorSetARGB(255, 0, 0, i * 64)));
+  }
+
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(1000, 1000);
+
+  RasterCache cache;
+  cache.SetAdmissionPolicy(
+      static_cast<RasterCache::AdmissionPolicy>(state.range(0)));
+
+  while (state.KeepRunning()) {
+    DrawFrame(cache, surface->getCanvas(), pictures);
+  }
+
+  const RasterCache::Metrics& metrics = cache.metrics();
+  const size_t lookups = metrics.hit_count + metrics.miss_count;
+  state.SetLabel(
+      "hit rate " +
+      std::to_string(lookups ? 100 * metrics.hit_count / lookups : 0) +
+      "%, " + std::to_string(metrics.current_bytes / 1024) + " KB cached");
+}
+BENCHMARK(BM_RasterCacheAdmission)
+    ->Arg(static_cast<int>(RasterCache::AdmissionPolicy::kOpCount))
+    ->Arg(static_cast<int>(RasterCache::AdmissionPolicy::kMeasuredCost));
+
+}  // namespace flow
+
+BENCHMARK_MAIN();
@@ -15,13 +15,37 @@ namespace flow {
 
 class RasterCacheKey {
  public:
+  enum class Kind {
+    // The key identifies a single picture by its unique ID.
+    kPicture,
+    // The key identifies a layer subtree by its fingerprint.
+    kLayer,
+  };
+
   RasterCacheKey(const SkPicture& picture,
 #if defined(OS_FUCHSIA)
                  float metrics_scale_x,
                  float metrics_scale_y,
 #endif
                  const MatrixDecomposition& matrix)
-      : picture_id_(picture.uniqueID()),
+      : RasterCacheKey(Kind::kPicture,
+                       picture.uniqueID(),
+#if defined(OS_FUCHSIA)
+                       metrics_scale_x,
+                       metrics_scale_y,
+#endif
+                       matrix) {
+  }
+
+  RasterCacheKey(Kind kind,
+                 uint64_t id,
+#if defined(OS_FUCHSIA)
+                 float metrics_scale_x,
+                 float metrics_scale_y,
+#endif
+                 const MatrixDecomposition& matrix)
+      : kind_(kind),
+        id_(id),
 #if defined(OS_FUCHSIA)
         metrics_scale_x_(metrics_scale_x),
         metrics_scale_y_(metrics_scale_y),
@@ -30,7 +54,9 @@ class RasterCacheKey {
             SkISize::Make(matrix.scale().x() * 1e3, matrix.scale().y() * 1e3)) {
   }
 
-  uint32_t picture_id() const { return picture_id_; }
+  Kind kind() const { return kind_; }
+
+  uint64_t id() const { return id_; }
 
   const SkISize& scale_key() const { return scale_key_; }
 
@@ -41,14 +67,14 @@ class RasterCacheKey {
 
   struct Hash {
     std::size_t operator()(RasterCacheKey const& key) const {
-      return key.picture_id_;
+      return static_cast<std::size_t>(key.id_);
     }
   };
 
   struct Equal {
     constexpr bool operator()(const RasterCacheKey& lhs,
                               const RasterCacheKey& rhs) const {
-      return lhs.picture_id_ == rhs.picture_id_ &&
+      return lhs.kind_ == rhs.kind_ && lhs.id_ == rhs.id_ &&
 #if defined(OS_FUCHSIA)
              lhs.metrics_scale_x_ == rhs.metrics_scale_x_ &&
 
@@ -62,7 +88,8 @@ class RasterCacheKey {
   using Map = std::unordered_map<RasterCacheKey, Value, Hash, Equal>;
 
  private:
-  uint32_t picture_id_;
+  Kind kind_;
+  uint64_t id_;
 #if defined(OS_FUCHSIA)
   float metrics_scale_x_;
   float metrics_scale_y_;
@@ -2,10 +2,14 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
 #include "flutter/flow/raster_cache.h"
+#include "flutter/fml/thread.h"
 #include "gtest/gtest.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
 
 sk_sp<SkPicture> GetSamplePicture() {
   SkPictureRecorder recorder;
@@ -89,7 +93,208 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
   ASSERT_TRUE(cache.GetPrerolledImage(NULL, picture.get(), matrix, srgb.get(),
                                       true, false));  // 4
   cache.SweepAfterFrame();
-  cache.SweepAfterFrame();  // Extra frame without a preroll image access.
+  // Extra frames without a preroll image access.
+  for (size_t i = 0; i <= flow::RasterCache::kDefaultMaxUnusedFrames; i++) {
+    cache.SweepAfterFrame();
+  }
   ASSERT_FALSE(cache.GetPrerolledImage(NULL, picture.get(), matrix, srgb.get(),
                                        true, false));  // 5
 }
+
+TEST(RasterCache, EntriesSurviveUnusedFrames) {
+  size_t threshold = 1;
+  flow::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_TRUE(cache.GetPrerolledImage(NULL, picture.get(), matrix, srgb.get(),
+                                      true, false));
+  cache.SweepAfterFrame();
+  for (size_t i = 0; i < flow::RasterCache::kDefaultMaxUnusedFrames; i++) {
+    cache.SweepAfterFrame();
+  }
+  ASSERT_TRUE(cache.GetPrerolledImage(NULL, picture.get(), matrix, srgb.get(),
+                                      true, false));
+  ASSERT_EQ(cache.metrics().hit_count, 1u);
+  ASSERT_EQ(cache.metrics().miss_count, 1u);
+}
+
+TEST(RasterCache, ByteBudgetIsRespected) {
+  size_t threshold = 1;
+  auto picture = GetSamplePicture();
+  const size_t picture_bytes = 150 * 100 * 4;
+
+  // Not even a single picture fits.
+  flow::RasterCache cache(threshold, picture_bytes - 1);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(cache.GetPrerolledImage(NULL, picture.get(), matrix, srgb.get(),
+                                       true, false));
+  ASSERT_EQ(cache.metrics().current_bytes, 0u);
+}
+
+TEST(RasterCache, LeastRecentlyUsedEntriesAreEvicted) {
+  size_t threshold = 1;
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+  const size_t picture_bytes = 150 * 100 * 4;
+
+  // Only one picture fits at a time.
+  flow::RasterCache cache(threshold, picture_bytes);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_TRUE(cache.GetPrerolledImage(NULL, picture1.get(), matrix, srgb.get(),
+                                      true, false));
+  // Both pictures in the same frame. The first one may not be evicted.
+  ASSERT_FALSE(cache.GetPrerolledImage(NULL, picture2.get(), matrix,
+                                       srgb.get(), true, false));
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.GetPrerolledImage(NULL, picture2.get(), matrix, srgb.get(),
+                                      true, false));
+  cache.SweepAfterFrame();
+
+  ASSERT_EQ(cache.metrics().current_bytes, picture_bytes);
+  ASSERT_EQ(cache.metrics().peak_bytes, picture_bytes);
+  ASSERT_EQ(cache.metrics().image_count, 1u);
+  ASSERT_EQ(cache.metrics().eviction_count, 1u);
+}
+
+TEST(RasterCache, LayersAreRasterizedOnceThresholdIsReached) {
+  size_t threshold = 2;
+  flow::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  const uint64_t fingerprint = 42;
+  const std::vector<uint8_t> description = {1, 2, 3};
+  const SkRect bounds = SkRect::MakeWH(150, 100);
+
+  size_t paint_count = 0;
+  auto paint_function = [&paint_count](SkCanvas* canvas) {
+    paint_count++;
+    canvas->drawColor(SK_ColorRED);
+  };
+
+  ASSERT_FALSE(cache.PrerollLayer(fingerprint, description, matrix));  // 1
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.PrerollLayer(fingerprint, description, matrix));  // 2
+  ASSERT_TRUE(cache.GetRasterizedLayer(fingerprint, matrix, bounds, NULL, NULL,
+                                       paint_function));
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.PrerollLayer(fingerprint, description, matrix));  // 3
+  ASSERT_TRUE(cache.GetRasterizedLayer(fingerprint, matrix, bounds, NULL, NULL,
+                                       paint_function));
+  cache.SweepAfterFrame();
+
+  ASSERT_EQ(paint_count, 1u);
+  ASSERT_FALSE(cache.PrerollLayer(0, description, matrix));
+}
+
+TEST(RasterCache, LayersWithCollidingFingerprintsAreNotMixedUp) {
+  size_t threshold = 1;
+  flow::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  const uint64_t fingerprint = 42;
+  const std::vector<uint8_t> description = {1, 2, 3};
+  const std::vector<uint8_t> other_description = {1, 2, 4};
+
+  ASSERT_TRUE(cache.PrerollLayer(fingerprint, description, matrix));
+  ASSERT_FALSE(cache.PrerollLayer(fingerprint, other_description, matrix));
+  cache.SweepAfterFrame();
+  ASSERT_FALSE(cache.PrerollLayer(fingerprint, other_description, matrix));
+  ASSERT_TRUE(cache.PrerollLayer(fingerprint, description, matrix));
+  cache.SweepAfterFrame();
+}
+
+TEST(RasterCache, DeferredPicturesAreRasterizedOnWorkers) {
+  size_t threshold = 1;
+  flow::RasterCache cache(threshold);
+
+  fml::Thread worker("raster_cache_worker");
+  cache.SetWorkerTaskRunners({worker.GetTaskRunner()});
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  flow::RasterCacheResult result1;
+  flow::RasterCacheResult result2;
+  flow::RasterCacheResult result3;
+  cache.PrerollPicture(NULL, picture1.get(), matrix, srgb.get(), true, false,
+                       &result1);
+  cache.PrerollPicture(NULL, picture2.get(), matrix, srgb.get(), true, false,
+                       &result2);
+  // Same picture and matrix as the first one. Rasterized only once.
+  cache.PrerollPicture(NULL, picture1.get(), matrix, srgb.get(), true, false,
+                       &result3);
+  ASSERT_FALSE(result1);
+  ASSERT_FALSE(result2);
+  ASSERT_FALSE(result3);
+
+  cache.RasterizePending();
+  ASSERT_TRUE(result1);
+  ASSERT_TRUE(result2);
+  ASSERT_TRUE(result3);
+  ASSERT_EQ(result1.image(), result3.image());
+  ASSERT_EQ(cache.metrics().image_count, 2u);
+  cache.SweepAfterFrame();
+
+  // Already rasterized images are returned right away.
+  cache.PrerollPicture(NULL, picture1.get(), matrix, srgb.get(), true, false,
+                       &result1);
+  ASSERT_TRUE(result1);
+  cache.SweepAfterFrame();
+}
+
+TEST(RasterCache, MeasuredCostDecidesAdmission) {
+  size_t threshold = 3;
+  flow::RasterCache cache(threshold);
+  ASSERT_EQ(cache.admission_policy(),
+            flow::RasterCache::AdmissionPolicy::kOpCount);
+  cache.SetAdmissionPolicy(flow::RasterCache::AdmissionPolicy::kMeasuredCost);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto expensive_picture = GetSamplePicture();
+  auto cheap_picture = GetSamplePicture();
+
+  // An image the size of the pictures that takes 20us to draw.
+  sk_sp<SkImage> image =
+      SkSurface::MakeRasterN32Premul(150, 100)->makeImageSnapshot();
+  cache.RecordImageDrawTime(*image, fxl::TimeDelta::FromMicroseconds(20));
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  // Never drawn before, so the cost is unknown.
+  ASSERT_FALSE(cache.GetPrerolledImage(NULL, expensive_picture.get(), matrix,
+                                       srgb.get(), false, false));
+  ASSERT_FALSE(cache.GetPrerolledImage(NULL, cheap_picture.get(), matrix,
+                                       srgb.get(), false, false));
+  cache.RecordPictureDrawTime(*expensive_picture,
+                              fxl::TimeDelta::FromMilliseconds(5));
+  cache.RecordPictureDrawTime(*cheap_picture,
+                              fxl::TimeDelta::FromMicroseconds(1));
+  cache.SweepAfterFrame();
+
+  // The frame threshold has not been reached yet.
+  ASSERT_FALSE(cache.GetPrerolledImage(NULL, expensive_picture.get(), matrix,
+                                       srgb.get(), false, false));
+  ASSERT_FALSE(cache.GetPrerolledImage(NULL, cheap_picture.get(), matrix,
+                                       srgb.get(), false, false));
+  cache.SweepAfterFrame();
+
+  // Drawing the cheap picture is faster than drawing its image.
+  ASSERT_TRUE(cache.GetPrerolledImage(NULL, expensive_picture.get(), matrix,
+                                      srgb.get(), false, false));
+  ASSERT_FALSE(cache.GetPrerolledImage(NULL, cheap_picture.get(), matrix,
+                                       srgb.get(), false, false));
+  cache.SweepAfterFrame();
+}
@@ -200,6 +200,9 @@ SceneUpdateContext::ExecutePaintTasks(CompositorContext::ScopedFrame& frame) {
                                    frame.context().engine_time(),
                                    frame.context().memory_usage(),
                                    frame.context().texture_registry(),
+                                   false,
+                                   nullptr,
+                                   nullptr,
                                    false};
     canvas->restoreToCount(1);
     canvas->save();
@@ -6,12 +6,12 @@
 #define FLUTTER_FML_MESSAGE_LOOP_H_
 
 #include "flutter/fml/task_observer.h"
+#include "flutter/fml/task_runner.h"
 #include "lib/fxl/macros.h"
-#include "lib/fxl/tasks/task_runner.h"
+#include "lib/fxl/time/time_point.h"
 
 namespace fml {
 
-class TaskRunner;
 class MessageLoopImpl;
 
 class MessageLoop {
@@ -28,7 +28,12 @@ class MessageLoop {
 
   void RemoveTaskObserver(TaskObserver* observer);
 
-  fxl::RefPtr<fxl::TaskRunner> GetTaskRunner() const;
+  fxl::RefPtr<fml::TaskRunner> GetTaskRunner() const;
+
+  // Tasks posted with |TaskPriority::kIdle| are only run before |deadline|.
+  // The deadline is in the future until set otherwise. Must be called on the
+  // thread of the loop.
+  void SetIdleDeadline(fxl::TimePoint deadline);
 
   // Exposed for the embedder shell which allows clients to poll for events
   // instead of dedicating a thread to the message loop.
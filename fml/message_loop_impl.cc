@@ -42,13 +42,43 @@ fxl::RefPtr<MessageLoopImpl> MessageLoopImpl::Create() {
   return fxl::MakeRefCounted<::PlatformMessageLoopImpl>();
 }
 
-MessageLoopImpl::MessageLoopImpl() : order_(0), terminated_(false) {}
-
-MessageLoopImpl::~MessageLoopImpl() = default;
+MessageLoopImpl::MessageLoopImpl()
+    : idle_deadline_(fxl::TimePoint::Max()),
+      armed_wake_time_(fxl::TimePoint::Max()),
+      order_(0),
+      immediate_tasks_(nullptr),
+      terminated_(false) {}
+
+MessageLoopImpl::~MessageLoopImpl() {
+  // Tasks may have been posted after the loop stopped running.
+  ImmediateTask* task = immediate_tasks_.exchange(nullptr);
+  while (task != nullptr) {
+    ImmediateTask* next = task->next;
+    delete task;
+    task = next;
+  }
+}
 
-void MessageLoopImpl::PostTask(fxl::Closure task, fxl::TimePoint target_time) {
+void MessageLoopImpl::PostTask(fxl::Closure task,
+                               fxl::TimePoint target_time,
+                               TaskPriority priority) {
   FXL_DCHECK(task != nullptr);
-  RegisterTask(task, target_time);
+  RegisterTask(task, target_time, priority);
+}
+
+void MessageLoopImpl::SetIdleDeadline(fxl::TimePoint deadline) {
+  std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+  const bool extended = deadline > idle_deadline_;
+  idle_deadline_ = deadline;
+
+  // Idle tasks that were held back may run now.
+  if (extended && !idle_tasks_.empty()) {
+    const fxl::TimePoint now = fxl::TimePoint::Now();
+    const fxl::TimePoint next_wake_time = GetNextWakeTime(now);
+    if (next_wake_time < armed_wake_time_) {
+      ArmWakeUp(std::max(next_wake_time, now));
+    }
+  }
 }
 
 void MessageLoopImpl::RunExpiredTasksNow() {
@@ -95,7 +125,10 @@ void MessageLoopImpl::DoRun() {
   // from the implementations |Run| method which we know is on the correct
   // thread. Drop all pending tasks on the floor.
   std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+  TakeImmediateTasks();
+  frame_critical_tasks_ = {};
   delayed_tasks_ = {};
+  idle_tasks_ = {};
 }
 
 void MessageLoopImpl::DoTerminate() {
@@ -103,45 +136,162 @@ void MessageLoopImpl::DoTerminate() {
   Terminate();
 }
 
+void MessageLoopImpl::WakeUpImmediately() {
+  std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+  ArmWakeUp(fxl::TimePoint::Now());
+}
+
+void MessageLoopImpl::ArmWakeUp(fxl::TimePoint time_point) {
+  armed_wake_time_ = time_point;
+  WakeUp(time_point);
+}
+
+MessageLoopImpl::DelayedTaskQueue& MessageLoopImpl::QueueForPriority(
+    TaskPriority priority) {
+  switch (priority) {
+    case TaskPriority::kFrameCritical:
+      return frame_critical_tasks_;
+    case TaskPriority::kIdle:
+      return idle_tasks_;
+    case TaskPriority::kNormal:
+      break;
+  }
+  return delayed_tasks_;
+}
+
 void MessageLoopImpl::RegisterTask(fxl::Closure task,
-                                   fxl::TimePoint target_time) {
+                                   fxl::TimePoint target_time,
+                                   TaskPriority priority) {
   FXL_DCHECK(task != nullptr);
   if (terminated_) {
     // If the message loop has already been terminated, PostTask should destruct
     // |task| synchronously within this function.
     return;
   }
+
+  if (target_time <= fxl::TimePoint::Now()) {
+    auto immediate_task = new ImmediateTask{std::move(task), target_time,
+                                            priority, immediate_tasks_.load()};
+    while (!immediate_tasks_.compare_exchange_weak(immediate_task->next,
+                                                   immediate_task)) {
+    }
+    // The loop has not taken the tasks posted before this one yet and will
+    // take this one along with them.
+    if (immediate_task->next == nullptr) {
+      WakeUpImmediately();
+    }
+    return;
+  }
+
   std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
-  delayed_tasks_.push({++order_, std::move(task), target_time});
-  WakeUp(delayed_tasks_.top().target_time);
+  QueueForPriority(priority).push({++order_, std::move(task), target_time});
+  if (target_time < armed_wake_time_ &&
+      (priority != TaskPriority::kIdle || target_time < idle_deadline_)) {
+    ArmWakeUp(target_time);
+  }
+}
+
+void MessageLoopImpl::TakeImmediateTasks() {
+  ImmediateTask* task = immediate_tasks_.exchange(nullptr);
+
+  // Restore the order the tasks were posted in.
+  ImmediateTask* reversed = nullptr;
+  while (task != nullptr) {
+    ImmediateTask* next = task->next;
+    task->next = reversed;
+    reversed = task;
+    task = next;
+  }
+
+  while (reversed != nullptr) {
+    ImmediateTask* next = reversed->next;
+    QueueForPriority(reversed->priority)
+        .push({++order_, std::move(reversed->task), reversed->target_time});
+    delete reversed;
+    reversed = next;
+  }
+}
+
+fxl::Closure MessageLoopImpl::TakeNextExpiredTask(fxl::TimePoint now,
+                                                  size_t last_order) {
+  DelayedTaskQueue* queue = nullptr;
+  if (!frame_critical_tasks_.empty() &&
+      frame_critical_tasks_.top().target_time <= now) {
+    queue = &frame_critical_tasks_;
+  } else if (!delayed_tasks_.empty() &&
+             delayed_tasks_.top().target_time <= now &&
+             delayed_tasks_.top().order <= last_order) {
+    queue = &delayed_tasks_;
+  } else if (!idle_tasks_.empty() && idle_tasks_.top().target_time <= now &&
+             idle_tasks_.top().order <= last_order && now < idle_deadline_) {
+    queue = &idle_tasks_;
+  }
+
+  if (queue == nullptr) {
+    return nullptr;
+  }
+
+  fxl::Closure task = std::move(queue->top().task);
+  queue->pop();
+  return task;
+}
+
+fxl::TimePoint MessageLoopImpl::GetNextWakeTime(fxl::TimePoint now) const {
+  fxl::TimePoint next_wake_time = fxl::TimePoint::Max();
+  if (!frame_critical_tasks_.empty()) {
+    next_wake_time =
+        std::min(next_wake_time, frame_critical_tasks_.top().target_time);
+  }
+  if (!delayed_tasks_.empty()) {
+    next_wake_time = std::min(next_wake_time, delayed_tasks_.top().target_time);
+  }
+  // Idle tasks that can not run before the idle deadline must wait for the
+  // deadline to be extended.
+  if (!idle_tasks_.empty() && now < idle_deadline_ &&
+      idle_tasks_.top().target_time < idle_deadline_) {
+    next_wake_time = std::min(next_wake_time, idle_tasks_.top().target_time);
+  }
+  return next_wake_time;
 }
 
 void MessageLoopImpl::RunExpiredTasks() {
   TRACE_EVENT0("fml", "MessageLoop::RunExpiredTasks");
-  std::vector<fxl::Closure> invocations;
+
+  // Tasks posted while running this batch are left to the next one, except
+  // for frame critical tasks.
+  size_t last_order = 0;
 
   {
     std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+    TakeImmediateTasks();
+    last_order = order_;
 
-    if (delayed_tasks_.empty()) {
-      return;
+    // A timer armed for a time in the past has fired (or is about to) and
+    // must be armed again for the next deadline.
+    if (armed_wake_time_ <= fxl::TimePoint::Now()) {
+      armed_wake_time_ = fxl::TimePoint::Max();
     }
+  }
 
-    auto now = fxl::TimePoint::Now();
-    while (!delayed_tasks_.empty()) {
-      const auto& top = delayed_tasks_.top();
-      if (top.target_time > now) {
+  while (true) {
+    fxl::Closure invocation;
+
+    {
+      std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+      TakeImmediateTasks();
+
+      const fxl::TimePoint now = fxl::TimePoint::Now();
+      invocation = TakeNextExpiredTask(now, last_order);
+
+      if (!invocation) {
+        const fxl::TimePoint next_wake_time = GetNextWakeTime(now);
+        if (next_wake_time != armed_wake_time_) {
+          ArmWakeUp(next_wake_time);
+        }
         break;
       }
-      invocations.emplace_back(std::move(top.task));
-      delayed_tasks_.pop();
     }
 
-    WakeUp(delayed_tasks_.empty() ? fxl::TimePoint::Max()
-                                  : delayed_tasks_.top().target_time);
-  }
-
-  for (const auto& invocation : invocations) {
     invocation();
     for (const auto& observer : task_observers_) {
       observer->DidProcessTask();
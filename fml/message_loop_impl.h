@@ -13,6 +13,7 @@
 #include <utility>
 
 #include "flutter/fml/message_loop.h"
+#include "flutter/fml/task_runner.h"
 #include "lib/fxl/functional/closure.h"
 #include "lib/fxl/macros.h"
 #include "lib/fxl/memory/ref_counted.h"
@@ -30,9 +31,20 @@ class MessageLoopImpl : public fxl::RefCountedThreadSafe<MessageLoopImpl> {
 
   virtual void Terminate() = 0;
 
+  // Arms the wakeup timer of the loop so that |RunExpiredTasksNow| is called
+  // at |time_point|. Replaces the previously armed time.
   virtual void WakeUp(fxl::TimePoint time_point) = 0;
 
-  void PostTask(fxl::Closure task, fxl::TimePoint target_time);
+  // Causes |RunExpiredTasksNow| to be called as soon as possible. Called at
+  // most once per batch of tasks posted between two runs of the loop. May be
+  // called on any thread. By default, this arms the wakeup timer.
+  virtual void WakeUpImmediately();
+
+  void PostTask(fxl::Closure task,
+                fxl::TimePoint target_time,
+                TaskPriority priority = TaskPriority::kNormal);
+
+  void SetIdleDeadline(fxl::TimePoint deadline);
 
   void AddTaskObserver(TaskObserver* observer);
 
@@ -61,6 +73,14 @@ class MessageLoopImpl : public fxl::RefCountedThreadSafe<MessageLoopImpl> {
         : order(p_order), task(std::move(p_task)), target_time(p_target_time) {}
   };
 
+  // Node of the lock-free list of tasks posted for immediate execution.
+  struct ImmediateTask {
+    fxl::Closure task;
+    fxl::TimePoint target_time;
+    TaskPriority priority;
+    ImmediateTask* next;
+  };
+
   struct DelayedTaskCompare {
     bool operator()(const DelayedTask& a, const DelayedTask& b) {
       return a.target_time == b.target_time ? a.order > b.order
@@ -73,11 +93,42 @@ class MessageLoopImpl : public fxl::RefCountedThreadSafe<MessageLoopImpl> {
 
   std::set<TaskObserver*> task_observers_;
   std::mutex delayed_tasks_mutex_;
+  // Pending tasks by priority.
+  DelayedTaskQueue frame_critical_tasks_;
   DelayedTaskQueue delayed_tasks_;
+  DelayedTaskQueue idle_tasks_;
+  fxl::TimePoint idle_deadline_;
+  // The time the wakeup timer is armed for. Only rearmed when the earliest
+  // deadline moves.
+  fxl::TimePoint armed_wake_time_;
   size_t order_;
+  // Tasks posted for immediate execution, most recently posted first. Posting
+  // does not take any lock and only wakes the loop if the list was empty.
+  std::atomic<ImmediateTask*> immediate_tasks_;
   std::atomic_bool terminated_;
 
-  void RegisterTask(fxl::Closure task, fxl::TimePoint target_time);
+  void RegisterTask(fxl::Closure task,
+                    fxl::TimePoint target_time,
+                    TaskPriority priority);
+
+  DelayedTaskQueue& QueueForPriority(TaskPriority priority);
+
+  // Moves the tasks posted for immediate execution to the queues of their
+  // priorities. Must be called with |delayed_tasks_mutex_| held.
+  void TakeImmediateTasks();
+
+  // Removes and returns the task to run next, if any. Tasks other than frame
+  // critical ones are only returned if they were posted no later than the
+  // task numbered |last_order|. Must be called with |delayed_tasks_mutex_|
+  // held.
+  fxl::Closure TakeNextExpiredTask(fxl::TimePoint now, size_t last_order);
+
+  // Returns the earliest time at which a task may become runnable. Must be
+  // called with |delayed_tasks_mutex_| held.
+  fxl::TimePoint GetNextWakeTime(fxl::TimePoint now) const;
+
+  // Must be called with |delayed_tasks_mutex_| held.
+  void ArmWakeUp(fxl::TimePoint time_point);
 
   void RunExpiredTasks();
 
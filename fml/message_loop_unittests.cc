@@ -3,9 +3,12 @@
 // found in the LICENSE file.
 
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/message_loop.h"
+#include "flutter/fml/task_runner.h"
 #include "gtest/gtest.h"
+#include "lib/fxl/logging.h"
 #include "lib/fxl/synchronization/waitable_event.h"
 
 #define TIME_SENSITIVE(x) TimeSensitiveTest_##x
@@ -130,6 +133,58 @@ TEST(MessageLoop, DelayedTasksAtSameTimeAreRunInOrder) {
   ASSERT_TRUE(terminated);
 }
 
+TEST(MessageLoop, FrameCriticalTasksRunBeforeNormalTasks) {
+  bool started = false;
+  std::thread thread([&started]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    std::vector<int> order;
+    loop.GetTaskRunner()->PostTask([&order]() { order.push_back(1); },
+                                   fml::TaskPriority::kNormal);
+    loop.GetTaskRunner()->PostTask(
+        [&order]() {
+          order.push_back(2);
+          fml::MessageLoop::GetCurrent().Terminate();
+        },
+        fml::TaskPriority::kNormal);
+    loop.GetTaskRunner()->PostTask([&order]() { order.push_back(0); },
+                                   fml::TaskPriority::kFrameCritical);
+    loop.Run();
+    ASSERT_EQ(order, std::vector<int>({0, 1, 2}));
+    started = true;
+  });
+  thread.join();
+  ASSERT_TRUE(started);
+}
+
+TEST(MessageLoop, IdleTasksWaitForIdleDeadline) {
+  bool started = false;
+  std::thread thread([&started]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    loop.SetIdleDeadline(fxl::TimePoint::Min());
+    bool idle_task_run = false;
+    loop.GetTaskRunner()->PostTask(
+        [&idle_task_run]() {
+          idle_task_run = true;
+          fml::MessageLoop::GetCurrent().Terminate();
+        },
+        fml::TaskPriority::kIdle);
+    loop.GetTaskRunner()->PostTask(
+        [&idle_task_run]() {
+          ASSERT_FALSE(idle_task_run);
+          fml::MessageLoop::GetCurrent().SetIdleDeadline(
+              fxl::TimePoint::Max());
+        },
+        fml::TaskPriority::kNormal);
+    loop.Run();
+    ASSERT_TRUE(idle_task_run);
+    started = true;
+  });
+  thread.join();
+  ASSERT_TRUE(started);
+}
+
 TEST(MessageLoop, CheckRunsTaskOnCurrentThread) {
   fxl::RefPtr<fxl::TaskRunner> runner;
   fxl::AutoResetWaitableEvent latch;
@@ -292,3 +347,79 @@ TEST(MessageLoop, TaskObserverFire) {
   ASSERT_TRUE(started);
   ASSERT_TRUE(terminated);
 }
+
+TEST(MessageLoop, TasksPostedFromManyThreadsRunInPostingOrder) {
+  const size_t producer_count = 4;
+  const size_t count = 10000;
+  fxl::RefPtr<fxl::TaskRunner> runner;
+  fxl::AutoResetWaitableEvent latch;
+  std::vector<size_t> next(producer_count, 0);
+  size_t task_count = 0;
+  std::thread thread([&runner, &latch]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    runner = loop.GetTaskRunner();
+    latch.Signal();
+    loop.Run();
+  });
+  latch.Wait();
+
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < producer_count; p++) {
+    producers.emplace_back([&runner, &next, &task_count, p, count,
+                            producer_count]() {
+      for (size_t i = 0; i < count; i++) {
+        runner->PostTask([&next, &task_count, p, i, count, producer_count]() {
+          // Tasks from one thread run in the order that thread posted them.
+          ASSERT_EQ(next[p], i);
+          next[p]++;
+          task_count++;
+          if (task_count == producer_count * count) {
+            fml::MessageLoop::GetCurrent().Terminate();
+          }
+        });
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  thread.join();
+
+  ASSERT_EQ(task_count, producer_count * count);
+  ASSERT_EQ(next, std::vector<size_t>(producer_count, count));
+}
+
+TEST(MessageLoop, DelayedTaskRunsAfterABurstOfImmediateTasks) {
+  const size_t count = 1000;
+  fxl::RefPtr<fxl::TaskRunner> runner;
+  fxl::AutoResetWaitableEvent latch;
+  size_t task_count = 0;
+  bool delayed_task_run = false;
+  std::thread thread([&runner, &latch]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    runner = loop.GetTaskRunner();
+    latch.Signal();
+    loop.Run();
+  });
+  latch.Wait();
+
+  runner->PostDelayedTask(
+      [&task_count, &delayed_task_run, count]() {
+        ASSERT_EQ(task_count, count);
+        delayed_task_run = true;
+        fml::MessageLoop::GetCurrent().Terminate();
+      },
+      fxl::TimeDelta::FromMilliseconds(20));
+  for (size_t i = 0; i < count; i++) {
+    runner->PostTask([&task_count, &delayed_task_run, i]() {
+      ASSERT_FALSE(delayed_task_run);
+      ASSERT_EQ(task_count, i);
+      task_count++;
+    });
+  }
+  thread.join();
+
+  ASSERT_TRUE(delayed_task_run);
+}
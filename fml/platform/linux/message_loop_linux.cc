@@ -5,6 +5,7 @@
 #include "flutter/fml/platform/linux/message_loop_linux.h"
 
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
 #include "flutter/fml/platform/linux/timerfd.h"
@@ -17,29 +18,34 @@ static constexpr int kClockType = CLOCK_MONOTONIC;
 MessageLoopLinux::MessageLoopLinux()
     : epoll_fd_(HANDLE_EINTR(::epoll_create(1 /* unused */))),
       timer_fd_(::timerfd_create(kClockType, TFD_NONBLOCK | TFD_CLOEXEC)),
+      wake_fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
       running_(false) {
   FXL_CHECK(epoll_fd_.is_valid());
   FXL_CHECK(timer_fd_.is_valid());
-  bool added_source = AddOrRemoveTimerSource(true);
+  FXL_CHECK(wake_fd_.is_valid());
+  bool added_source = AddOrRemoveSource(timer_fd_.get(), true);
+  FXL_CHECK(added_source);
+  added_source = AddOrRemoveSource(wake_fd_.get(), true);
   FXL_CHECK(added_source);
 }
 
 MessageLoopLinux::~MessageLoopLinux() {
-  bool removed_source = AddOrRemoveTimerSource(false);
+  bool removed_source = AddOrRemoveSource(timer_fd_.get(), false);
+  FXL_CHECK(removed_source);
+  removed_source = AddOrRemoveSource(wake_fd_.get(), false);
   FXL_CHECK(removed_source);
 }
 
-bool MessageLoopLinux::AddOrRemoveTimerSource(bool add) {
+bool MessageLoopLinux::AddOrRemoveSource(int fd, bool add) {
   struct epoll_event event = {};
 
   event.events = EPOLLIN;
   // The data is just for informational purposes so we know when we were worken
   // by the FD.
-  event.data.fd = timer_fd_.get();
+  event.data.fd = fd;
 
-  int ctl_result =
-      ::epoll_ctl(epoll_fd_.get(), add ? EPOLL_CTL_ADD : EPOLL_CTL_DEL,
-                  timer_fd_.get(), &event);
+  int ctl_result = ::epoll_ctl(
+      epoll_fd_.get(), add ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, fd, &event);
   return ctl_result == 0;
 }
 
@@ -67,6 +73,8 @@ void MessageLoopLinux::Run() {
 
     if (event.data.fd == timer_fd_.get()) {
       OnEventFired();
+    } else if (event.data.fd == wake_fd_.get()) {
+      OnWakeEventFired();
     }
   }
 }
@@ -81,6 +89,22 @@ void MessageLoopLinux::WakeUp(fxl::TimePoint time_point) {
   FXL_DCHECK(result);
 }
 
+void MessageLoopLinux::WakeUpImmediately() {
+  const uint64_t increment = 1;
+  ssize_t size =
+      HANDLE_EINTR(::write(wake_fd_.get(), &increment, sizeof(increment)));
+  FXL_DCHECK(size == sizeof(increment));
+}
+
+void MessageLoopLinux::OnWakeEventFired() {
+  uint64_t wake_count = 0;
+  ssize_t size =
+      HANDLE_EINTR(::read(wake_fd_.get(), &wake_count, sizeof(wake_count)));
+  if (size == sizeof(wake_count) && wake_count > 0) {
+    RunExpiredTasksNow();
+  }
+}
+
 void MessageLoopLinux::OnEventFired() {
   if (TimerDrain(timer_fd_.get())) {
     RunExpiredTasksNow();
@@ -17,6 +17,9 @@ class MessageLoopLinux : public MessageLoopImpl {
  private:
   fxl::UniqueFD epoll_fd_;
   fxl::UniqueFD timer_fd_;
+  // Signalled to run tasks posted for immediate execution without touching
+  // the timer.
+  fxl::UniqueFD wake_fd_;
   bool running_;
 
   MessageLoopLinux();
@@ -29,9 +32,13 @@ class MessageLoopLinux : public MessageLoopImpl {
 
   void WakeUp(fxl::TimePoint time_point) override;
 
+  void WakeUpImmediately() override;
+
   void OnEventFired();
 
-  bool AddOrRemoveTimerSource(bool add);
+  void OnWakeEventFired();
+
+  bool AddOrRemoveSource(int fd, bool add);
 
   FRIEND_MAKE_REF_COUNTED(MessageLoopLinux);
   FRIEND_REF_COUNTED_THREAD_SAFE(MessageLoopLinux);
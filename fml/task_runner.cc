@@ -22,11 +22,21 @@ void TaskRunner::PostTask(fxl::Closure task) {
   loop_->PostTask(std::move(task), fxl::TimePoint::Now());
 }
 
+void TaskRunner::PostTask(fxl::Closure task, TaskPriority priority) {
+  loop_->PostTask(std::move(task), fxl::TimePoint::Now(), priority);
+}
+
 void TaskRunner::PostTaskForTime(fxl::Closure task,
                                  fxl::TimePoint target_time) {
   loop_->PostTask(std::move(task), target_time);
 }
 
+void TaskRunner::PostTaskForTime(fxl::Closure task,
+                                 fxl::TimePoint target_time,
+                                 TaskPriority priority) {
+  loop_->PostTask(std::move(task), target_time, priority);
+}
+
 void TaskRunner::PostDelayedTask(fxl::Closure task, fxl::TimeDelta delay) {
   loop_->PostTask(std::move(task), fxl::TimePoint::Now() + delay);
 }
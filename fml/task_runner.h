@@ -13,10 +13,29 @@ namespace fml {
 
 class MessageLoopImpl;
 
+// Determines the order in which expired tasks are run.
+enum class TaskPriority {
+  // Work that a frame is waiting on (vsync callbacks, rasterization). Run
+  // before all other expired tasks, including tasks posted after the loop
+  // started running the current batch.
+  kFrameCritical,
+  // The priority of tasks posted without one.
+  kNormal,
+  // Work that may be deferred. Only run while the idle deadline of the loop
+  // (see |MessageLoop::SetIdleDeadline|) is in the future.
+  kIdle,
+};
+
 class TaskRunner : public fxl::TaskRunner {
  public:
   void PostTask(fxl::Closure task) override;
 
+  void PostTask(fxl::Closure task, TaskPriority priority);
+
+  void PostTaskForTime(fxl::Closure task,
+                       fxl::TimePoint target_time,
+                       TaskPriority priority);
+
   void PostTaskForTime(fxl::Closure task, fxl::TimePoint target_time) override;
 
   void PostDelayedTask(fxl::Closure task, fxl::TimeDelta delay) override;
@@ -893,9 +893,14 @@ class Paint {
   static const int _kMaskFilterOffset = _kMaskFilterIndex << 2;
   static const int _kMaskFilterBlurStyleOffset = _kMaskFilterBlurStyleIndex << 2;
   static const int _kMaskFilterSigmaOffset = _kMaskFilterSigmaIndex << 2;
-  // If you add more fields, remember to update _kDataByteCount.
+  // If you add more fields, remember to update _kDataByteCount and
+  // _kDataWordCount.
   static const int _kDataByteCount = 75;
 
+  // The number of fields, which is the number of words _CanvasCommands copies
+  // into its buffer. Must match kPaintDataWordCount in paint.h.
+  static const int _kDataWordCount = 15;
+
   // Binary format must match the deserialization code in paint.cc.
   List<dynamic> _objects;
   static const int _kShaderIndex = 0;
@@ -1288,18 +1293,32 @@ class Codec extends NativeFieldWrapperClass2 {
 ///
 /// The following image formats are supported: {@macro flutter.dart:ui.imageFormats}
 ///
+/// [targetWidth] and [targetHeight] specify the size the image is decoded at,
+/// in pixels. If only one of them is specified, the other one follows the
+/// aspect ratio of the image. Images are never decoded larger than their
+/// intrinsic size. Decoding at a smaller size saves the memory of the full
+/// size image, which matters for thumbnails of large photos. Animated images
+/// are always decoded at their intrinsic size.
+///
 /// The returned future can complete with an error if the image decoding has
 /// failed.
-Future<Codec> instantiateImageCodec(Uint8List list) {
+Future<Codec> instantiateImageCodec(Uint8List list, {
+  int targetWidth,
+  int targetHeight,
+}) {
   return _futurize(
-    (_Callback<Codec> callback) => _instantiateImageCodec(list, callback)
+    (_Callback<Codec> callback) => _instantiateImageCodec(
+      list, callback, targetWidth ?? 0, targetHeight ?? 0)
   );
 }
 
 /// Instantiates a [Codec] object for an image binary data.
 ///
+/// Target dimensions that are not positive are not constrained.
+///
 /// Returns an error message if the instantiation has failed, null otherwise.
-String _instantiateImageCodec(Uint8List list, _Callback<Codec> callback)
+String _instantiateImageCodec(Uint8List list, _Callback<Codec> callback,
+                              int targetWidth, int targetHeight)
   native 'instantiateImageCodec';
 
 /// Loads a single image frame from a byte array into an [Image] object.
@@ -2088,6 +2107,147 @@ enum ClipOp {
   intersect,
 }
 
+// Records simple canvas operations into a buffer so that they reach the
+// engine in one native call instead of one call each, which also lets the
+// engine decode each distinct paint once rather than once per draw.
+//
+// The buffer is shared by all canvases. A canvas that records into it while
+// it holds the commands of another canvas first flushes those to the other
+// canvas, which keeps the commands of each canvas in order.
+//
+// The binary format must match the replay code in canvas_commands.cc.
+class _CanvasCommands {
+  _CanvasCommands() {
+    _words = new Uint32List.view(_data.buffer);
+    _floats = new Float32List.view(_data.buffer);
+  }
+
+  // Opcodes. Must be kept in sync with CanvasCommand in canvas_commands.h.
+  static const int _kSave = 0;
+  static const int _kRestore = 1;
+  static const int _kTranslate = 2;
+  static const int _kScale = 3;
+  static const int _kRotate = 4;
+  static const int _kSkew = 5;
+  static const int _kClipRect = 6;
+  static const int _kClipRRect = 7;
+  static const int _kDrawColor = 8;
+  static const int _kSetPaint = 9;
+  static const int _kDrawLine = 10;
+  static const int _kDrawPaint = 11;
+  static const int _kDrawRect = 12;
+  static const int _kDrawRRect = 13;
+  static const int _kDrawDRRect = 14;
+  static const int _kDrawOval = 15;
+  static const int _kDrawCircle = 16;
+  static const int _kDrawArc = 17;
+
+  // Must match kCanvasCommandNoShader in canvas_commands.h.
+  static const int _kNoShader = 0xFFFFFFFF;
+
+  // The opcode, the paint data and the shader index.
+  static const int _kSetPaintWordCount = Paint._kDataWordCount + 2;
+  static const int _kRRectWordCount = 12;
+
+  // The size of the buffer in words. A full buffer is flushed.
+  static const int _kCapacity = 4096;
+
+  final ByteData _data = new ByteData(_kCapacity << 2);
+  Uint32List _words;
+  Float32List _floats;
+  int _length = 0;
+
+  // The canvas that recorded the commands in the buffer.
+  Canvas _canvas;
+
+  // The shaders of the recorded paints, or null if there are none.
+  List<dynamic> _objects;
+
+  // The last paint recorded into the buffer. Draws that use an identical
+  // paint do not record it again.
+  bool _hasPaint = false;
+  final Uint32List _paintWords = new Uint32List(Paint._kDataWordCount);
+  Shader _paintShader;
+
+  // Replays the buffered commands into the canvas that recorded them.
+  void flush() {
+    final Canvas canvas = _canvas;
+    final List<dynamic> objects = _objects;
+    final int length = _length;
+    _canvas = null;
+    _objects = null;
+    _length = 0;
+    _hasPaint = false;
+    _paintShader = null;
+    if (length > 0) {
+      final String error = canvas._drawCommands(objects, _data, length);
+      if (error != null)
+        throw new StateError(error);
+    }
+  }
+
+  // Makes room for `wordCount` words of commands recorded by `canvas`.
+  void _reserve(Canvas canvas, int wordCount) {
+    if (!identical(_canvas, canvas) || _length + wordCount > _kCapacity) {
+      flush();
+      _canvas = canvas;
+    }
+  }
+
+  // Makes room for a draw command of `wordCount` words and records `paint`
+  // if it differs from the last paint in the buffer.
+  void _reserveDraw(Canvas canvas, Paint paint, int wordCount) {
+    _reserve(canvas, _kSetPaintWordCount + wordCount);
+    final ByteData paintData = paint._data;
+    final Shader shader = paint.shader;
+    bool changed = !_hasPaint || !identical(shader, _paintShader);
+    for (int i = 0; i < Paint._kDataWordCount; i += 1) {
+      final int word = paintData.getUint32(i << 2, _kFakeHostEndian);
+      if (word != _paintWords[i]) {
+        _paintWords[i] = word;
+        changed = true;
+      }
+    }
+    if (!changed)
+      return;
+    _hasPaint = true;
+    _paintShader = shader;
+    _words[_length++] = _kSetPaint;
+    _words.setRange(_length, _length + Paint._kDataWordCount, _paintWords);
+    _length += Paint._kDataWordCount;
+    if (shader == null) {
+      _words[_length++] = _kNoShader;
+    } else {
+      _objects ??= <dynamic>[];
+      _words[_length++] = _objects.length;
+      _objects.add(shader);
+    }
+  }
+
+  void _addWord(int value) {
+    _words[_length++] = value;
+  }
+
+  void _addFloat(double value) {
+    _floats[_length++] = value;
+  }
+
+  void _addRect(double left, double top, double right, double bottom) {
+    _floats[_length] = left;
+    _floats[_length + 1] = top;
+    _floats[_length + 2] = right;
+    _floats[_length + 3] = bottom;
+    _length += 4;
+  }
+
+  void _addRRect(Float32List value) {
+    _floats.setRange(_length, _length + _kRRectWordCount, value);
+    _length += _kRRectWordCount;
+  }
+}
+
+final _CanvasCommands _canvasCommands = new _CanvasCommands();
+
 /// An interface for recording graphical operations.
 ///
 /// [Canvas] objects are used in creating [Picture] objects, which can
@@ -2123,6 +2283,7 @@ class Canvas extends NativeFieldWrapperClass2 {
       throw new ArgumentError('"recorder" must not already be associated with another Canvas.');
     cullRect ??= Rect.largest;
     _constructor(recorder, cullRect.left, cullRect.top, cullRect.right, cullRect.bottom);
+    recorder._canvas = this;
   }
   void _constructor(PictureRecorder recorder,
                     double left,
@@ -2130,6 +2291,17 @@ class Canvas extends NativeFieldWrapperClass2 {
                     double right,
                     double bottom) native 'Canvas_constructor';
 
+  // The simple operations of a canvas are recorded into _canvasCommands
+  // rather than sent to the engine one by one. The other operations must call
+  // this first so that they are recorded after the buffered commands.
+  void _flushCommands() {
+    if (identical(_canvasCommands._canvas, this))
+      _canvasCommands.flush();
+  }
+  String _drawCommands(List<dynamic> objects,
+                       ByteData commands,
+                       int wordCount) native 'Canvas_drawCommands';
+
   /// Saves a copy of the current transform and clip on the save stack.
   ///
   /// Call [restore] to pop the save stack.
@@ -2138,7 +2310,11 @@ class Canvas extends NativeFieldWrapperClass2 {
   ///
   ///  * [saveLayer], which does the same thing but additionally also groups the
   ///    commands done until the matching [restore].
-  void save() native 'Canvas_save';
+  void save() {
+    _canvasCommands
+      .._reserve(this, 1)
+      .._addWord(_CanvasCommands._kSave);
+  }
 
   /// Saves a copy of the current transform and clip on the save stack, and then
   /// creates a new group which subsequent calls will become a part of. When the
@@ -2252,6 +2428,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   void saveLayer(Rect bounds, Paint paint) {
     assert(_rectIsValid(bounds));
     assert(paint != null);
+    _flushCommands();
     if (bounds == null) {
       _saveLayerWithoutBounds(paint._objects, paint._data);
     } else {
@@ -2275,7 +2452,11 @@ class Canvas extends NativeFieldWrapperClass2 {
   ///
   /// If the state was pushed with with [saveLayer], then this call will also
   /// cause the new layer to be composited into the previous layer.
-  void restore() native 'Canvas_restore';
+  void restore() {
+    _canvasCommands
+      .._reserve(this, 1)
+      .._addWord(_CanvasCommands._kRestore);
+  }
 
   /// Returns the number of items on the save stack, including the
   /// initial state. This means it returns 1 for a clean canvas, and
@@ -2283,25 +2464,52 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// each matching call to [restore] decrements it.
   ///
   /// This number cannot go below 1.
-  int getSaveCount() native 'Canvas_getSaveCount';
+  int getSaveCount() {
+    _flushCommands();
+    return _getSaveCount();
+  }
+  int _getSaveCount() native 'Canvas_getSaveCount';
 
   /// Add a translation to the current transform, shifting the coordinate space
   /// horizontally by the first argument and vertically by the second argument.
-  void translate(double dx, double dy) native 'Canvas_translate';
+  void translate(double dx, double dy) {
+    _canvasCommands
+      .._reserve(this, 3)
+      .._addWord(_CanvasCommands._kTranslate)
+      .._addFloat(dx)
+      .._addFloat(dy);
+  }
 
   /// Add an axis-aligned scale to the current transform, scaling by the first
   /// argument in the horizontal direction and the second in the vertical
   /// direction.
-  void scale(double sx, double sy) native 'Canvas_scale';
+  void scale(double sx, double sy) {
+    _canvasCommands
+      .._reserve(this, 3)
+      .._addWord(_CanvasCommands._kScale)
+      .._addFloat(sx)
+      .._addFloat(sy);
+  }
 
   /// Add a rotation to the current transform. The argument is in radians clockwise.
-  void rotate(double radians) native 'Canvas_rotate';
+  void rotate(double radians) {
+    _canvasCommands
+      .._reserve(this, 2)
+      .._addWord(_CanvasCommands._kRotate)
+      .._addFloat(radians);
+  }
 
   /// Add an axis-aligned skew to the current transform, with the first argument
   /// being the horizontal skew in radians clockwise around the origin, and the
   /// second argument being the vertical skew in radians clockwise around the
   /// origin.
-  void skew(double sx, double sy) native 'Canvas_skew';
+  void skew(double sx, double sy) {
+    _canvasCommands
+      .._reserve(this, 3)
+      .._addWord(_CanvasCommands._kSkew)
+      .._addFloat(sx)
+      .._addFloat(sy);
+  }
 
   /// Multiply the current transform by the specified 4⨉4 transformation matrix
   /// specified as a list of values in column-major order.
@@ -2309,6 +2517,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(matrix4 != null);
     if (matrix4.length != 16)
       throw new ArgumentError('"matrix4" must have 16 entries.');
+    _flushCommands();
     _transform(matrix4);
   }
   void _transform(Float64List matrix4) native 'Canvas_transform';
@@ -2327,13 +2536,12 @@ class Canvas extends NativeFieldWrapperClass2 {
   void clipRect(Rect rect, { ClipOp clipOp: ClipOp.intersect }) {
     assert(_rectIsValid(rect));
     assert(clipOp != null);
-    _clipRect(rect.left, rect.top, rect.right, rect.bottom, clipOp.index);
+    _canvasCommands
+      .._reserve(this, 6)
+      .._addWord(_CanvasCommands._kClipRect)
+      .._addRect(rect.left, rect.top, rect.right, rect.bottom)
+      .._addWord(clipOp.index);
   }
-  void _clipRect(double left,
-                 double top,
-                 double right,
-                 double bottom,
-                 int clipOp) native 'Canvas_clipRect';
 
   /// Reduces the clip region to the intersection of the current clip and the
   /// given rounded rectangle.
@@ -2344,9 +2552,11 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// discussion of how to address that and some examples of using [clipRRect].
   void clipRRect(RRect rrect) {
     assert(_rrectIsValid(rrect));
-    _clipRRect(rrect._value);
+    _canvasCommands
+      .._reserve(this, 1 + _CanvasCommands._kRRectWordCount)
+      .._addWord(_CanvasCommands._kClipRRect)
+      .._addRRect(rrect._value);
   }
-  void _clipRRect(Float32List rrect) native 'Canvas_clipRRect';
 
   /// Reduces the clip region to the intersection of the current clip and the
   /// given [Path].
@@ -2357,6 +2567,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// discussion of how to address that.
   void clipPath(Path path) {
     assert(path != null); // path is checked on the engine side
+    _flushCommands();
     _clipPath(path);
   }
   void _clipPath(Path path) native 'Canvas_clipPath';
@@ -2367,9 +2578,12 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawColor(Color color, BlendMode blendMode) {
     assert(color != null);
     assert(blendMode != null);
-    _drawColor(color.value, blendMode.index);
+    _canvasCommands
+      .._reserve(this, 3)
+      .._addWord(_CanvasCommands._kDrawColor)
+      .._addWord(color.value)
+      .._addWord(blendMode.index);
   }
-  void _drawColor(int color, int blendMode) native 'Canvas_drawColor';
 
   /// Draws a line between the given points using the given paint. The line is
   /// stroked, the value of the [Paint.style] is ignored for this call.
@@ -2379,14 +2593,14 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_offsetIsValid(p1));
     assert(_offsetIsValid(p2));
     assert(paint != null);
-    _drawLine(p1.dx, p1.dy, p2.dx, p2.dy, paint._objects, paint._data);
+    _canvasCommands
+      .._reserveDraw(this, paint, 5)
+      .._addWord(_CanvasCommands._kDrawLine)
+      .._addFloat(p1.dx)
+      .._addFloat(p1.dy)
+      .._addFloat(p2.dx)
+      .._addFloat(p2.dy);
   }
-  void _drawLine(double x1,
-                 double y1,
-                 double x2,
-                 double y2,
-                 List<dynamic> paintObjects,
-                 ByteData paintData) native 'Canvas_drawLine';
 
   /// Fills the canvas with the given [Paint].
   ///
@@ -2394,35 +2608,32 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// [drawColor] instead.
   void drawPaint(Paint paint) {
     assert(paint != null);
-    _drawPaint(paint._objects, paint._data);
+    _canvasCommands
+      .._reserveDraw(this, paint, 1)
+      .._addWord(_CanvasCommands._kDrawPaint);
   }
-  void _drawPaint(List<dynamic> paintObjects, ByteData paintData) native 'Canvas_drawPaint';
 
   /// Draws a rectangle with the given [Paint]. Whether the rectangle is filled
   /// or stroked (or both) is controlled by [Paint.style].
   void drawRect(Rect rect, Paint paint) {
     assert(_rectIsValid(rect));
     assert(paint != null);
-    _drawRect(rect.left, rect.top, rect.right, rect.bottom,
-              paint._objects, paint._data);
+    _canvasCommands
+      .._reserveDraw(this, paint, 5)
+      .._addWord(_CanvasCommands._kDrawRect)
+      .._addRect(rect.left, rect.top, rect.right, rect.bottom);
   }
-  void _drawRect(double left,
-                 double top,
-                 double right,
-                 double bottom,
-                 List<dynamic> paintObjects,
-                 ByteData paintData) native 'Canvas_drawRect';
 
   /// Draws a rounded rectangle with the given [Paint]. Whether the rectangle is
   /// filled or stroked (or both) is controlled by [Paint.style].
   void drawRRect(RRect rrect, Paint paint) {
     assert(_rrectIsValid(rrect));
     assert(paint != null);
-    _drawRRect(rrect._value, paint._objects, paint._data);
+    _canvasCommands
+      .._reserveDraw(this, paint, 1 + _CanvasCommands._kRRectWordCount)
+      .._addWord(_CanvasCommands._kDrawRRect)
+      .._addRRect(rrect._value);
   }
-  void _drawRRect(Float32List rrect,
-                  List<dynamic> paintObjects,
-                  ByteData paintData) native 'Canvas_drawRRect';
 
   /// Draws a shape consisting of the difference between two rounded rectangles
   /// with the given [Paint]. Whether this shape is filled or stroked (or both)
@@ -2433,12 +2644,12 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_rrectIsValid(outer));
     assert(_rrectIsValid(inner));
     assert(paint != null);
-    _drawDRRect(outer._value, inner._value, paint._objects, paint._data);
+    _canvasCommands
+      .._reserveDraw(this, paint, 1 + 2 * _CanvasCommands._kRRectWordCount)
+      .._addWord(_CanvasCommands._kDrawDRRect)
+      .._addRRect(outer._value)
+      .._addRRect(inner._value);
   }
-  void _drawDRRect(Float32List outer,
-                   Float32List inner,
-                   List<dynamic> paintObjects,
-                   ByteData paintData) native 'Canvas_drawDRRect';
 
   /// Draws an axis-aligned oval that fills the given axis-aligned rectangle
   /// with the given [Paint]. Whether the oval is filled or stroked (or both) is
@@ -2446,15 +2657,11 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawOval(Rect rect, Paint paint) {
     assert(_rectIsValid(rect));
     assert(paint != null);
-    _drawOval(rect.left, rect.top, rect.right, rect.bottom,
-              paint._objects, paint._data);
+    _canvasCommands
+      .._reserveDraw(this, paint, 5)
+      .._addWord(_CanvasCommands._kDrawOval)
+      .._addRect(rect.left, rect.top, rect.right, rect.bottom);
   }
-  void _drawOval(double left,
-                 double top,
-                 double right,
-                 double bottom,
-                 List<dynamic> paintObjects,
-                 ByteData paintData) native 'Canvas_drawOval';
 
   /// Draws a circle centered at the point given by the first argument and
   /// that has the radius given by the second argument, with the [Paint] given in
@@ -2463,13 +2670,13 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawCircle(Offset c, double radius, Paint paint) {
     assert(_offsetIsValid(c));
     assert(paint != null);
-    _drawCircle(c.dx, c.dy, radius, paint._objects, paint._data);
+    _canvasCommands
+      .._reserveDraw(this, paint, 4)
+      .._addWord(_CanvasCommands._kDrawCircle)
+      .._addFloat(c.dx)
+      .._addFloat(c.dy)
+      .._addFloat(radius);
   }
-  void _drawCircle(double x,
-                   double y,
-                   double radius,
-                   List<dynamic> paintObjects,
-                   ByteData paintData) native 'Canvas_drawCircle';
 
   /// Draw an arc scaled to fit inside the given rectangle. It starts from
   /// startAngle radians around the oval up to startAngle + sweepAngle
@@ -2484,18 +2691,14 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawArc(Rect rect, double startAngle, double sweepAngle, bool useCenter, Paint paint) {
     assert(_rectIsValid(rect));
     assert(paint != null);
-    _drawArc(rect.left, rect.top, rect.right, rect.bottom, startAngle,
-             sweepAngle, useCenter, paint._objects, paint._data);
-  }
-  void _drawArc(double left,
-                double top,
-                double right,
-                double bottom,
-                double startAngle,
-                double sweepAngle,
-                bool useCenter,
-                List<dynamic> paintObjects,
-                ByteData paintData) native 'Canvas_drawArc';
+    _canvasCommands
+      .._reserveDraw(this, paint, 8)
+      .._addWord(_CanvasCommands._kDrawArc)
+      .._addRect(rect.left, rect.top, rect.right, rect.bottom)
+      .._addFloat(startAngle)
+      .._addFloat(sweepAngle)
+      .._addWord(useCenter ? 1 : 0);
+  }
 
   /// Draws the given [Path] with the given [Paint]. Whether this shape is
   /// filled or stroked (or both) is controlled by [Paint.style]. If the path is
@@ -2503,6 +2706,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawPath(Path path, Paint paint) {
     assert(path != null); // path is checked on the engine side
     assert(paint != null);
+    _flushCommands();
     _drawPath(path, paint._objects, paint._data);
   }
   void _drawPath(Path path,
@@ -2515,6 +2719,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(image != null); // image is checked on the engine side
     assert(_offsetIsValid(p));
     assert(paint != null);
+    _flushCommands();
     _drawImage(image, p.dx, p.dy, paint._objects, paint._data);
   }
   void _drawImage(Image image,
@@ -2537,6 +2742,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_rectIsValid(src));
     assert(_rectIsValid(dst));
     assert(paint != null);
+    _flushCommands();
     _drawImageRect(image,
                    src.left,
                    src.top,
@@ -2579,6 +2785,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_rectIsValid(center));
     assert(_rectIsValid(dst));
     assert(paint != null);
+    _flushCommands();
     _drawImageNine(image,
                    center.left,
                    center.top,
@@ -2607,6 +2814,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// [PictureRecorder].
   void drawPicture(Picture picture) {
     assert(picture != null); // picture is checked on the engine side
+    _flushCommands();
     _drawPicture(picture);
   }
   void _drawPicture(Picture picture) native 'Canvas_drawPicture';
@@ -2634,6 +2842,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawParagraph(Paragraph paragraph, Offset offset) {
     assert(paragraph != null);
     assert(_offsetIsValid(offset));
+    _flushCommands();
     paragraph._paint(this, offset.dx, offset.dy);
   }
 
@@ -2649,6 +2858,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(pointMode != null);
     assert(points != null);
     assert(paint != null);
+    _flushCommands();
     _drawPoints(paint._objects, paint._data, pointMode.index, _encodePointList(points));
   }
 
@@ -2667,6 +2877,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(paint != null);
     if (points.length % 2 != 0)
       throw new ArgumentError('"points" must have an even number of values.');
+    _flushCommands();
     _drawPoints(paint._objects, paint._data, pointMode.index, points);
   }
 
@@ -2679,6 +2890,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(vertices != null); // vertices is checked on the engine side
     assert(paint != null);
     assert(blendMode != null);
+    _flushCommands();
     _drawVertices(vertices, blendMode.index, paint._objects, paint._data);
   }
   void _drawVertices(Vertices vertices,
@@ -2735,6 +2947,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     final Int32List colorBuffer = colors.isEmpty ? null : _encodeColorList(colors);
     final Float32List cullRectBuffer = cullRect?._value;
 
+    _flushCommands();
     _drawAtlas(
       paint._objects, paint._data, atlas, rstTransformBuffer, rectBuffer,
       colorBuffer, blendMode.index, cullRectBuffer
@@ -2778,6 +2991,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     if (colors != null && colors.length * 4 != rectCount)
       throw new ArgumentError('If non-null, "colors" length must be one fourth the length of "rstTransforms" and "rects".');
 
+    _flushCommands();
     _drawAtlas(
       paint._objects, paint._data, atlas, rstTransforms, rects,
       colors, blendMode.index, cullRect?._value
@@ -2803,6 +3017,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(path != null); // path is checked on the engine side
     assert(color != null);
     assert(transparentOccluder != null);
+    _flushCommands();
     _drawShadow(path, color.value, elevation, transparentOccluder);
   }
   void _drawShadow(Path path,
@@ -2866,7 +3081,16 @@ class PictureRecorder extends NativeFieldWrapperClass2 {
   /// and the canvas objects are invalid and cannot be used further.
   ///
   /// Returns null if the PictureRecorder is not associated with a canvas.
-  Picture endRecording() native 'PictureRecorder_endRecording';
+  Picture endRecording() {
+    _canvas?._flushCommands();
+    _canvas = null;
+    return _endRecording();
+  }
+  Picture _endRecording() native 'PictureRecorder_endRecording';
+
+  // The canvas recording into this recorder, whose buffered commands must be
+  // flushed before the recording ends.
+  Canvas _canvas;
 }
 
 /// Generic callback signature, used by [_futurize].
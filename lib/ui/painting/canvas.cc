@@ -4,17 +4,20 @@
 
 #include "flutter/lib/ui/painting/canvas.h"
 
-#include <math.h>
+#include <vector>
 
 #include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/lib/ui/painting/canvas_commands.h"
 #include "flutter/lib/ui/painting/image.h"
 #include "flutter/lib/ui/painting/matrix.h"
+#include "flutter/lib/ui/painting/shader.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "flutter/lib/ui/window/window.h"
 #include "lib/tonic/converter/dart_converter.h"
 #include "lib/tonic/dart_args.h"
 #include "lib/tonic/dart_binding_macros.h"
 #include "lib/tonic/dart_library_natives.h"
+#include "lib/tonic/typed_data/dart_byte_data.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkRSXform.h"
@@ -30,28 +33,11 @@ static void Canvas_constructor(Dart_NativeArguments args) {
 IMPLEMENT_WRAPPERTYPEINFO(ui, Canvas);
 
 #define FOR_EACH_BINDING(V)         \
-  V(Canvas, save)                   \
   V(Canvas, saveLayerWithoutBounds) \
   V(Canvas, saveLayer)              \
-  V(Canvas, restore)                \
   V(Canvas, getSaveCount)           \
-  V(Canvas, translate)              \
-  V(Canvas, scale)                  \
-  V(Canvas, rotate)                 \
-  V(Canvas, skew)                   \
   V(Canvas, transform)              \
-  V(Canvas, clipRect)               \
-  V(Canvas, clipRRect)              \
   V(Canvas, clipPath)               \
-  V(Canvas, drawColor)              \
-  V(Canvas, drawLine)               \
-  V(Canvas, drawPaint)              \
-  V(Canvas, drawRect)               \
-  V(Canvas, drawRRect)              \
-  V(Canvas, drawDRRect)             \
-  V(Canvas, drawOval)               \
-  V(Canvas, drawCircle)             \
-  V(Canvas, drawArc)                \
   V(Canvas, drawPath)               \
   V(Canvas, drawImage)              \
   V(Canvas, drawImageRect)          \
@@ -60,7 +46,8 @@ IMPLEMENT_WRAPPERTYPEINFO(ui, Canvas);
   V(Canvas, drawPoints)             \
   V(Canvas, drawVertices)           \
   V(Canvas, drawAtlas)              \
-  V(Canvas, drawShadow)
+  V(Canvas, drawShadow)             \
+  V(Canvas, drawCommands)
 
 FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
 
@@ -88,12 +75,6 @@ Canvas::Canvas(SkCanvas* canvas) : canvas_(canvas) {}
 
 Canvas::~Canvas() {}
 
-void Canvas::save() {
-  if (!canvas_)
-    return;
-  canvas_->save();
-}
-
 void Canvas::saveLayerWithoutBounds(const Paint& paint,
                                     const PaintData& paint_data) {
   if (!canvas_)
@@ -113,64 +94,18 @@ void Canvas::saveLayer(double left,
   canvas_->saveLayer(&bounds, paint.paint());
 }
 
-void Canvas::restore() {
-  if (!canvas_)
-    return;
-  canvas_->restore();
-}
-
 int Canvas::getSaveCount() {
   if (!canvas_)
     return 0;
   return canvas_->getSaveCount();
 }
 
-void Canvas::translate(double dx, double dy) {
-  if (!canvas_)
-    return;
-  canvas_->translate(dx, dy);
-}
-
-void Canvas::scale(double sx, double sy) {
-  if (!canvas_)
-    return;
-  canvas_->scale(sx, sy);
-}
-
-void Canvas::rotate(double radians) {
-  if (!canvas_)
-    return;
-  canvas_->rotate(radians * 180.0 / M_PI);
-}
-
-void Canvas::skew(double sx, double sy) {
-  if (!canvas_)
-    return;
-  canvas_->skew(sx, sy);
-}
-
 void Canvas::transform(const tonic::Float64List& matrix4) {
   if (!canvas_)
     return;
   canvas_->concat(ToSkMatrix(matrix4));
 }
 
-void Canvas::clipRect(double left,
-                      double top,
-                      double right,
-                      double bottom,
-                      SkClipOp clipOp) {
-  if (!canvas_)
-    return;
-  canvas_->clipRect(SkRect::MakeLTRB(left, top, right, bottom), clipOp, true);
-}
-
-void Canvas::clipRRect(const RRect& rrect) {
-  if (!canvas_)
-    return;
-  canvas_->clipRRect(rrect.sk_rrect, true);
-}
-
 void Canvas::clipPath(const CanvasPath* path) {
   if (!canvas_)
     return;
@@ -180,94 +115,6 @@ void Canvas::clipPath(const CanvasPath* path) {
   canvas_->clipPath(path->path(), true);
 }
 
-void Canvas::drawColor(SkColor color, SkBlendMode blend_mode) {
-  if (!canvas_)
-    return;
-  canvas_->drawColor(color, blend_mode);
-}
-
-void Canvas::drawLine(double x1,
-                      double y1,
-                      double x2,
-                      double y2,
-                      const Paint& paint,
-                      const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawLine(x1, y1, x2, y2, *paint.paint());
-}
-
-void Canvas::drawPaint(const Paint& paint, const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawPaint(*paint.paint());
-}
-
-void Canvas::drawRect(double left,
-                      double top,
-                      double right,
-                      double bottom,
-                      const Paint& paint,
-                      const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawRect(SkRect::MakeLTRB(left, top, right, bottom), *paint.paint());
-}
-
-void Canvas::drawRRect(const RRect& rrect,
-                       const Paint& paint,
-                       const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawRRect(rrect.sk_rrect, *paint.paint());
-}
-
-void Canvas::drawDRRect(const RRect& outer,
-                        const RRect& inner,
-                        const Paint& paint,
-                        const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawDRRect(outer.sk_rrect, inner.sk_rrect, *paint.paint());
-}
-
-void Canvas::drawOval(double left,
-                      double top,
-                      double right,
-                      double bottom,
-                      const Paint& paint,
-                      const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawOval(SkRect::MakeLTRB(left, top, right, bottom), *paint.paint());
-}
-
-void Canvas::drawCircle(double x,
-                        double y,
-                        double radius,
-                        const Paint& paint,
-                        const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawCircle(x, y, radius, *paint.paint());
-}
-
-void Canvas::drawArc(double left,
-                     double top,
-                     double right,
-                     double bottom,
-                     double startAngle,
-                     double sweepAngle,
-                     bool useCenter,
-                     const Paint& paint,
-                     const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawArc(SkRect::MakeLTRB(left, top, right, bottom),
-                   startAngle * 180.0 / M_PI, sweepAngle * 180.0 / M_PI,
-                   useCenter, *paint.paint());
-}
-
 void Canvas::drawPath(const CanvasPath* path,
                       const Paint& paint,
                       const PaintData& paint_data) {
@@ -420,6 +267,45 @@ void Canvas::drawShadow(const CanvasPath* path,
                                        transparentOccluder, dpr);
 }
 
+Dart_Handle Canvas::drawCommands(Dart_Handle objects,
+                                 Dart_Handle commands,
+                                 int word_count) {
+  if (!canvas_)
+    return Dart_Null();
+
+  // The shaders are unwrapped before the commands are acquired because we
+  // cannot re-enter the VM while a view unto the typed data is held. Errors
+  // are returned rather than thrown, because throwing would unwind past the
+  // destructor of |shaders|.
+  std::vector<sk_sp<SkShader>> shaders;
+  if (!Dart_IsNull(objects)) {
+    intptr_t length = 0;
+    Dart_ListLength(objects, &length);
+    shaders.reserve(length);
+    for (intptr_t i = 0; i < length; ++i) {
+      Shader* shader =
+          tonic::DartConverter<Shader*>::FromDart(Dart_ListGetAt(objects, i));
+      if (!shader)
+        return ToDart("Canvas command buffer refers to a non-genuine Shader.");
+      shaders.push_back(shader->shader());
+    }
+  }
+
+  bool replayed = false;
+  {
+    tonic::DartByteData data(commands);
+    const size_t capacity = data.length_in_bytes() / sizeof(uint32_t);
+    if (word_count >= 0 && static_cast<size_t>(word_count) <= capacity) {
+      replayed = ReplayCanvasCommands(
+          static_cast<const uint32_t*>(data.data()), word_count, shaders,
+          canvas_);
+    }
+  }
+  if (!replayed)
+    return ToDart("Canvas command buffer is malformed.");
+  return Dart_Null();
+}
+
 void Canvas::Clear() {
   canvas_ = nullptr;
 }
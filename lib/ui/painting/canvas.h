@@ -9,7 +9,6 @@
 #include "flutter/lib/ui/painting/path.h"
 #include "flutter/lib/ui/painting/picture.h"
 #include "flutter/lib/ui/painting/picture_recorder.h"
-#include "flutter/lib/ui/painting/rrect.h"
 #include "flutter/lib/ui/painting/vertices.h"
 #include "lib/tonic/dart_wrappable.h"
 #include "lib/tonic/typed_data/float32_list.h"
@@ -39,7 +38,6 @@ class Canvas : public fxl::RefCountedThreadSafe<Canvas>,
 
   ~Canvas() override;
 
-  void save();
   void saveLayerWithoutBounds(const Paint& paint, const PaintData& paint_data);
   void saveLayer(double left,
                  double top,
@@ -47,64 +45,12 @@ class Canvas : public fxl::RefCountedThreadSafe<Canvas>,
                  double bottom,
                  const Paint& paint,
                  const PaintData& paint_data);
-  void restore();
   int getSaveCount();
 
-  void translate(double dx, double dy);
-  void scale(double sx, double sy);
-  void rotate(double radians);
-  void skew(double sx, double sy);
   void transform(const tonic::Float64List& matrix4);
 
-  void clipRect(double left,
-                double top,
-                double right,
-                double bottom,
-                SkClipOp clipOp);
-  void clipRRect(const RRect& rrect);
   void clipPath(const CanvasPath* path);
 
-  void drawColor(SkColor color, SkBlendMode blend_mode);
-  void drawLine(double x1,
-                double y1,
-                double x2,
-                double y2,
-                const Paint& paint,
-                const PaintData& paint_data);
-  void drawPaint(const Paint& paint, const PaintData& paint_data);
-  void drawRect(double left,
-                double top,
-                double right,
-                double bottom,
-                const Paint& paint,
-                const PaintData& paint_data);
-  void drawRRect(const RRect& rrect,
-                 const Paint& paint,
-                 const PaintData& paint_data);
-  void drawDRRect(const RRect& outer,
-                  const RRect& inner,
-                  const Paint& paint,
-                  const PaintData& paint_data);
-  void drawOval(double left,
-                double top,
-                double right,
-                double bottom,
-                const Paint& paint,
-                const PaintData& paint_data);
-  void drawCircle(double x,
-                  double y,
-                  double radius,
-                  const Paint& paint,
-                  const PaintData& paint_data);
-  void drawArc(double left,
-               double top,
-               double right,
-               double bottom,
-               double startAngle,
-               double sweepAngle,
-               bool useCenter,
-               const Paint& paint,
-               const PaintData& paint_data);
   void drawPath(const CanvasPath* path,
                 const Paint& paint,
                 const PaintData& paint_data);
@@ -166,6 +112,14 @@ class Canvas : public fxl::RefCountedThreadSafe<Canvas>,
                   double elevation,
                   bool transparentOccluder);
 
+  // Replays the first |word_count| words of the command buffer recorded by
+  // Canvas in painting.dart. |objects| is null or the list of shaders that
+  // the commands refer to. See canvas_commands.h for the format. Returns an
+  // error message if the buffer cannot be replayed, or null.
+  Dart_Handle drawCommands(Dart_Handle objects,
+                           Dart_Handle commands,
+                           int word_count);
+
   SkCanvas* canvas() const { return canvas_; }
   void Clear();
   bool IsRecording() const;
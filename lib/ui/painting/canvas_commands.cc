@@ -0,0 +1,160 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/canvas_commands.h"
+
+#include <math.h>
+
+#include "flutter/lib/ui/painting/paint.h"
+#include "third_party/skia/include/core/SkRRect.h"
+
+namespace blink {
+namespace {
+
+constexpr size_t kRRectWordCount = 12;
+
+// The number of operand words of each command, indexed by opcode.
+constexpr size_t kOperandCounts[] = {
+    0,                        // kSave
+    0,                        // kRestore
+    2,                        // kTranslate
+    2,                        // kScale
+    1,                        // kRotate
+    2,                        // kSkew
+    5,                        // kClipRect
+    kRRectWordCount,          // kClipRRect
+    2,                        // kDrawColor
+    kPaintDataWordCount + 1,  // kSetPaint
+    4,                        // kDrawLine
+    0,                        // kDrawPaint
+    4,                        // kDrawRect
+    kRRectWordCount,          // kDrawRRect
+    2 * kRRectWordCount,      // kDrawDRRect
+    4,                        // kDrawOval
+    3,                        // kDrawCircle
+    7,                        // kDrawArc
+};
+static_assert(sizeof(kOperandCounts) / sizeof(kOperandCounts[0]) ==
+                  static_cast<size_t>(CanvasCommand::kCount),
+              "Every command must have an operand count.");
+
+// Same layout as the Float32List of RRect in painting.dart.
+SkRRect MakeRRect(const float* values) {
+  SkVector radii[4] = {{values[4], values[5]},
+                       {values[6], values[7]},
+                       {values[8], values[9]},
+                       {values[10], values[11]}};
+  SkRRect rrect;
+  rrect.setRectRadii(
+      SkRect::MakeLTRB(values[0], values[1], values[2], values[3]), radii);
+  return rrect;
+}
+
+}  // namespace
+
+bool ReplayCanvasCommands(const uint32_t* words,
+                          size_t word_count,
+                          const std::vector<sk_sp<SkShader>>& shaders,
+                          SkCanvas* canvas) {
+  const float* floats = reinterpret_cast<const float*>(words);
+
+  // The paint is decoded once per kSetPaint command and shared by all the
+  // draw commands that follow it.
+  SkPaint paint;
+  bool has_paint = false;
+
+  size_t index = 0;
+  while (index < word_count) {
+    const uint32_t opcode = words[index++];
+    if (opcode >= static_cast<uint32_t>(CanvasCommand::kCount))
+      return false;
+    const size_t operand_count = kOperandCounts[opcode];
+    if (word_count - index < operand_count)
+      return false;
+
+    const uint32_t* w = words + index;
+    const float* f = floats + index;
+    index += operand_count;
+
+    // Every command from kDrawLine onwards draws with the current paint.
+    const CanvasCommand command = static_cast<CanvasCommand>(opcode);
+    if (command >= CanvasCommand::kDrawLine && !has_paint)
+      return false;
+
+    switch (command) {
+      case CanvasCommand::kSave:
+        canvas->save();
+        break;
+      case CanvasCommand::kRestore:
+        canvas->restore();
+        break;
+      case CanvasCommand::kTranslate:
+        canvas->translate(f[0], f[1]);
+        break;
+      case CanvasCommand::kScale:
+        canvas->scale(f[0], f[1]);
+        break;
+      case CanvasCommand::kRotate:
+        canvas->rotate(f[0] * 180.0 / M_PI);
+        break;
+      case CanvasCommand::kSkew:
+        canvas->skew(f[0], f[1]);
+        break;
+      case CanvasCommand::kClipRect:
+        canvas->clipRect(SkRect::MakeLTRB(f[0], f[1], f[2], f[3]),
+                         static_cast<SkClipOp>(w[4]), true);
+        break;
+      case CanvasCommand::kClipRRect:
+        canvas->clipRRect(MakeRRect(f), true);
+        break;
+      case CanvasCommand::kDrawColor:
+        canvas->drawColor(w[0], static_cast<SkBlendMode>(w[1]));
+        break;
+      case CanvasCommand::kSetPaint: {
+        const uint32_t shader = w[kPaintDataWordCount];
+        if (shader != kCanvasCommandNoShader && shader >= shaders.size())
+          return false;
+        paint = SkPaint();
+        if (shader != kCanvasCommandNoShader)
+          paint.setShader(shaders[shader]);
+        DecodePaintData(w, &paint);
+        has_paint = true;
+        break;
+      }
+      case CanvasCommand::kDrawLine:
+        canvas->drawLine(f[0], f[1], f[2], f[3], paint);
+        break;
+      case CanvasCommand::kDrawPaint:
+        canvas->drawPaint(paint);
+        break;
+      case CanvasCommand::kDrawRect:
+        canvas->drawRect(SkRect::MakeLTRB(f[0], f[1], f[2], f[3]), paint);
+        break;
+      case CanvasCommand::kDrawRRect:
+        canvas->drawRRect(MakeRRect(f), paint);
+        break;
+      case CanvasCommand::kDrawDRRect:
+        canvas->drawDRRect(MakeRRect(f), MakeRRect(f + kRRectWordCount),
+                           paint);
+        break;
+      case CanvasCommand::kDrawOval:
+        canvas->drawOval(SkRect::MakeLTRB(f[0], f[1], f[2], f[3]), paint);
+        break;
+      case CanvasCommand::kDrawCircle:
+        canvas->drawCircle(f[0], f[1], f[2], paint);
+        break;
+      case CanvasCommand::kDrawArc:
+        canvas->drawArc(SkRect::MakeLTRB(f[0], f[1], f[2], f[3]),
+                        f[4] * 180.0 / M_PI, f[5] * 180.0 / M_PI, w[6] != 0,
+                        paint);
+        break;
+      case CanvasCommand::kCount:
+        return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace blink
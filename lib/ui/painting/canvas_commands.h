@@ -0,0 +1,62 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_CANVAS_COMMANDS_H_
+#define FLUTTER_LIB_UI_PAINTING_CANVAS_COMMANDS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkShader.h"
+
+namespace blink {
+
+// The commands that Canvas in painting.dart records into its command buffer
+// instead of calling into the engine. Each command is a 32-bit opcode followed
+// by its operands, which are 32-bit floats unless noted otherwise.
+//
+// Must be kept in sync with _CanvasCommands in painting.dart.
+enum class CanvasCommand : uint32_t {
+  kSave,
+  kRestore,
+  kTranslate,   // dx, dy
+  kScale,       // sx, sy
+  kRotate,      // radians
+  kSkew,        // sx, sy
+  kClipRect,    // left, top, right, bottom, uint32 clip op
+  kClipRRect,   // rrect (12 floats)
+  kDrawColor,   // uint32 color, uint32 blend mode
+  kSetPaint,    // encoded paint (kPaintDataWordCount words), uint32 shader
+  kDrawLine,    // x1, y1, x2, y2
+  kDrawPaint,
+  kDrawRect,    // left, top, right, bottom
+  kDrawRRect,   // rrect (12 floats)
+  kDrawDRRect,  // outer rrect (12 floats), inner rrect (12 floats)
+  kDrawOval,    // left, top, right, bottom
+  kDrawCircle,  // x, y, radius
+  kDrawArc,     // left, top, right, bottom, start, sweep, uint32 use center
+  kCount,
+};
+
+// The shader operand of kSetPaint for paints without a shader. Any other value
+// is an index into the shaders passed to ReplayCanvasCommands.
+constexpr uint32_t kCanvasCommandNoShader = 0xFFFFFFFF;
+
+// Replays the first |word_count| words of a command buffer into |canvas|. The
+// draw commands use the paint of the last kSetPaint command of the buffer;
+// each buffer starts without a paint.
+//
+// Returns false if the buffer is malformed, in which case the commands that
+// precede the malformed one have already been replayed.
+bool ReplayCanvasCommands(const uint32_t* words,
+                          size_t word_count,
+                          const std::vector<sk_sp<SkShader>>& shaders,
+                          SkCanvas* canvas);
+
+}  // namespace blink
+
+#endif  // FLUTTER_LIB_UI_PAINTING_CANVAS_COMMANDS_H_
@@ -0,0 +1,108 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "flutter/lib/ui/painting/canvas_commands.h"
+#include "flutter/lib/ui/painting/paint.h"
+#include "third_party/benchmark/include/benchmark/benchmark_api.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+
+namespace blink {
+namespace {
+
+constexpr int kRectCount = 10000;
+
+// Must match _CanvasCommands._kCapacity in painting.dart.
+constexpr size_t kCommandBufferCapacity = 4096;
+
+// The encoded data of a Paint that only sets a color. The color is encoded
+// as in painting.dart, XORed with the default color.
+std::vector<uint32_t> MakePaintData() {
+  std::vector<uint32_t> data(kPaintDataWordCount, 0);
+  data[1] = 0xFF2196F3 ^ 0xFF000000;
+  return data;
+}
+
+SkRect MakeRect(int i) {
+  return SkRect::MakeXYWH((i % 100) * 4, (i / 100) * 4, 3, 3);
+}
+
+void AppendFloat(std::vector<uint32_t>* words, float value) {
+  uint32_t word;
+  memcpy(&word, &value, sizeof(word));
+  words->push_back(word);
+}
+
+// Encodes the rects the way Canvas in painting.dart does: a paint is only
+// recorded at the start of each buffer, as every rect uses the same paint,
+// and a buffer is replayed whenever it is full.
+std::vector<std::vector<uint32_t>> MakeCommandBuffers() {
+  const std::vector<uint32_t> paint_data = MakePaintData();
+  std::vector<std::vector<uint32_t>> buffers;
+  for (int i = 0; i < kRectCount; i++) {
+    const size_t rect_word_count = 5;
+    if (buffers.empty() ||
+        buffers.back().size() + rect_word_count > kCommandBufferCapacity) {
+      buffers.emplace_back();
+      std::vector<uint32_t>& words = buffers.back();
+      words.push_back(static_cast<uint32_t>(CanvasCommand::kSetPaint));
+      words.insert(words.end(), paint_data.begin(), paint_data.end());
+      words.push_back(kCanvasCommandNoShader);
+    }
+    std::vector<uint32_t>& words = buffers.back();
+    const SkRect rect = MakeRect(i);
+    words.push_back(static_cast<uint32_t>(CanvasCommand::kDrawRect));
+    AppendFloat(&words, rect.left());
+    AppendFloat(&words, rect.top());
+    AppendFloat(&words, rect.right());
+    AppendFloat(&words, rect.bottom());
+  }
+  return buffers;
+}
+
+}  // namespace
+
+// Records the rects the way the individual Canvas.drawRect native calls do,
+// decoding the paint of every call. This does not include the cost of the
+// transitions from Dart, which the label counts.
+static void BM_RecordRectsPerCall(benchmark::State& state) {
+  const std::vector<uint32_t> paint_data = MakePaintData();
+  while (state.KeepRunning()) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(400, 400));
+    for (int i = 0; i < kRectCount; i++) {
+      SkPaint paint;
+      DecodePaintData(paint_data.data(), &paint);
+      canvas->drawRect(MakeRect(i), paint);
+    }
+    benchmark::DoNotOptimize(recorder.finishRecordingAsPicture());
+  }
+  state.SetLabel(std::to_string(kRectCount) + " native calls");
+}
+BENCHMARK(BM_RecordRectsPerCall);
+
+// Records the rects by replaying command buffers, as Canvas.drawRect does
+// when the commands are flushed.
+static void BM_RecordRectsBatched(benchmark::State& state) {
+  const std::vector<std::vector<uint32_t>> buffers = MakeCommandBuffers();
+  const std::vector<sk_sp<SkShader>> shaders;
+  while (state.KeepRunning()) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(400, 400));
+    for (const auto& words : buffers) {
+      ReplayCanvasCommands(words.data(), words.size(), shaders, canvas);
+    }
+    benchmark::DoNotOptimize(recorder.finishRecordingAsPicture());
+  }
+  state.SetLabel(std::to_string(buffers.size()) + " native calls");
+}
+BENCHMARK(BM_RecordRectsBatched);
+
+}  // namespace blink
+
+BENCHMARK_MAIN();
@@ -4,6 +4,8 @@
 
 #include "flutter/lib/ui/painting/codec.h"
 
+#include <algorithm>
+
 #include "flutter/common/threads.h"
 #include "flutter/glue/trace_event.h"
 #include "flutter/lib/ui/painting/frame_info.h"
@@ -45,50 +47,129 @@ void InvokeCodecCallback(fxl::RefPtr<Codec> codec,
   TRACE_FLOW_END("flutter", kInitCodecTraceTag, trace_id);
 }
 
-sk_sp<SkImage> DecodeImage(sk_sp<SkData> buffer, size_t trace_id) {
-  TRACE_FLOW_STEP("flutter", kInitCodecTraceTag, trace_id);
-  TRACE_EVENT0("flutter", "DecodeImage");
+// Returns the size an image of |image_size| is decoded at. A target dimension
+// that is not positive follows the aspect ratio of the image. Images are never
+// scaled up.
+SkISize GetDecodeSize(const SkISize& image_size,
+                      int target_width,
+                      int target_height) {
+  if (target_width <= 0 && target_height <= 0) {
+    return image_size;
+  }
+  if (target_width <= 0) {
+    target_width = std::max(
+        1, static_cast<int>(static_cast<int64_t>(target_height) *
+                            image_size.width() / image_size.height()));
+  }
+  if (target_height <= 0) {
+    target_height = std::max(
+        1, static_cast<int>(static_cast<int64_t>(target_width) *
+                            image_size.height() / image_size.width()));
+  }
+  if (target_width >= image_size.width() &&
+      target_height >= image_size.height()) {
+    return image_size;
+  }
+  return SkISize::Make(std::min(target_width, image_size.width()),
+                       std::min(target_height, image_size.height()));
+}
 
-  if (buffer == nullptr || buffer->isEmpty()) {
-    return nullptr;
+// Decodes the first frame of |codec| into a bitmap of |decode_size|. Codecs
+// that can decode at a reduced scale (JPEG, WebP) do so to avoid allocating
+// the full size image. Whatever scaling remains is done by resampling.
+bool DecodeToBitmap(SkCodec* codec,
+                    const SkISize& decode_size,
+                    SkBitmap* bitmap) {
+  const SkISize image_size = codec->getInfo().dimensions();
+  const float scale = std::max(
+      static_cast<float>(decode_size.width()) / image_size.width(),
+      static_cast<float>(decode_size.height()) / image_size.height());
+  const SkISize scaled_size =
+      scale < 1 ? codec->getScaledDimensions(scale) : image_size;
+
+  // This indicates that we do not want a "linear blending" decode.
+  SkImageInfo info = codec->getInfo()
+                         .makeWH(scaled_size.width(), scaled_size.height())
+                         .makeColorType(kN32_SkColorType)
+                         .makeColorSpace(nullptr);
+  if (info.alphaType() == kUnpremul_SkAlphaType) {
+    info = info.makeAlphaType(kPremul_SkAlphaType);
+  }
+
+  SkBitmap decoded;
+  if (!decoded.tryAllocPixels(info)) {
+    return false;
+  }
+  const SkCodec::Result result =
+      codec->getPixels(info, decoded.getPixels(), decoded.rowBytes());
+  if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput) {
+    return false;
+  }
+
+  if (scaled_size == decode_size) {
+    bitmap->swap(decoded);
+    return true;
   }
 
+  TRACE_EVENT0("flutter", "ResampleImage");
+  SkBitmap resampled;
+  SkPixmap src;
+  SkPixmap dst;
+  if (!resampled.tryAllocPixels(
+          info.makeWH(decode_size.width(), decode_size.height())) ||
+      !decoded.peekPixels(&src) || !resampled.peekPixels(&dst) ||
+      !src.scalePixels(dst, kMedium_SkFilterQuality)) {
+    return false;
+  }
+  bitmap->swap(resampled);
+  return true;
+}
+
+// Makes an image of the pixels in |bitmap|. The pixels are uploaded to the
+// resource context if there is one and shared with the image otherwise. Must
+// run on the IO thread.
+sk_sp<SkImage> MakeImageFromBitmap(const SkBitmap& bitmap) {
   std::unique_ptr<ResourceContext> resourceContext = ResourceContext::Acquire();
   GrContext* context = resourceContext->Get();
   if (context) {
+    SkPixmap pixmap(bitmap.info(), bitmap.pixelRef()->pixels(),
+                    bitmap.pixelRef()->rowBytes());
     // This indicates that we do not want a "linear blending" decode.
     sk_sp<SkColorSpace> dstColorSpace = nullptr;
-    return SkImage::MakeCrossContextFromEncoded(context, std::move(buffer),
-                                                false, dstColorSpace.get());
+    return SkImage::MakeCrossContextFromPixmap(context, pixmap, false,
+                                               dstColorSpace.get());
   } else {
-    // Defer decoding until time of draw later on the GPU thread. Can happen
+    // Defer the upload until time of draw later on the GPU thread. Can happen
     // when GL operations are currently forbidden such as in the background
     // on iOS.
-    return SkImage::MakeFromEncoded(std::move(buffer));
+    return SkImage::MakeFromBitmap(bitmap);
   }
 }
 
-fxl::RefPtr<Codec> InitCodec(sk_sp<SkData> buffer, size_t trace_id) {
+bool DecodeImage(SkCodec* codec,
+                 int target_width,
+                 int target_height,
+                 size_t trace_id,
+                 SkBitmap* bitmap) {
   TRACE_FLOW_STEP("flutter", kInitCodecTraceTag, trace_id);
-  TRACE_EVENT0("blink", "InitCodec");
+  TRACE_EVENT0("flutter", "DecodeImage");
 
-  if (buffer == nullptr || buffer->isEmpty()) {
-    FXL_LOG(ERROR) << "InitCodec failed - buffer was empty ";
-    return nullptr;
+  const SkISize decode_size = GetDecodeSize(codec->getInfo().dimensions(),
+                                            target_width, target_height);
+  if (!DecodeToBitmap(codec, decode_size, bitmap)) {
+    return false;
   }
+  // The image shares the decoded pixels instead of copying them.
+  bitmap->setImmutable();
+  return true;
+}
 
-  std::unique_ptr<SkCodec> skCodec = SkCodec::MakeFromData(buffer);
-  if (!skCodec) {
-    FXL_LOG(ERROR) << "Failed decoding image. Data is either invalid, or it is "
-                      "encoded using an unsupported format.";
-    return nullptr;
-  }
-  if (skCodec->getFrameCount() > 1) {
-    return fxl::MakeRefCounted<MultiFrameCodec>(std::move(skCodec));
-  }
-  auto skImage = DecodeImage(buffer, trace_id);
+// Must run on the IO thread, the only thread on which the resource context is
+// current.
+fxl::RefPtr<Codec> MakeSingleFrameCodec(const SkBitmap& bitmap) {
+  auto skImage = MakeImageFromBitmap(bitmap);
   if (!skImage) {
-    FXL_LOG(ERROR) << "DecodeImage failed";
+    FXL_LOG(ERROR) << "MakeImageFromBitmap failed";
     return nullptr;
   }
   auto image = CanvasImage::Create();
@@ -97,11 +178,9 @@ fxl::RefPtr<Codec> InitCodec(sk_sp<SkData> buffer, size_t trace_id) {
   return fxl::MakeRefCounted<SingleFrameCodec>(std::move(frameInfo));
 }
 
-void InitCodecAndInvokeCodecCallback(
-    std::unique_ptr<DartPersistentValue> callback,
-    sk_sp<SkData> buffer,
-    size_t trace_id) {
-  auto codec = InitCodec(std::move(buffer), trace_id);
+void PostCodecCallback(std::unique_ptr<DartPersistentValue> callback,
+                       fxl::RefPtr<Codec> codec,
+                       size_t trace_id) {
   Threads::UI()->PostTask(fxl::MakeCopyable([
     callback = std::move(callback), codec = std::move(codec), trace_id
   ]() mutable {
@@ -109,6 +188,52 @@ void InitCodecAndInvokeCodecCallback(
   }));
 }
 
+// Runs on the image decode threads. Only the upload of a decoded image is
+// posted to the IO thread.
+void InitCodecAndInvokeCodecCallback(
+    std::unique_ptr<DartPersistentValue> callback,
+    sk_sp<SkData> buffer,
+    int target_width,
+    int target_height,
+    size_t trace_id) {
+  TRACE_FLOW_STEP("flutter", kInitCodecTraceTag, trace_id);
+  TRACE_EVENT0("blink", "InitCodec");
+
+  if (buffer == nullptr || buffer->isEmpty()) {
+    FXL_LOG(ERROR) << "InitCodec failed - buffer was empty ";
+    PostCodecCallback(std::move(callback), nullptr, trace_id);
+    return;
+  }
+
+  std::unique_ptr<SkCodec> skCodec = SkCodec::MakeFromData(std::move(buffer));
+  if (!skCodec) {
+    FXL_LOG(ERROR) << "Failed decoding image. Data is either invalid, or it is "
+                      "encoded using an unsupported format.";
+    PostCodecCallback(std::move(callback), nullptr, trace_id);
+    return;
+  }
+  if (skCodec->getFrameCount() > 1) {
+    PostCodecCallback(std::move(callback),
+                      fxl::MakeRefCounted<MultiFrameCodec>(std::move(skCodec)),
+                      trace_id);
+    return;
+  }
+
+  SkBitmap bitmap;
+  if (!DecodeImage(skCodec.get(), target_width, target_height, trace_id,
+                   &bitmap)) {
+    FXL_LOG(ERROR) << "DecodeImage failed";
+    PostCodecCallback(std::move(callback), nullptr, trace_id);
+    return;
+  }
+
+  Threads::IO()->PostTask(fxl::MakeCopyable(
+      [callback = std::move(callback), bitmap, trace_id]() mutable {
+        PostCodecCallback(std::move(callback), MakeSingleFrameCodec(bitmap),
+                          trace_id);
+      }));
+}
+
 void InstantiateImageCodec(Dart_NativeArguments args) {
   static size_t trace_counter = 1;
   const size_t trace_id = trace_counter++;
@@ -131,15 +256,35 @@ void InstantiateImageCodec(Dart_NativeArguments args) {
     return;
   }
 
+  const int target_width =
+      tonic::DartConverter<int>::FromArguments(args, 2, exception);
+  if (exception) {
+    TRACE_FLOW_END("flutter", kInitCodecTraceTag, trace_id);
+    Dart_SetReturnValue(args, exception);
+    return;
+  }
+
+  const int target_height =
+      tonic::DartConverter<int>::FromArguments(args, 3, exception);
+  if (exception) {
+    TRACE_FLOW_END("flutter", kInitCodecTraceTag, trace_id);
+    Dart_SetReturnValue(args, exception);
+    return;
+  }
+
+  // The Dart heap may move the list once this call returns, so the encoded
+  // bytes are copied exactly once. From here on they are shared, not copied.
   auto buffer = SkData::MakeWithCopy(list.data(), list.num_elements());
 
-  Threads::IO()->PostTask(fxl::MakeCopyable([
+  // Decodes run on a pool of threads so that images do not queue up behind
+  // each other on the IO thread.
+  Threads::ImageDecode()->PostTask(fxl::MakeCopyable([
     callback = std::make_unique<DartPersistentValue>(
         tonic::DartState::Current(), callback_handle),
-    buffer = std::move(buffer), trace_id
+    buffer = std::move(buffer), target_width, target_height, trace_id
   ]() mutable {
     InitCodecAndInvokeCodecCallback(std::move(callback), std::move(buffer),
-                                    trace_id);
+                                    target_width, target_height, trace_id);
   }));
 }
 
@@ -206,67 +351,125 @@ void Codec::dispose() {
 }
 
 MultiFrameCodec::MultiFrameCodec(std::unique_ptr<SkCodec> codec)
-    : codec_(std::move(codec)) {
+    : codec_(std::move(codec)),
+      aheadFrameIndex_(SkCodec::kNone),
+      maxDecodedBytes_(0) {
   repetitionCount_ = codec_->getRepetitionCount();
   frameInfos_ = codec_->getFrameInfo();
-  frameBitmaps_.resize(frameInfos_.size());
   nextFrameIndex_ = 0;
-}
 
-sk_sp<SkImage> MultiFrameCodec::GetNextFrameImage() {
-  SkBitmap& bitmap = frameBitmaps_[nextFrameIndex_];
-  if (!bitmap.getPixels()) {  // We haven't decoded this frame yet
-    const SkImageInfo info = codec_->getInfo().makeColorType(kN32_SkColorType);
-    bitmap.allocPixels(info);
-
-    SkCodec::Options options;
-    options.fFrameIndex = nextFrameIndex_;
-    const int requiredFrame = frameInfos_[nextFrameIndex_].fRequiredFrame;
-    if (requiredFrame != SkCodec::kNone) {
-      if (requiredFrame < 0 ||
-          static_cast<size_t>(requiredFrame) >= frameBitmaps_.size()) {
-        FXL_LOG(ERROR) << "Frame " << nextFrameIndex_ << " depends on frame "
-                       << requiredFrame << " which out of range (0,"
-                       << frameBitmaps_.size() << ").";
-        return NULL;
-      }
-      SkBitmap& requiredBitmap = frameBitmaps_[requiredFrame];
-      // For simplicity, do not try to cache old frames
-      if (requiredBitmap.getPixels() &&
-          copy_to(&bitmap, requiredBitmap.colorType(), requiredBitmap)) {
-        options.fPriorFrame = requiredFrame;
-      }
+  const int frameCount = frameInfos_.size();
+  lastDependentFrame_.assign(frameCount, SkCodec::kNone);
+  for (int i = 0; i < frameCount; i++) {
+    const int requiredFrame = frameInfos_[i].fRequiredFrame;
+    if (requiredFrame >= 0 && requiredFrame < i) {
+      lastDependentFrame_[requiredFrame] = i;
+    }
+  }
+
+  // Replay one loop to find out how many required frames are kept at once.
+  // Add one frame decoded ahead of time.
+  size_t maxFrames = 0;
+  std::vector<int> keptUntil;
+  for (int i = 0; i < frameCount; i++) {
+    keptUntil.erase(std::remove_if(keptUntil.begin(), keptUntil.end(),
+                                   [i](int last) { return last <= i; }),
+                    keptUntil.end());
+    if (lastDependentFrame_[i] > i) {
+      keptUntil.push_back(lastDependentFrame_[i]);
     }
+    maxFrames = std::max(maxFrames, keptUntil.size());
+  }
+  const SkImageInfo info = codec_->getInfo().makeColorType(kN32_SkColorType);
+  maxDecodedBytes_ = (maxFrames + 1) * info.minRowBytes() * info.height();
+}
 
-    if (SkCodec::kSuccess != codec_->getPixels(info, bitmap.getPixels(),
-                                               bitmap.rowBytes(), &options)) {
-      FXL_LOG(ERROR) << "Could not getPixels for frame " << nextFrameIndex_;
+size_t MultiFrameCodec::GetAllocationSize() {
+  return sizeof(MultiFrameCodec) + maxDecodedBytes_;
+}
+
+sk_sp<SkImage> MultiFrameCodec::DecodeFrame(int frameIndex) {
+  TRACE_EVENT0("flutter", "MultiFrameCodec::DecodeFrame");
+
+  // Frames are decoded in order. A new loop starts over with its own
+  // required frames.
+  if (frameIndex == 0) {
+    requiredFrameBitmaps_.clear();
+  }
+
+  const SkImageInfo info = codec_->getInfo().makeColorType(kN32_SkColorType);
+  SkBitmap bitmap;
+
+  SkCodec::Options options;
+  options.fFrameIndex = frameIndex;
+  const int requiredFrame = frameInfos_[frameIndex].fRequiredFrame;
+  if (requiredFrame != SkCodec::kNone) {
+    if (requiredFrame < 0 ||
+        static_cast<size_t>(requiredFrame) >= frameInfos_.size()) {
+      FXL_LOG(ERROR) << "Frame " << frameIndex << " depends on frame "
+                     << requiredFrame << " which out of range (0,"
+                     << frameInfos_.size() << ").";
       return NULL;
     }
+    // If the required frame is not at hand the codec decodes it first.
+    auto found = requiredFrameBitmaps_.find(requiredFrame);
+    if (found != requiredFrameBitmaps_.end() &&
+        copy_to(&bitmap, found->second.colorType(), found->second)) {
+      options.fPriorFrame = requiredFrame;
+    }
   }
 
-  std::unique_ptr<ResourceContext> resourceContext = ResourceContext::Acquire();
-  GrContext* context = resourceContext->Get();
-  if (context) {
-    SkPixmap pixmap(bitmap.info(), bitmap.pixelRef()->pixels(),
-                    bitmap.pixelRef()->rowBytes());
-    // This indicates that we do not want a "linear blending" decode.
-    sk_sp<SkColorSpace> dstColorSpace = nullptr;
-    return SkImage::MakeCrossContextFromPixmap(context, pixmap, false,
-                                               dstColorSpace.get());
-  } else {
-    // Defer decoding until time of draw later on the GPU thread. Can happen
-    // when GL operations are currently forbidden such as in the background
-    // on iOS.
-    return SkImage::MakeFromBitmap(bitmap);
+  if (!bitmap.getPixels() && !bitmap.tryAllocPixels(info)) {
+    FXL_LOG(ERROR) << "Could not allocate pixels for frame " << frameIndex;
+    return NULL;
+  }
+
+  if (SkCodec::kSuccess != codec_->getPixels(info, bitmap.getPixels(),
+                                             bitmap.rowBytes(), &options)) {
+    FXL_LOG(ERROR) << "Could not getPixels for frame " << frameIndex;
+    return NULL;
+  }
+
+  // Drop the frames that no later frame of this loop depends on.
+  for (auto it = requiredFrameBitmaps_.begin();
+       it != requiredFrameBitmaps_.end();) {
+    if (lastDependentFrame_[it->first] <= frameIndex) {
+      it = requiredFrameBitmaps_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // The pixels are never written again, which lets the image share them with
+  // the cached bitmap.
+  bitmap.setImmutable();
+  if (lastDependentFrame_[frameIndex] > frameIndex) {
+    requiredFrameBitmaps_[frameIndex] = bitmap;
+  }
+
+  return MakeImageFromBitmap(bitmap);
+}
+
+void MultiFrameCodec::DecodeNextFrameAheadOfTime() {
+  if (aheadFrameIndex_ == nextFrameIndex_) {
+    return;
   }
+  aheadFrameImage_ = DecodeFrame(nextFrameIndex_);
+  aheadFrameIndex_ = nextFrameIndex_;
 }
 
 void MultiFrameCodec::GetNextFrameAndInvokeCallback(
     std::unique_ptr<DartPersistentValue> callback,
     size_t trace_id) {
+  sk_sp<SkImage> skImage;
+  if (aheadFrameIndex_ == nextFrameIndex_) {
+    skImage = std::move(aheadFrameImage_);
+    aheadFrameIndex_ = SkCodec::kNone;
+  } else {
+    skImage = DecodeFrame(nextFrameIndex_);
+  }
+
   fxl::RefPtr<FrameInfo> frameInfo = NULL;
-  sk_sp<SkImage> skImage = GetNextFrameImage();
   if (skImage) {
     fxl::RefPtr<CanvasImage> image = CanvasImage::Create();
     image->set_image(skImage);
@@ -280,6 +483,12 @@ void MultiFrameCodec::GetNextFrameAndInvokeCallback(
         InvokeNextFrameCallback(frameInfo, std::move(callback), trace_id);
       }));
 
+  // Decode the following frame while this one is being displayed, so that it
+  // is ready by the time it is asked for.
+  Threads::IO()->PostTask([codec = fxl::RefPtr<MultiFrameCodec>(this)]() {
+    codec->DecodeNextFrameAheadOfTime();
+  });
+
   TRACE_FLOW_END("flutter", kCodecNextFrameTraceTag, trace_id);
 }
 
@@ -296,9 +505,9 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
   Threads::IO()->PostTask(fxl::MakeCopyable([
     callback = std::make_unique<DartPersistentValue>(
         tonic::DartState::Current(), callback_handle),
-    this, trace_id
+    codec = fxl::RefPtr<MultiFrameCodec>(this), trace_id
   ]() mutable {
-    GetNextFrameAndInvokeCallback(std::move(callback), trace_id);
+    codec->GetNextFrameAndInvokeCallback(std::move(callback), trace_id);
   }));
 
   return Dart_Null();
@@ -323,7 +532,7 @@ Dart_Handle SingleFrameCodec::getNextFrame(Dart_Handle callback_handle) {
 
 void Codec::RegisterNatives(tonic::DartLibraryNatives* natives) {
   natives->Register({
-      {"instantiateImageCodec", InstantiateImageCodec, 2, true},
+      {"instantiateImageCodec", InstantiateImageCodec, 4, true},
   });
   natives->Register({FOR_EACH_BINDING(DART_REGISTER_NATIVE)});
 }
@@ -5,6 +5,9 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_CODEC_H_
 #define FLUTTER_LIB_UI_PAINTING_CODEC_H_
 
+#include <map>
+#include <vector>
+
 #include "flutter/lib/ui/painting/frame_info.h"
 #include "lib/tonic/dart_wrappable.h"
 #include "third_party/skia/include/codec/SkCodec.h"
@@ -41,11 +44,14 @@ class MultiFrameCodec : public Codec {
   int repetitionCount() { return repetitionCount_; }
   Dart_Handle getNextFrame(Dart_Handle args);
 
+  virtual size_t GetAllocationSize() override;
+
  private:
   MultiFrameCodec(std::unique_ptr<SkCodec> codec);
   ~MultiFrameCodec() {}
 
-  sk_sp<SkImage> GetNextFrameImage();
+  sk_sp<SkImage> DecodeFrame(int frameIndex);
+  void DecodeNextFrameAheadOfTime();
   void GetNextFrameAndInvokeCallback(
       std::unique_ptr<DartPersistentValue> callback,
       size_t trace_id);
@@ -55,7 +61,19 @@ class MultiFrameCodec : public Codec {
   int nextFrameIndex_;
 
   std::vector<SkCodec::FrameInfo> frameInfos_;
-  std::vector<SkBitmap> frameBitmaps_;
+  // The index of the last frame that is decoded on top of each frame, or
+  // SkCodec::kNone if no frame depends on it.
+  std::vector<int> lastDependentFrame_;
+  // Decoded frames that frames later in the current loop depend on. All other
+  // frames are dropped as soon as they have been handed out.
+  std::map<int, SkBitmap> requiredFrameBitmaps_;
+
+  // The next frame, decoded while the current one is being displayed.
+  int aheadFrameIndex_;
+  sk_sp<SkImage> aheadFrameImage_;
+
+  // The most memory the frames above ever take up.
+  size_t maxDecodedBytes_;
 
   FRIEND_MAKE_REF_COUNTED(MultiFrameCodec);
   FRIEND_REF_COUNTED_THREAD_SAFE(MultiFrameCodec);
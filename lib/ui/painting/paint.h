@@ -27,6 +27,14 @@ class Paint {
 // data for a Paint object).
 class PaintData {};
 
+// The number of 32-bit fields in the encoded data of a Paint.
+constexpr size_t kPaintDataWordCount = 15;
+
+// Applies the encoded data of a Paint to |paint|, which must be in its default
+// state apart from its shader. The data is read as |kPaintDataWordCount|
+// 32-bit fields, in the format written by the Paint class in painting.dart.
+void DecodePaintData(const uint32_t* data, SkPaint* paint);
+
 }  // namespace blink
 
 namespace tonic {
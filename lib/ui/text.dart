@@ -942,6 +942,25 @@ class Paragraph extends NativeFieldWrapperClass2 {
   void layout(ParagraphConstraints constraints) => _layout(constraints.width);
   void _layout(double width) native 'Paragraph_layout';
 
+  /// Computes the size and position of each glyph in the paragraph on a
+  /// background thread.
+  ///
+  /// The returned future completes with this paragraph once the layout is
+  /// done. Until then, reading the size or other metrics of the paragraph,
+  /// hit testing it or painting it blocks until the layout is done. If
+  /// [layout] or [layoutAsync] is called again before the layout starts, it is
+  /// skipped and the latest constraints win.
+  ///
+  /// The [ParagraphConstraints] control how wide the text is allowed to be.
+  Future<Paragraph> layoutAsync(ParagraphConstraints constraints) {
+    return _futurize((_Callback<Paragraph> callback) {
+      return _layoutAsync(constraints.width, callback);
+    });
+  }
+
+  /// Returns an error message on failure, null on success.
+  String _layoutAsync(double width, _Callback<Paragraph> callback) native 'Paragraph_layoutAsync';
+
   /// Returns a list of text boxes that enclose the given text range.
   List<TextBox> getBoxesForRange(int start, int end) native 'Paragraph_getRectsForRange';
 
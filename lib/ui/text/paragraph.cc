@@ -6,6 +6,7 @@
 
 #include "flutter/common/settings.h"
 #include "flutter/common/threads.h"
+#include "flutter/glue/trace_event.h"
 #include "flutter/sky/engine/core/rendering/PaintInfo.h"
 #include "flutter/sky/engine/core/rendering/RenderParagraph.h"
 #include "flutter/sky/engine/core/rendering/RenderText.h"
@@ -14,16 +15,33 @@
 #include "flutter/sky/engine/platform/graphics/GraphicsContext.h"
 #include "flutter/sky/engine/platform/text/TextBoundaries.h"
 #include "flutter/sky/engine/wtf/PassOwnPtr.h"
+#include "lib/fxl/functional/make_copyable.h"
 #include "lib/fxl/logging.h"
 #include "lib/fxl/tasks/task_runner.h"
 #include "lib/tonic/converter/dart_converter.h"
 #include "lib/tonic/dart_args.h"
 #include "lib/tonic/dart_binding_macros.h"
 #include "lib/tonic/dart_library_natives.h"
+#include "lib/tonic/dart_state.h"
+#include "lib/tonic/logging/dart_invoke.h"
 
+using tonic::DartInvoke;
+using tonic::DartPersistentValue;
 using tonic::ToDart;
 
 namespace blink {
+namespace {
+
+void InvokeLayoutCallback(fxl::RefPtr<Paragraph> paragraph,
+                          std::unique_ptr<DartPersistentValue> callback) {
+  tonic::DartState* dart_state = callback->dart_state().get();
+  if (!dart_state)
+    return;
+  tonic::DartState::Scope scope(dart_state);
+  DartInvoke(callback->value(), {ToDart(paragraph)});
+}
+
+}  // namespace
 
 IMPLEMENT_WRAPPERTYPEINFO(ui, Paragraph);
 
@@ -36,6 +54,7 @@ IMPLEMENT_WRAPPERTYPEINFO(ui, Paragraph);
   V(Paragraph, ideographicBaseline) \
   V(Paragraph, didExceedMaxLines)   \
   V(Paragraph, layout)              \
+  V(Paragraph, layoutAsync)         \
   V(Paragraph, paint)               \
   V(Paragraph, getWordBoundary)     \
   V(Paragraph, getRectsForRange)    \
@@ -43,8 +62,13 @@ IMPLEMENT_WRAPPERTYPEINFO(ui, Paragraph);
 
 DART_BIND_ALL(Paragraph, FOR_EACH_BINDING)
 
-Paragraph::Paragraph(PassOwnPtr<RenderView> renderView)
-    : m_paragraphImpl(std::make_unique<ParagraphImplBlink>(renderView)) {}
+Paragraph::Paragraph(PassOwnPtr<RenderView> renderView,
+                     PassOwnPtr<RenderArena> renderArena)
+    : m_paragraphImpl(
+          std::make_unique<ParagraphImplBlink>(renderView, renderArena)) {}
+
+Paragraph::Paragraph(PassOwnPtr<SingleRunParagraph> singleRun)
+    : m_paragraphImpl(std::make_unique<ParagraphImplBlink>(singleRun)) {}
 
 Paragraph::Paragraph(std::unique_ptr<txt::Paragraph> paragraph)
     : m_paragraphImpl(
@@ -65,50 +89,118 @@ size_t Paragraph::GetAllocationSize() {
 }
 
 double Paragraph::width() {
+  waitForPendingLayouts();
   return m_paragraphImpl->width();
 }
 
 double Paragraph::height() {
+  waitForPendingLayouts();
   return m_paragraphImpl->height();
 }
 
 double Paragraph::minIntrinsicWidth() {
+  waitForPendingLayouts();
   return m_paragraphImpl->minIntrinsicWidth();
 }
 
 double Paragraph::maxIntrinsicWidth() {
+  waitForPendingLayouts();
   return m_paragraphImpl->maxIntrinsicWidth();
 }
 
 double Paragraph::alphabeticBaseline() {
+  waitForPendingLayouts();
   return m_paragraphImpl->alphabeticBaseline();
 }
 
 double Paragraph::ideographicBaseline() {
+  waitForPendingLayouts();
   return m_paragraphImpl->ideographicBaseline();
 }
 
 bool Paragraph::didExceedMaxLines() {
+  waitForPendingLayouts();
   return m_paragraphImpl->didExceedMaxLines();
 }
 
+void Paragraph::waitForPendingLayouts() {
+  std::unique_lock<std::mutex> lock(m_layoutMutex);
+  m_layoutDone.wait(lock, [this]() { return m_pendingLayouts == 0; });
+}
+
 void Paragraph::layout(double width) {
+  std::lock_guard<std::mutex> lock(m_layoutMutex);
+  ++m_layoutGeneration;
   m_paragraphImpl->layout(width);
 }
 
+Dart_Handle Paragraph::layoutAsync(double width, Dart_Handle callback_handle) {
+  if (!Dart_IsClosure(callback_handle)) {
+    return ToDart("Callback must be a function");
+  }
+
+  auto callback = std::make_unique<DartPersistentValue>(
+      tonic::DartState::Current(), callback_handle);
+
+  if (!m_paragraphImpl->canLayoutOffThread()) {
+    layout(width);
+    Threads::UI()->PostTask(fxl::MakeCopyable([
+      paragraph = fxl::RefPtr<Paragraph>(this), callback = std::move(callback)
+    ]() mutable {
+      InvokeLayoutCallback(std::move(paragraph), std::move(callback));
+    }));
+    return Dart_Null();
+  }
+
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(m_layoutMutex);
+    generation = ++m_layoutGeneration;
+    ++m_pendingLayouts;
+  }
+
+  // The task keeps the paragraph alive until the callback has run. Both are
+  // handed back to the UI thread so that they are released there.
+  Threads::TextLayout()->PostTask(fxl::MakeCopyable([
+    paragraph = fxl::RefPtr<Paragraph>(this), width, generation,
+    callback = std::move(callback)
+  ]() mutable {
+    {
+      TRACE_EVENT0("flutter", "Paragraph::layoutAsync");
+      std::lock_guard<std::mutex> lock(paragraph->m_layoutMutex);
+      // A layout requested after this one has already run or is pending, so
+      // this one must not overwrite it.
+      if (paragraph->m_layoutGeneration == generation)
+        paragraph->m_paragraphImpl->layout(width);
+      if (--paragraph->m_pendingLayouts == 0)
+        paragraph->m_layoutDone.notify_all();
+    }
+    Threads::UI()->PostTask(fxl::MakeCopyable([
+      paragraph = std::move(paragraph), callback = std::move(callback)
+    ]() mutable {
+      InvokeLayoutCallback(std::move(paragraph), std::move(callback));
+    }));
+  }));
+  return Dart_Null();
+}
+
 void Paragraph::paint(Canvas* canvas, double x, double y) {
+  waitForPendingLayouts();
   m_paragraphImpl->paint(canvas, x, y);
 }
 
 std::vector<TextBox> Paragraph::getRectsForRange(unsigned start, unsigned end) {
+  waitForPendingLayouts();
   return m_paragraphImpl->getRectsForRange(start, end);
 }
 
 Dart_Handle Paragraph::getPositionForOffset(double dx, double dy) {
+  waitForPendingLayouts();
   return m_paragraphImpl->getPositionForOffset(dx, dy);
 }
 
 Dart_Handle Paragraph::getWordBoundary(unsigned offset) {
+  waitForPendingLayouts();
   return m_paragraphImpl->getWordBoundary(offset);
 }
 
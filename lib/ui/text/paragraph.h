@@ -5,6 +5,11 @@
 #ifndef FLUTTER_LIB_UI_TEXT_PARAGRAPH_H_
 #define FLUTTER_LIB_UI_TEXT_PARAGRAPH_H_
 
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+
 #include "flutter/lib/ui/painting/canvas.h"
 #include "flutter/lib/ui/text/paragraph_impl.h"
 #include "flutter/lib/ui/text/paragraph_impl_blink.h"
@@ -27,8 +32,14 @@ class Paragraph : public fxl::RefCountedThreadSafe<Paragraph>,
   FRIEND_MAKE_REF_COUNTED(Paragraph);
 
  public:
-  static fxl::RefPtr<Paragraph> Create(PassOwnPtr<RenderView> renderView) {
-    return fxl::MakeRefCounted<Paragraph>(renderView);
+  static fxl::RefPtr<Paragraph> Create(PassOwnPtr<RenderView> renderView,
+                                       PassOwnPtr<RenderArena> renderArena) {
+    return fxl::MakeRefCounted<Paragraph>(renderView, renderArena);
+  }
+
+  static fxl::RefPtr<Paragraph> Create(
+      PassOwnPtr<SingleRunParagraph> singleRun) {
+    return fxl::MakeRefCounted<Paragraph>(singleRun);
   }
 
   static fxl::RefPtr<Paragraph> Create(
@@ -47,6 +58,13 @@ class Paragraph : public fxl::RefCountedThreadSafe<Paragraph>,
   bool didExceedMaxLines();
 
   void layout(double width);
+
+  // Lays out the paragraph on the text layout thread and then invokes
+  // |callback| with the paragraph on the UI thread. Until the layout is done,
+  // the methods that read or paint the paragraph block. The layout is skipped
+  // if |layout| or |layoutAsync| is called again before it starts, so that the
+  // latest layout wins. Returns an error message on failure, null on success.
+  Dart_Handle layoutAsync(double width, Dart_Handle callback);
   void paint(Canvas* canvas, double x, double y);
 
   std::vector<TextBox> getRectsForRange(unsigned start, unsigned end);
@@ -62,7 +80,22 @@ class Paragraph : public fxl::RefCountedThreadSafe<Paragraph>,
  private:
   std::unique_ptr<ParagraphImpl> m_paragraphImpl;
 
-  explicit Paragraph(PassOwnPtr<RenderView> renderView);
+  // Held while the paragraph is laid out. Guards |m_layoutGeneration|, which
+  // counts the layouts requested so far, and |m_pendingLayouts|, which counts
+  // the layouts posted to the text layout thread that have not finished yet.
+  // |m_layoutDone| is signaled when the last of them finishes.
+  std::mutex m_layoutMutex;
+  std::condition_variable m_layoutDone;
+  uint64_t m_layoutGeneration = 0;
+  size_t m_pendingLayouts = 0;
+
+  // Blocks until the layouts posted by |layoutAsync| have finished.
+  void waitForPendingLayouts();
+
+  Paragraph(PassOwnPtr<RenderView> renderView,
+            PassOwnPtr<RenderArena> renderArena);
+
+  explicit Paragraph(PassOwnPtr<SingleRunParagraph> singleRun);
 
   explicit Paragraph(std::unique_ptr<txt::Paragraph> paragraph);
 
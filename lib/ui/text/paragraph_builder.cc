@@ -4,6 +4,8 @@
 
 #include "flutter/lib/ui/text/paragraph_builder.h"
 
+#include <utility>
+
 #include "flutter/common/settings.h"
 #include "flutter/common/threads.h"
 #include "flutter/lib/ui/text/font_collection.h"
@@ -209,7 +211,10 @@ ParagraphBuilder::ParagraphBuilder(tonic::Int32List& encoded,
                                    const std::string& fontFamily,
                                    double fontSize,
                                    double lineHeight,
-                                   const std::u16string& ellipsis) {
+                                   const std::u16string& ellipsis)
+    : m_renderParagraph(nullptr),
+      m_currentRenderObject(nullptr),
+      m_singleRunSpanPopped(false) {
   if (!Settings::Get().using_blink) {
     int32_t mask = encoded[0];
     txt::ParagraphStyle style;
@@ -245,28 +250,22 @@ ParagraphBuilder::ParagraphBuilder(tonic::Int32List& encoded,
     m_paragraphBuilder = std::make_unique<txt::ParagraphBuilder>(
         style, blink::FontCollection::ForProcess().GetFontCollection());
   } else {
-    // Blink version.
-    createRenderView();
-
-    RefPtr<RenderStyle> paragraphStyle =
-        decodeParagraphStyle(m_renderView->style(), encoded, fontFamily,
+    // Blink version. The render tree is only created once the paragraph turns
+    // out to be more than a single run of text.
+    m_singleRun = adoptPtr(new SingleRunParagraph);
+    m_singleRun->viewStyle = createViewStyle();
+    m_singleRun->paragraphStyle =
+        decodeParagraphStyle(m_singleRun->viewStyle.get(), encoded, fontFamily,
                              fontSize, lineHeight, ellipsis);
     encoded.Release();
-
-    m_renderParagraph = new RenderParagraph();
-    m_renderParagraph->setStyle(paragraphStyle.release());
-
-    m_currentRenderObject = m_renderParagraph;
-    m_renderView->addChild(m_currentRenderObject);
   }
 
 }  // namespace blink
 
 ParagraphBuilder::~ParagraphBuilder() {
-  if (m_renderView) {
-    RenderView* renderView = m_renderView.leakPtr();
-    Threads::UI()->PostTask([renderView]() { renderView->destroy(); });
-  }
+  if (m_renderView)
+    destroyRenderViewOnUIThread(m_renderView.release(),
+                                m_renderArena.release());
 }
 
 void ParagraphBuilder::pushStyle(tonic::Int32List& encoded,
@@ -331,11 +330,17 @@ void ParagraphBuilder::pushStyle(tonic::Int32List& encoded,
       style.height = height;
     }
 
-    m_paragraphBuilder->PushStyle(style);
+    m_paragraphBuilder->PushStyle(std::move(style));
   } else {
     // Blink Version.
+    bool isSingleRunSpan =
+        m_singleRun && !m_singleRun->spanStyle && !m_singleRun->textStyle;
+    if (!isSingleRunSpan)
+      ensureRenderView();
+
     RefPtr<RenderStyle> style = RenderStyle::create();
-    style->inheritFrom(m_currentRenderObject->style());
+    style->inheritFrom(isSingleRunSpan ? m_singleRun->paragraphStyle.get()
+                                       : m_currentRenderObject->style());
 
     if (mask & tsColorMask)
       style->setColor(getColorFromARGB(encoded[tsColorIndex]));
@@ -400,6 +405,12 @@ void ParagraphBuilder::pushStyle(tonic::Int32List& encoded,
 
     encoded.Release();
 
+    if (isSingleRunSpan) {
+      m_singleRun->spanStyle = style.release();
+      return;
+    }
+
+    RenderArena::Scope arenaScope(m_renderArena.get());
     RenderObject* span = new RenderInline();
     span->setStyle(style.release());
     m_currentRenderObject->addChild(span);
@@ -412,6 +423,12 @@ void ParagraphBuilder::pop() {
     m_paragraphBuilder->Pop();
   } else {
     // Blink Version.
+    if (m_singleRun && m_singleRun->spanStyle && !m_singleRunSpanPopped) {
+      m_singleRunSpanPopped = true;
+      return;
+    }
+
+    ensureRenderView();
     if (m_currentRenderObject)
       m_currentRenderObject = m_currentRenderObject->parent();
   }
@@ -434,8 +451,20 @@ Dart_Handle ParagraphBuilder::addText(const std::u16string& text) {
     m_paragraphBuilder->AddText(text);
   } else {
     // Blink Version.
+    if (m_singleRun && !m_singleRun->textStyle && !m_singleRunSpanPopped) {
+      RefPtr<RenderStyle> style = RenderStyle::create();
+      style->inheritFrom(m_singleRun->spanStyle
+                             ? m_singleRun->spanStyle.get()
+                             : m_singleRun->paragraphStyle.get());
+      m_singleRun->textStyle = style.release();
+      m_singleRun->text = String(text_ptr, text.size());
+      return Dart_Null();
+    }
+
+    ensureRenderView();
     if (!m_currentRenderObject)
       return tonic::ToDart("paragraph has already been built");
+    RenderArena::Scope arenaScope(m_renderArena.get());
     RenderText* renderText =
         new RenderText(String(text_ptr, text.size()).impl());
     RefPtr<RenderStyle> style = RenderStyle::create();
@@ -448,23 +477,38 @@ Dart_Handle ParagraphBuilder::addText(const std::u16string& text) {
 }
 
 fxl::RefPtr<Paragraph> ParagraphBuilder::build() {
-  m_currentRenderObject = nullptr;
   if (!Settings::Get().using_blink) {
+    m_currentRenderObject = nullptr;
     return Paragraph::Create(m_paragraphBuilder->Build());
   } else {
-    return Paragraph::Create(m_renderView.release());
+    if (m_singleRun && m_singleRun->canLayoutWithoutRenderTree())
+      return Paragraph::Create(m_singleRun.release());
+    ensureRenderView();
+    m_currentRenderObject = nullptr;
+    return Paragraph::Create(m_renderView.release(), m_renderArena.release());
   }
 }
 
-void ParagraphBuilder::createRenderView() {
+PassRefPtr<RenderStyle> ParagraphBuilder::createViewStyle() {
   RefPtr<RenderStyle> style = RenderStyle::create();
   style->setRTLOrdering(LogicalOrder);
   style->setZIndex(0);
   style->setUserModify(READ_ONLY);
   createFontForDocument(style.get());
+  return style.release();
+}
 
-  m_renderView = adoptPtr(new RenderView());
-  m_renderView->setStyle(style.release());
+void ParagraphBuilder::ensureRenderView() {
+  if (!m_singleRun)
+    return;
+
+  m_renderArena = adoptPtr(new RenderArena);
+  m_renderView = m_singleRun->createRenderView(m_renderArena.get());
+  m_renderParagraph = m_renderView->firstChild();
+  m_currentRenderObject = m_renderParagraph;
+  if (m_singleRun->spanStyle && !m_singleRunSpanPopped)
+    m_currentRenderObject = m_renderParagraph->slowFirstChild();
+  m_singleRun.clear();
 }
 
 }  // namespace blink
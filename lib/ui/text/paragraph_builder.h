@@ -57,11 +57,18 @@ class ParagraphBuilder : public fxl::RefCountedThreadSafe<ParagraphBuilder>,
                             double lineHeight,
                             const std::u16string& ellipsis);
 
-  void createRenderView();
+  PassRefPtr<RenderStyle> createViewStyle();
+
+  // Creates the render tree for the styles and text added so far, once the
+  // paragraph is no longer a single run of text.
+  void ensureRenderView();
 
   OwnPtr<RenderView> m_renderView;
+  OwnPtr<RenderArena> m_renderArena;
   RenderObject* m_renderParagraph;
   RenderObject* m_currentRenderObject;
+  OwnPtr<SingleRunParagraph> m_singleRun;
+  bool m_singleRunSpanPopped;
   std::unique_ptr<txt::ParagraphBuilder> m_paragraphBuilder;
 };
 
@@ -30,6 +30,10 @@ class ParagraphImpl {
 
   virtual void layout(double width) = 0;
 
+  // Whether |layout| may be called on a thread other than the UI thread. All
+  // other methods must then wait for a layout that is in progress.
+  virtual bool canLayoutOffThread() = 0;
+
   virtual void paint(Canvas* canvas, double x, double y) = 0;
 
   virtual std::vector<TextBox> getRectsForRange(unsigned start,
@@ -8,6 +8,7 @@
 #include "flutter/lib/ui/text/paragraph.h"
 #include "flutter/lib/ui/text/paragraph_impl.h"
 #include "flutter/sky/engine/core/rendering/PaintInfo.h"
+#include "flutter/sky/engine/core/rendering/RenderInline.h"
 #include "flutter/sky/engine/core/rendering/RenderParagraph.h"
 #include "flutter/sky/engine/core/rendering/RenderText.h"
 #include "flutter/sky/engine/core/rendering/style/RenderStyle.h"
@@ -20,47 +21,181 @@
 #include "lib/tonic/dart_binding_macros.h"
 #include "lib/tonic/dart_library_natives.h"
 
+#include <unicode/uchar.h>
+#include <unicode/utf16.h>
+
 using tonic::ToDart;
 
 namespace blink {
+namespace {
 
-ParagraphImplBlink::ParagraphImplBlink(PassOwnPtr<RenderView> renderView)
-    : m_renderView(renderView) {}
+const size_t maxRecentLayoutMetrics = 4;
 
-ParagraphImplBlink::~ParagraphImplBlink() {
-  if (m_renderView) {
-    RenderView* renderView = m_renderView.leakPtr();
-    Threads::UI()->PostTask([renderView]() { renderView->destroy(); });
+}  // namespace
+
+bool SingleRunParagraph::canLayoutWithoutRenderTree() const {
+  if (!textStyle || text.isEmpty())
+    return false;
+
+  // The line box is only as simple as the text box when the root inline box
+  // has the same font and line height as the text.
+  if (paragraphStyle->direction() != LTR ||
+      paragraphStyle->fontDescription() != textStyle->fontDescription() ||
+      paragraphStyle->lineHeight() != textStyle->lineHeight() ||
+      textStyle->textDecorationsInEffect() != TextDecorationNone)
+    return false;
+
+  // Trailing spaces hang at the end of the line, which changes the position of
+  // aligned text.
+  ETextAlign align = paragraphStyle->textAlign();
+  if (align != LEFT && align != TASTART && align != JUSTIFY &&
+      isSpaceOrNewline(text[text.length() - 1]))
+    return false;
+
+  // Line breaks, tabs and right-to-left text need the line breaker and the
+  // bidi resolver.
+  unsigned length = text.length();
+  for (unsigned i = 0; i < length;) {
+    UChar32 character;
+    U16_NEXT(text, i, length, character);
+    switch (u_charDirection(character)) {
+      case U_BLOCK_SEPARATOR:
+      case U_SEGMENT_SEPARATOR:
+      case U_RIGHT_TO_LEFT:
+      case U_RIGHT_TO_LEFT_ARABIC:
+      case U_ARABIC_NUMBER:
+      case U_RIGHT_TO_LEFT_EMBEDDING:
+      case U_RIGHT_TO_LEFT_OVERRIDE:
+      case U_RIGHT_TO_LEFT_ISOLATE:
+        return false;
+      default:
+        break;
+    }
   }
+
+  return true;
+}
+
+PassOwnPtr<RenderView> SingleRunParagraph::createRenderView(
+    RenderArena* arena) const {
+  RenderArena::Scope arenaScope(arena);
+
+  OwnPtr<RenderView> renderView = adoptPtr(new RenderView());
+  renderView->setStyle(viewStyle);
+
+  RenderObject* parent = new RenderParagraph();
+  parent->setStyle(paragraphStyle);
+  renderView->addChild(parent);
+
+  if (spanStyle) {
+    RenderObject* span = new RenderInline();
+    span->setStyle(spanStyle);
+    parent->addChild(span);
+    parent = span;
+  }
+
+  if (textStyle) {
+    RenderText* renderText = new RenderText(text.impl());
+    renderText->setStyle(textStyle);
+    parent->addChild(renderText);
+  }
+
+  return renderView.release();
+}
+
+void destroyRenderViewOnUIThread(PassOwnPtr<RenderView> renderView,
+                                 PassOwnPtr<RenderArena> renderArena) {
+  RenderView* view = renderView.leakPtr();
+  RenderArena* arena = renderArena.leakPtr();
+  Threads::UI()->PostTask([view, arena]() {
+    {
+      RenderArena::Scope arenaScope(arena);
+      view->destroy();
+    }
+    delete arena;
+  });
+}
+
+ParagraphImplBlink::ParagraphImplBlink(PassOwnPtr<RenderView> renderView,
+                                       PassOwnPtr<RenderArena> renderArena)
+    : m_renderView(renderView),
+      m_renderArena(renderArena),
+      m_singleRunWidth(0),
+      m_renderViewWidth(-1),
+      m_maxWidth(0),
+      m_needsLayout(true) {}
+
+ParagraphImplBlink::ParagraphImplBlink(
+    PassOwnPtr<SingleRunParagraph> singleRun)
+    : m_singleRun(singleRun),
+      m_singleRunWidth(0),
+      m_renderViewWidth(-1),
+      m_maxWidth(0),
+      m_needsLayout(true) {
+  FontCachePurgePreventer fontCachePurgePreventer;
+  m_singleRunWidth =
+      m_singleRun->textStyle->font().width(TextRun(m_singleRun->text));
+}
+
+ParagraphImplBlink::~ParagraphImplBlink() {
+  if (m_renderView)
+    destroyRenderViewOnUIThread(m_renderView.release(),
+                                m_renderArena.release());
 }
 
 double ParagraphImplBlink::width() {
+  if (m_singleRun)
+    return m_maxWidth;
+  if (!m_needsLayout)
+    return m_layoutMetrics.width;
   return firstChildBox()->width();
 }
 
 double ParagraphImplBlink::height() {
+  if (m_singleRun)
+    return singleRunLineHeight();
+  if (!m_needsLayout)
+    return m_layoutMetrics.height;
   return firstChildBox()->height();
 }
 
 double ParagraphImplBlink::minIntrinsicWidth() {
+  // The narrowest width needs the line breaker.
+  ensureRenderView();
   return firstChildBox()->minPreferredLogicalWidth();
 }
 
 double ParagraphImplBlink::maxIntrinsicWidth() {
+  if (m_singleRun)
+    return LayoutUnit::fromFloatCeil(m_singleRunWidth);
   return firstChildBox()->maxPreferredLogicalWidth();
 }
 
 double ParagraphImplBlink::alphabeticBaseline() {
+  if (m_singleRun)
+    return singleRunLineTop() + singleRunFontMetrics().ascent();
+  if (!m_needsLayout)
+    return m_layoutMetrics.alphabeticBaseline;
   return firstChildBox()->firstLineBoxBaseline(
       FontBaselineOrAuto(AlphabeticBaseline));
 }
 
 double ParagraphImplBlink::ideographicBaseline() {
+  if (m_singleRun) {
+    return singleRunLineTop() +
+           singleRunFontMetrics().ascent(IdeographicBaseline);
+  }
+  if (!m_needsLayout)
+    return m_layoutMetrics.ideographicBaseline;
   return firstChildBox()->firstLineBoxBaseline(
       FontBaselineOrAuto(IdeographicBaseline));
 }
 
 bool ParagraphImplBlink::didExceedMaxLines() {
+  if (m_singleRun)
+    return false;
+  if (!m_needsLayout)
+    return m_layoutMetrics.didExceedMaxLines;
   RenderBox* box = firstChildBox();
   ASSERT(box->isRenderParagraph());
   RenderParagraph* paragraph = static_cast<RenderParagraph*>(box);
@@ -68,11 +203,87 @@ bool ParagraphImplBlink::didExceedMaxLines() {
 }
 
 void ParagraphImplBlink::layout(double width) {
+  m_maxWidth = LayoutUnit(width);  // Handles infinity properly.
+  m_needsLayout = false;
+
+  // A single run that does not fit on one line is broken into lines by
+  // RenderParagraph.
+  if (m_singleRun && LayoutUnit::fromFloatCeil(m_singleRunWidth) > m_maxWidth)
+    ensureRenderView();
+
+  if (!m_singleRun)
+    updateLayoutMetrics();
+}
+
+void ParagraphImplBlink::updateLayoutMetrics() {
+  for (const LayoutMetrics& metrics : m_recentLayoutMetrics) {
+    if (metrics.maxWidth == m_maxWidth) {
+      m_layoutMetrics = metrics;
+      return;
+    }
+  }
+
+  layoutRenderView();
+
+  RenderBox* box = firstChildBox();
+  ASSERT(box->isRenderParagraph());
+  m_layoutMetrics.maxWidth = m_maxWidth;
+  m_layoutMetrics.width = box->width();
+  m_layoutMetrics.height = box->height();
+  m_layoutMetrics.alphabeticBaseline =
+      box->firstLineBoxBaseline(FontBaselineOrAuto(AlphabeticBaseline));
+  m_layoutMetrics.ideographicBaseline =
+      box->firstLineBoxBaseline(FontBaselineOrAuto(IdeographicBaseline));
+  m_layoutMetrics.didExceedMaxLines =
+      static_cast<RenderParagraph*>(box)->didExceedMaxLines();
+
+  if (m_recentLayoutMetrics.size() == maxRecentLayoutMetrics)
+    m_recentLayoutMetrics.remove(0);
+  m_recentLayoutMetrics.append(m_layoutMetrics);
+}
+
+void ParagraphImplBlink::ensureRenderViewLayout() {
+  if (!m_needsLayout && m_renderViewWidth != m_maxWidth)
+    layoutRenderView();
+}
+
+void ParagraphImplBlink::layoutRenderView() {
   FontCachePurgePreventer fontCachePurgePreventer;
+  RenderArena::Scope arenaScope(m_renderArena.get());
 
-  int maxWidth = LayoutUnit(width);  // Handles infinity properly.
-  m_renderView->setFrameViewSize(IntSize(maxWidth, intMaxForLayoutUnit));
+  m_renderView->setFrameViewSize(IntSize(m_maxWidth, intMaxForLayoutUnit));
   m_renderView->layout();
+  m_renderViewWidth = m_maxWidth;
+}
+
+void ParagraphImplBlink::ensureRenderView() {
+  if (!m_singleRun)
+    return;
+
+  m_renderArena = adoptPtr(new RenderArena);
+  m_renderView = m_singleRun->createRenderView(m_renderArena.get());
+  m_singleRun.clear();
+  m_singleRunBlob = nullptr;
+
+  if (!m_needsLayout)
+    updateLayoutMetrics();
+}
+
+float ParagraphImplBlink::singleRunOffset() const {
+  switch (m_singleRun->paragraphStyle->textAlign()) {
+    case RIGHT:
+    case TAEND:
+      return m_maxWidth - m_singleRunWidth;
+    case CENTER:
+      return (m_maxWidth - m_singleRunWidth) / 2;
+    default:
+      return 0;
+  }
+}
+
+bool ParagraphImplBlink::canLayoutOffThread() {
+  // Blink render objects may only be used on the UI thread.
+  return false;
 }
 
 void ParagraphImplBlink::paint(Canvas* canvas, double x, double y) {
@@ -82,6 +293,27 @@ void ParagraphImplBlink::paint(Canvas* canvas, double x, double y) {
 
   FontCachePurgePreventer fontCachePurgePreventer;
 
+  if (m_singleRun) {
+    RenderStyle* style = m_singleRun->textStyle.get();
+    const FontMetrics& fontMetrics = singleRunFontMetrics();
+    float left = singleRunOffset();
+    float top = singleRunLineTop();
+
+    TextRun run(m_singleRun->text);
+    TextRunPaintInfo runInfo(run);
+    runInfo.bounds =
+        FloatRect(left, top, m_singleRunWidth, fontMetrics.height());
+    runInfo.cachedTextBlob = &m_singleRunBlob;
+
+    GraphicsContext context(skCanvas);
+    context.setFillColor(style->resolveColor(style->textFillColor()));
+    context.drawText(style->font(), runInfo,
+                     FloatPoint(x + left, y + top + fontMetrics.ascent()));
+    return;
+  }
+
+  ensureRenderViewLayout();
+
   // Very simplified painting to allow painting an arbitrary (layer-less)
   // subtree.
   RenderBox* box = firstChildBox();
@@ -104,6 +336,9 @@ std::vector<TextBox> ParagraphImplBlink::getRectsForRange(unsigned start,
   if (end <= start || start == end)
     return std::vector<TextBox>();
 
+  ensureRenderView();
+  ensureRenderViewLayout();
+
   unsigned offset = 0;
   std::vector<TextBox> boxes;
   for (RenderObject* object = m_renderView.get(); object;
@@ -143,6 +378,9 @@ int ParagraphImplBlink::absoluteOffsetForPosition(
 }
 
 Dart_Handle ParagraphImplBlink::getPositionForOffset(double dx, double dy) {
+  ensureRenderView();
+  ensureRenderViewLayout();
+
   LayoutPoint point(dx, dy);
   PositionWithAffinity position = m_renderView->positionForPoint(point);
   Dart_Handle result = Dart_NewListOf(Dart_CoreType_Int, 2);
@@ -155,12 +393,16 @@ Dart_Handle ParagraphImplBlink::getWordBoundary(unsigned offset) {
   String text;
   int start = 0, end = 0;
 
-  for (RenderObject* object = m_renderView.get(); object;
-       object = object->nextInPreOrder()) {
-    if (!object->isText())
-      continue;
-    RenderText* renderText = toRenderText(object);
-    text.append(renderText->text());
+  if (m_singleRun) {
+    text = m_singleRun->text;
+  } else {
+    for (RenderObject* object = m_renderView.get(); object;
+         object = object->nextInPreOrder()) {
+      if (!object->isText())
+        continue;
+      RenderText* renderText = toRenderText(object);
+      text.append(renderText->text());
+    }
   }
 
   TextBreakIterator* it = wordBreakIterator(text, 0, text.length());
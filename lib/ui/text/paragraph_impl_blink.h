@@ -8,16 +8,49 @@
 #include "flutter/lib/ui/painting/canvas.h"
 #include "flutter/lib/ui/text/paragraph_impl.h"
 #include "flutter/lib/ui/text/text_box.h"
+#include "flutter/sky/engine/core/rendering/RenderArena.h"
 #include "flutter/sky/engine/core/rendering/RenderView.h"
+#include "flutter/sky/engine/core/rendering/style/RenderStyle.h"
+#include "flutter/sky/engine/platform/fonts/TextBlob.h"
+#include "flutter/sky/engine/wtf/Vector.h"
+#include "flutter/sky/engine/wtf/text/WTFString.h"
 #include "flutter/third_party/txt/src/txt/paragraph.h"
 
 namespace blink {
 
+// The styles and text of a paragraph that consists of a single run of text,
+// optionally within a single pushed style. While such a paragraph fits on one
+// line, it is laid out and painted directly through its Font instead of
+// through a render tree.
+struct SingleRunParagraph {
+  RefPtr<RenderStyle> viewStyle;
+  RefPtr<RenderStyle> paragraphStyle;
+  // Null if the text was not added within a pushed style.
+  RefPtr<RenderStyle> spanStyle;
+  // Null until the text is added.
+  RefPtr<RenderStyle> textStyle;
+  String text;
+
+  // Whether the text and styles can be laid out without a render tree, as long
+  // as the text fits on one line.
+  bool canLayoutWithoutRenderTree() const;
+
+  // Builds the render tree that RenderParagraph lays out in |arena|.
+  PassOwnPtr<RenderView> createRenderView(RenderArena* arena) const;
+};
+
+// Destroys a render tree and then the arena that holds it in a task on the UI
+// thread.
+void destroyRenderViewOnUIThread(PassOwnPtr<RenderView> renderView,
+                                 PassOwnPtr<RenderArena> renderArena);
+
 class ParagraphImplBlink : public ParagraphImpl {
  public:
   ~ParagraphImplBlink() override;
 
-  explicit ParagraphImplBlink(PassOwnPtr<RenderView> renderView);
+  ParagraphImplBlink(PassOwnPtr<RenderView> renderView,
+                     PassOwnPtr<RenderArena> renderArena);
+  explicit ParagraphImplBlink(PassOwnPtr<SingleRunParagraph> singleRun);
 
   double width() override;
   double height() override;
@@ -28,6 +61,7 @@ class ParagraphImplBlink : public ParagraphImpl {
   bool didExceedMaxLines() override;
 
   void layout(double width) override;
+  bool canLayoutOffThread() override;
   void paint(Canvas* canvas, double x, double y) override;
 
   std::vector<TextBox> getRectsForRange(unsigned start, unsigned end) override;
@@ -41,7 +75,56 @@ class ParagraphImplBlink : public ParagraphImpl {
 
   int absoluteOffsetForPosition(const PositionWithAffinity& position);
 
+  // Replaces the single run with a render tree, laid out at the last width if
+  // the paragraph has been laid out.
+  void ensureRenderView();
+
+  // Sets the metrics for the last width, from an earlier layout at that width
+  // if there is one or else by laying out the render tree.
+  void updateLayoutMetrics();
+
+  // Lays out the render tree at the last width if it was laid out at another
+  // width since. Needed before painting or hit testing the render tree.
+  void ensureRenderViewLayout();
+  void layoutRenderView();
+
+  const FontMetrics& singleRunFontMetrics() const {
+    return m_singleRun->paragraphStyle->fontMetrics();
+  }
+  int singleRunLineHeight() const {
+    return m_singleRun->paragraphStyle->computedLineHeight();
+  }
+  int singleRunLineTop() const {
+    return (singleRunLineHeight() - singleRunFontMetrics().height()) / 2;
+  }
+  float singleRunOffset() const;
+
   OwnPtr<RenderView> m_renderView;
+  OwnPtr<RenderArena> m_renderArena;
+
+  // Null once the paragraph uses a render tree.
+  OwnPtr<SingleRunParagraph> m_singleRun;
+  float m_singleRunWidth;
+  TextBlobPtr m_singleRunBlob;
+
+  // The metrics of a layout of the render tree. The framework often lays out
+  // a paragraph at the same few widths, e.g. at the maximum width and then at
+  // its intrinsic width, so the metrics of recent layouts are kept.
+  struct LayoutMetrics {
+    int maxWidth;
+    double width;
+    double height;
+    double alphabeticBaseline;
+    double ideographicBaseline;
+    bool didExceedMaxLines;
+  };
+
+  Vector<LayoutMetrics> m_recentLayoutMetrics;
+  LayoutMetrics m_layoutMetrics;
+  int m_renderViewWidth;
+
+  int m_maxWidth;
+  bool m_needsLayout;
 };
 
 }  // namespace blink
@@ -22,50 +22,66 @@ ParagraphImplTxt::ParagraphImplTxt(std::unique_ptr<txt::Paragraph> paragraph)
 ParagraphImplTxt::~ParagraphImplTxt() {}
 
 double ParagraphImplTxt::width() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   return m_paragraph->GetMaxWidth();
 }
 
 double ParagraphImplTxt::height() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   return m_paragraph->GetHeight();
 }
 
 double ParagraphImplTxt::minIntrinsicWidth() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   return m_paragraph->GetMinIntrinsicWidth();
 }
 
 double ParagraphImplTxt::maxIntrinsicWidth() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   return m_paragraph->GetMaxIntrinsicWidth();
 }
 
 double ParagraphImplTxt::alphabeticBaseline() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   return m_paragraph->GetAlphabeticBaseline();
 }
 
 double ParagraphImplTxt::ideographicBaseline() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   return m_paragraph->GetIdeographicBaseline();
 }
 
 bool ParagraphImplTxt::didExceedMaxLines() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   return m_paragraph->DidExceedMaxLines();
 }
 
 void ParagraphImplTxt::layout(double width) {
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_width = width;
   m_paragraph->Layout(width);
 }
 
+bool ParagraphImplTxt::canLayoutOffThread() {
+  return true;
+}
+
 void ParagraphImplTxt::paint(Canvas* canvas, double x, double y) {
   SkCanvas* sk_canvas = canvas->canvas();
   if (!sk_canvas)
     return;
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_paragraph->Paint(sk_canvas, x, y);
 }
 
 std::vector<TextBox> ParagraphImplTxt::getRectsForRange(unsigned start,
                                                         unsigned end) {
   std::vector<TextBox> result;
-  std::vector<txt::Paragraph::TextBox> boxes =
-      m_paragraph->GetRectsForRange(start, end);
+  std::vector<txt::Paragraph::TextBox> boxes;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    boxes = m_paragraph->GetRectsForRange(start, end);
+  }
   for (const txt::Paragraph::TextBox& box : boxes) {
     result.emplace_back(box.rect,
                         static_cast<blink::TextDirection>(box.direction));
@@ -74,16 +90,21 @@ std::vector<TextBox> ParagraphImplTxt::getRectsForRange(unsigned start,
 }
 
 Dart_Handle ParagraphImplTxt::getPositionForOffset(double dx, double dy) {
+  txt::Paragraph::PositionWithAffinity pos = [&]() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_paragraph->GetGlyphPositionAtCoordinate(dx, dy);
+  }();
   Dart_Handle result = Dart_NewListOf(Dart_CoreType_Int, 2);
-  txt::Paragraph::PositionWithAffinity pos =
-      m_paragraph->GetGlyphPositionAtCoordinate(dx, dy);
   Dart_ListSetAt(result, 0, ToDart(pos.position));
   Dart_ListSetAt(result, 1, ToDart(static_cast<int>(pos.affinity)));
   return result;
 }
 
 Dart_Handle ParagraphImplTxt::getWordBoundary(unsigned offset) {
-  txt::Paragraph::Range<size_t> point = m_paragraph->GetWordBoundary(offset);
+  txt::Paragraph::Range<size_t> point = [&]() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_paragraph->GetWordBoundary(offset);
+  }();
   Dart_Handle result = Dart_NewListOf(Dart_CoreType_Int, 2);
   Dart_ListSetAt(result, 0, ToDart(point.start));
   Dart_ListSetAt(result, 1, ToDart(point.end));
@@ -5,6 +5,8 @@
 #ifndef FLUTTER_LIB_UI_TEXT_PARAGRAPH_IMPL_TXT_H_
 #define FLUTTER_LIB_UI_TEXT_PARAGRAPH_IMPL_TXT_H_
 
+#include <mutex>
+
 #include "flutter/lib/ui/painting/canvas.h"
 #include "flutter/lib/ui/text/paragraph_impl.h"
 #include "flutter/lib/ui/text/paragraph_impl_blink.h"
@@ -28,6 +30,7 @@ class ParagraphImplTxt : public ParagraphImpl {
   bool didExceedMaxLines() override;
 
   void layout(double width) override;
+  bool canLayoutOffThread() override;
   void paint(Canvas* canvas, double x, double y) override;
 
   std::vector<TextBox> getRectsForRange(unsigned start, unsigned end) override;
@@ -35,6 +38,9 @@ class ParagraphImplTxt : public ParagraphImpl {
   Dart_Handle getWordBoundary(unsigned offset) override;
 
  private:
+  // Held while the paragraph is laid out, which may happen on the text layout
+  // thread, and while the results of the layout are read.
+  std::mutex m_mutex;
   std::unique_ptr<txt::Paragraph> m_paragraph;
   double m_width = -1.0;
 };
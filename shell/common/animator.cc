@@ -4,7 +4,10 @@
 
 #include "flutter/shell/common/animator.h"
 
+#include "flutter/common/settings.h"
 #include "flutter/common/threads.h"
+#include "flutter/fml/message_loop.h"
+#include "flutter/fml/task_runner.h"
 #include "flutter/fml/trace_event.h"
 #include "lib/fxl/time/stopwatch.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
@@ -19,7 +22,11 @@ Animator::Animator(fml::WeakPtr<Rasterizer> rasterizer,
       engine_(engine),
       last_begin_frame_time_(),
       dart_frame_deadline_(0),
-      layer_tree_pipeline_(fxl::MakeRefCounted<LayerTreePipeline>(2)),
+      layer_tree_pipeline_(fxl::MakeRefCounted<LayerTreePipeline>(
+          2,
+          blink::Settings::Get().latest_frame_wins
+              ? flutter::PipelineMode::ReplacePending
+              : flutter::PipelineMode::Queue)),
       pending_frame_semaphore_(1),
       frame_number_(1),
       paused_(false),
@@ -102,6 +109,11 @@ void Animator::BeginFrame(fxl::TimePoint frame_start_time,
     // or I/O. Allow the Dart VM 100 ms.
     engine_->NotifyIdle(dart_frame_deadline_ + 100000);
   }
+
+  // Idle tasks may use the time left until the next frame is due, or any time
+  // at all if there is no next frame.
+  fml::MessageLoop::GetCurrent().SetIdleDeadline(
+      frame_scheduled_ ? frame_target_time : fxl::TimePoint::Max());
 }
 
 void Animator::Render(std::unique_ptr<flow::LayerTree> layer_tree) {
@@ -120,15 +132,18 @@ void Animator::Render(std::unique_ptr<flow::LayerTree> layer_tree) {
   // Commit the pending continuation.
   producer_continuation_.Complete(std::move(layer_tree));
 
-  blink::Threads::Gpu()->PostTask([
-    rasterizer = rasterizer_, pipeline = layer_tree_pipeline_,
-    frame_id = FrameParity()
-  ]() {
-    if (!rasterizer.get())
-      return;
-    TRACE_EVENT2("flutter", "GPU Workload", "mode", "basic", "frame", frame_id);
-    rasterizer->Draw(pipeline);
-  });
+  blink::Threads::PostGpuTask(
+      [
+        rasterizer = rasterizer_, pipeline = layer_tree_pipeline_,
+        frame_id = FrameParity()
+      ]() {
+        if (!rasterizer.get())
+          return;
+        TRACE_EVENT2("flutter", "GPU Workload", "mode", "basic", "frame",
+                     frame_id);
+        rasterizer->Draw(pipeline);
+      },
+      fml::TaskPriority::kFrameCritical);
 }
 
 bool Animator::CanReuseLastLayerTree() {
@@ -137,10 +152,15 @@ bool Animator::CanReuseLastLayerTree() {
 
 void Animator::DrawLastLayerTree() {
   pending_frame_semaphore_.Signal();
-  blink::Threads::Gpu()->PostTask([rasterizer = rasterizer_]() {
-    if (rasterizer.get())
-      rasterizer->DrawLastLayerTree();
-  });
+  blink::Threads::PostGpuTask(
+      [rasterizer = rasterizer_]() {
+        if (rasterizer.get())
+          rasterizer->DrawLastLayerTree();
+      },
+      fml::TaskPriority::kFrameCritical);
+
+  // No new frame is being produced.
+  fml::MessageLoop::GetCurrent().SetIdleDeadline(fxl::TimePoint::Max());
 }
 
 void Animator::RequestFrame(bool regenerate_layer_tree) {
@@ -157,6 +177,10 @@ void Animator::RequestFrame(bool regenerate_layer_tree) {
     return;
   }
 
+  // There is no telling how much time is left until the frame is due. Hold
+  // idle tasks back until it has been produced.
+  fml::MessageLoop::GetCurrent().SetIdleDeadline(fxl::TimePoint::Min());
+
   // The AwaitVSync is going to call us back at the next VSync. However, we want
   // to be reasonably certain that the UI thread is not in the middle of a
   // particularly expensive callout. We post the AwaitVSync to run right after
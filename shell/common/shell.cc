@@ -5,8 +5,11 @@
 #include "flutter/shell/common/shell.h"
 
 #include <fcntl.h>
+#include <algorithm>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "flutter/common/settings.h"
@@ -57,6 +60,7 @@ Shell::Shell(fxl::CommandLine command_line)
   gpu_thread_.reset(new fml::Thread("gpu_thread"));
   ui_thread_.reset(new fml::Thread("ui_thread"));
   io_thread_.reset(new fml::Thread("io_thread"));
+  text_layout_thread_.reset(new fml::Thread("text_layout_thread"));
 
   // Since we are not using fml::Thread, we need to initialize the message loop
   // manually.
@@ -65,6 +69,8 @@ Shell::Shell(fxl::CommandLine command_line)
                          gpu_thread_->GetTaskRunner(),
                          ui_thread_->GetTaskRunner(),
                          io_thread_->GetTaskRunner());
+  threads.set_image_decode(CreateImageDecodeThreads());
+  threads.set_text_layout(text_layout_thread_->GetTaskRunner());
   blink::Threads::Set(threads);
 
   blink::Threads::Gpu()->PostTask([this]() { InitGpuThread(); });
@@ -76,6 +82,20 @@ Shell::Shell(fxl::CommandLine command_line)
 
 Shell::~Shell() {}
 
+std::vector<fxl::RefPtr<fxl::TaskRunner>> Shell::CreateImageDecodeThreads() {
+  // Leave a core each for the UI and GPU threads.
+  const int cores = std::thread::hardware_concurrency();
+  const int count = std::max(1, std::min(cores - 2, kMaxImageDecodeThreads));
+
+  std::vector<fxl::RefPtr<fxl::TaskRunner>> task_runners;
+  for (int i = 0; i < count; i++) {
+    image_decode_threads_.emplace_back(
+        new fml::Thread("image_decode_" + std::to_string(i + 1)));
+    task_runners.push_back(image_decode_threads_.back()->GetTaskRunner());
+  }
+  return task_runners;
+}
+
 void Shell::InitStandalone(fxl::CommandLine command_line,
                            std::string icu_data_path,
                            std::string application_library_path,
@@ -123,6 +143,18 @@ void Shell::InitStandalone(fxl::CommandLine command_line,
   settings.using_blink =
       command_line.HasOption(FlagForSwitch(Switch::EnableBlink));
 
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::RasterCacheMaxMegabytes))) {
+    if (!GetSwitchValue(command_line, Switch::RasterCacheMaxMegabytes,
+                        &settings.raster_cache_max_megabytes)) {
+      FXL_LOG(INFO) << "Raster cache budget specified was malformed. Will use "
+                       "the default budget.";
+    }
+  }
+
+  settings.latest_frame_wins =
+      command_line.HasOption(FlagForSwitch(Switch::LatestFrameWins));
+
   settings.endless_trace_buffer =
       command_line.HasOption(FlagForSwitch(Switch::EndlessTraceBuffer));
 
@@ -7,6 +7,7 @@
 
 #include <mutex>
 #include <unordered_set>
+#include <vector>
 
 #include "flutter/fml/thread.h"
 #include "flutter/shell/common/tracing_controller.h"
@@ -64,6 +65,8 @@ class Shell {
   std::unique_ptr<fml::Thread> gpu_thread_;
   std::unique_ptr<fml::Thread> ui_thread_;
   std::unique_ptr<fml::Thread> io_thread_;
+  std::vector<std::unique_ptr<fml::Thread>> image_decode_threads_;
+  std::unique_ptr<fml::Thread> text_layout_thread_;
   std::unique_ptr<fxl::ThreadChecker> gpu_thread_checker_;
   std::unique_ptr<fxl::ThreadChecker> ui_thread_checker_;
   TracingController tracing_controller_;
@@ -75,6 +78,10 @@ class Shell {
 
   Shell(fxl::CommandLine command_line);
 
+  static constexpr int kMaxImageDecodeThreads = 4;
+
+  std::vector<fxl::RefPtr<fxl::TaskRunner>> CreateImageDecodeThreads();
+
   void InitGpuThread();
 
   void InitUIThread();
@@ -11,7 +11,11 @@ namespace shell {
 
 SurfaceFrame::SurfaceFrame(sk_sp<SkSurface> surface,
                            SubmitCallback submit_callback)
-    : submitted_(false), surface_(surface), submit_callback_(submit_callback) {
+    : submitted_(false),
+      surface_(surface),
+      submit_callback_(submit_callback),
+      has_damage_(false),
+      damage_(SkRect::MakeEmpty()) {
   FXL_DCHECK(submit_callback_);
   if (surface_) {
     xform_canvas_ = SkCreateColorSpaceXformCanvas(surface_->getCanvas(),
@@ -47,6 +51,19 @@ sk_sp<SkSurface> SurfaceFrame::SkiaSurface() const {
   return surface_;
 }
 
+void SurfaceFrame::SetDamage(const SkRect& damage) {
+  has_damage_ = true;
+  damage_ = damage;
+}
+
+bool SurfaceFrame::GetDamage(SkRect* damage) const {
+  if (!has_damage_) {
+    return false;
+  }
+  *damage = damage_;
+  return true;
+}
+
 bool SurfaceFrame::PerformSubmit() {
   if (submit_callback_ == nullptr) {
     return false;
@@ -67,6 +84,10 @@ bool Surface::SupportsScaling() const {
   return false;
 }
 
+bool Surface::SupportsPartialRepaint() const {
+  return false;
+}
+
 double Surface::GetScale() const {
   return scale_;
 }
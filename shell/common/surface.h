@@ -30,11 +30,21 @@ class SurfaceFrame {
 
   sk_sp<SkSurface> SkiaSurface() const;
 
+  // Limits the area of the frame that was painted, in the coordinate space of
+  // its canvas. Surfaces that support partial repaint may present only this
+  // area. By default, the whole frame is presented.
+  void SetDamage(const SkRect& damage);
+
+  // Returns whether a damaged area was set, and if so sets |damage| to it.
+  bool GetDamage(SkRect* damage) const;
+
  private:
   bool submitted_;
   sk_sp<SkSurface> surface_;
   std::unique_ptr<SkCanvas> xform_canvas_;
   SubmitCallback submit_callback_;
+  bool has_damage_;
+  SkRect damage_;
 
   bool PerformSubmit();
 
@@ -55,6 +65,11 @@ class Surface {
 
   virtual bool SupportsScaling() const;
 
+  // Whether the contents of the previous frame are still present in the
+  // frames acquired from this surface so that only the damaged area needs to
+  // be repainted.
+  virtual bool SupportsPartialRepaint() const;
+
   double GetScale() const;
 
   void SetScale(double scale);
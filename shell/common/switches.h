@@ -66,6 +66,16 @@ DEF_SWITCH(SkiaDeterministicRendering,
 DEF_SWITCH(EnableBlink,
            "enable-blink",
            "Enable Blink as the text shaping library instead of libtxt.")
+DEF_SWITCH(RasterCacheMaxMegabytes,
+           "raster-cache-max-megabytes",
+           "The maximum number of megabytes held by images in the raster "
+           "cache. Least recently used images are evicted once the budget is "
+           "reached.")
+DEF_SWITCH(LatestFrameWins,
+           "latest-frame-wins",
+           "Replace frames the GPU thread has not started rasterizing yet with "
+           "newer frames instead of queueing them. Bounds the latency of a "
+           "frame to one frame interval when the GPU thread falls behind.")
 DEF_SWITCH(FLX, "flx", "Specify the FLX path.")
 DEF_SWITCH(FlutterAssetsDir,
            "flutter-assets-dir",
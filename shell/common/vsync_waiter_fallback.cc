@@ -5,6 +5,7 @@
 #include "flutter/shell/common/vsync_waiter_fallback.h"
 
 #include "flutter/common/threads.h"
+#include "flutter/fml/task_runner.h"
 #include "lib/fxl/logging.h"
 
 namespace shell {
@@ -35,7 +36,7 @@ void VsyncWaiterFallback::AsyncWaitForVsync(Callback callback) {
   fxl::TimePoint now = fxl::TimePoint::Now();
   fxl::TimePoint next = SnapToNextTick(now, phase_, interval);
 
-  blink::Threads::UI()->PostDelayedTask(
+  blink::Threads::PostUITaskForTime(
       [self = weak_factory_.GetWeakPtr()] {
         if (!self)
           return;
@@ -44,7 +45,7 @@ void VsyncWaiterFallback::AsyncWaitForVsync(Callback callback) {
         self->callback_ = Callback();
         callback(frame_time, frame_time + interval);
       },
-      next - now);
+      next, fml::TaskPriority::kFrameCritical);
 }
 
 }  // namespace shell
@@ -4,23 +4,59 @@
 
 #include "gpu_rasterizer.h"
 
+#include <algorithm>
 #include <string>
+#include <thread>
 #include <utility>
 
+#include "flutter/common/settings.h"
 #include "flutter/common/threads.h"
 #include "flutter/glue/trace_event.h"
 #include "flutter/shell/common/picture_serializer.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/shell.h"
 #include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkSurface.h"
 
 namespace shell {
 
 GPURasterizer::GPURasterizer(std::unique_ptr<flow::ProcessInfo> info)
-    : compositor_context_(std::move(info)), weak_factory_(this) {}
+    : compositor_context_(std::move(info)), weak_factory_(this) {
+  const uint32_t max_megabytes =
+      blink::Settings::Get().raster_cache_max_megabytes;
+  if (max_megabytes > 0) {
+    compositor_context_.raster_cache().SetMaxBytes(
+        static_cast<size_t>(max_megabytes) * 1024 * 1024);
+  }
+}
 
 GPURasterizer::~GPURasterizer() = default;
 
+static constexpr size_t kMaxRasterCacheWorkers = 3;
+
+void GPURasterizer::SetupRasterCacheWorkers() {
+  if (surface_ == nullptr || surface_->GetContext() != nullptr ||
+      !raster_cache_workers_.empty()) {
+    return;
+  }
+
+  // The UI and GPU threads are busy while the raster cache is populated, so
+  // leave a core for each of them.
+  const size_t cores = std::thread::hardware_concurrency();
+  const size_t worker_count =
+      std::min(cores > 2 ? cores - 2 : 0, kMaxRasterCacheWorkers);
+
+  std::vector<fxl::RefPtr<fxl::TaskRunner>> task_runners;
+  for (size_t i = 0; i < worker_count; i++) {
+    raster_cache_workers_.push_back(std::make_unique<fml::Thread>(
+        "raster_cache_worker_" + std::to_string(i + 1)));
+    task_runners.push_back(raster_cache_workers_.back()->GetTaskRunner());
+  }
+
+  compositor_context_.raster_cache().SetWorkerTaskRunners(
+      std::move(task_runners));
+}
+
 fml::WeakPtr<Rasterizer> GPURasterizer::GetWeakRasterizerPtr() {
   return weak_factory_.GetWeakPtr();
 }
@@ -29,7 +65,17 @@ void GPURasterizer::Setup(std::unique_ptr<Surface> surface,
                           fxl::Closure continuation,
                           fxl::AutoResetWaitableEvent* setup_completion_event) {
   surface_ = std::move(surface);
+  damage_context_.Reset();
   compositor_context_.OnGrContextCreated();
+  SetupRasterCacheWorkers();
+
+  // The software backend rasterizes pictures as they are drawn, so the draw
+  // times measured for the raster cache are the real cost of the pictures.
+  // The GPU backend only records GPU work while drawing.
+  compositor_context_.raster_cache().SetAdmissionPolicy(
+      surface_ != nullptr && surface_->GetContext() == nullptr
+          ? flow::RasterCache::AdmissionPolicy::kMeasuredCost
+          : flow::RasterCache::AdmissionPolicy::kOpCount);
 
   continuation();
 
@@ -56,6 +102,8 @@ void GPURasterizer::Clear(SkColor color, const SkISize& size) {
   canvas->clear(color);
 
   frame->Submit();
+
+  damage_context_.Reset();
 }
 
 void GPURasterizer::Teardown(
@@ -65,6 +113,8 @@ void GPURasterizer::Teardown(
     surface_.reset();
   }
   last_layer_tree_.reset();
+  last_backing_store_.reset();
+  damage_context_.Reset();
   teardown_completion_event->Signal();
 }
 
@@ -140,10 +190,39 @@ void GPURasterizer::DrawToSurface(flow::LayerTree& layer_tree) {
   auto compositor_frame =
       compositor_context_.AcquireFrame(surface_->GetContext(), canvas);
 
-  canvas->clear(SK_ColorBLACK);
+  if (!surface_->SupportsPartialRepaint()) {
+    canvas->clear(SK_ColorBLACK);
+
+    layer_tree.Raster(compositor_frame);
+
+    frame->Submit();
+    return;
+  }
+
+  // The contents of the previous frame are only reusable if they are in the
+  // backing store of this frame.
+  sk_sp<SkSurface> backing_store = frame->SkiaSurface();
+  if (backing_store != last_backing_store_) {
+    damage_context_.Reset();
+    last_backing_store_ = std::move(backing_store);
+  }
+
+  layer_tree.Preroll(compositor_frame);
 
-  layer_tree.Raster(compositor_frame);
+  damage_context_.BeginFrame(layer_tree.frame_size());
+  layer_tree.CollectDamage(&damage_context_);
+  const SkRect damage = damage_context_.ComputeDamage();
+
+  if (!damage.isEmpty()) {
+    TRACE_EVENT0("flutter", "GPURasterizer::PartialRepaint");
+    SkAutoCanvasRestore save(canvas, true);
+    canvas->clipRect(damage);
+    canvas->clear(SK_ColorBLACK);
+    layer_tree.Paint(compositor_frame, true);
+  }
 
+  // Only the damaged area has to be presented.
+  frame->SetDamage(damage);
   frame->Submit();
 }
 
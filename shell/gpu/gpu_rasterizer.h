@@ -5,10 +5,16 @@
 #ifndef SHELL_GPU_DIRECT_GPU_RASTERIZER_H_
 #define SHELL_GPU_DIRECT_GPU_RASTERIZER_H_
 
+#include <memory>
+#include <vector>
+
 #include "flutter/flow/compositor_context.h"
+#include "flutter/flow/damage_context.h"
+#include "flutter/fml/thread.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "lib/fxl/memory/weak_ptr.h"
 #include "lib/fxl/synchronization/waitable_event.h"
+#include "third_party/skia/include/core/SkSurface.h"
 
 namespace shell {
 
@@ -48,12 +54,21 @@ class GPURasterizer : public Rasterizer {
   std::unique_ptr<Surface> surface_;
   flow::CompositorContext compositor_context_;
   std::unique_ptr<flow::LayerTree> last_layer_tree_;
+  // Contents of the frames drawn to the surface so far. Only used if the
+  // surface supports partial repaint.
+  flow::DamageContext damage_context_;
+  sk_sp<SkSurface> last_backing_store_;
+  // Threads the raster cache rasterizes pictures on when drawing without a
+  // GrContext. Created the first time such a surface is set up.
+  std::vector<std::unique_ptr<fml::Thread>> raster_cache_workers_;
   // A closure to be called when the underlaying surface presents a frame the
   // next time. NULL if there is no callback or the callback was set back to
   // NULL after being called.
   fxl::Closure nextFrameCallback_;
   fml::WeakPtrFactory<GPURasterizer> weak_factory_;
 
+  void SetupRasterCacheWorkers();
+
   void DoDraw(std::unique_ptr<flow::LayerTree> layer_tree);
 
   void DrawToSurface(flow::LayerTree& layer_tree);
@@ -22,6 +22,12 @@ bool GPUSurfaceSoftware::SupportsScaling() const {
   return true;
 }
 
+bool GPUSurfaceSoftware::SupportsPartialRepaint() const {
+  // Delegates hand out the same backing store for as long as the size does not
+  // change. The rasterizer detects a change in backing store by itself.
+  return true;
+}
+
 std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
     const SkISize& logical_size) {
   if (!IsValid()) {
@@ -51,7 +57,7 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
   canvas->scale(scale, scale);
 
   SurfaceFrame::SubmitCallback
-      on_submit = [self = weak_factory_.GetWeakPtr()](
+      on_submit = [self = weak_factory_.GetWeakPtr(), scale](
                       const SurfaceFrame& surface_frame, SkCanvas* canvas)
                       ->bool {
     // If the surface itself went away, there is nothing more to do.
@@ -61,7 +67,20 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
 
     canvas->flush();
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    sk_sp<SkSurface> backing_store = surface_frame.SkiaSurface();
+    SkIRect dirty =
+        SkIRect::MakeWH(backing_store->width(), backing_store->height());
+    SkRect damage;
+    if (surface_frame.GetDamage(&damage)) {
+      // The damage is in the coordinates of the scaled canvas.
+      SkMatrix::MakeScale(scale).mapRect(&damage);
+      if (!dirty.intersect(damage.roundOut())) {
+        dirty.setEmpty();
+      }
+    }
+
+    return self->delegate_->PresentBackingStore(std::move(backing_store),
+                                                dirty);
   };
 
   return std::make_unique<SurfaceFrame>(backing_store, on_submit);
@@ -15,7 +15,11 @@ namespace shell {
 class GPUSurfaceSoftwareDelegate {
  public:
   virtual sk_sp<SkSurface> AcquireBackingStore(const SkISize& size) = 0;
-  virtual bool PresentBackingStore(sk_sp<SkSurface> backing_store) = 0;
+
+  // Presents the backing store. Only the pixels in |dirty| changed since the
+  // last time it was presented. Delegates may present more than that.
+  virtual bool PresentBackingStore(sk_sp<SkSurface> backing_store,
+                                   const SkIRect& dirty) = 0;
 };
 
 class GPUSurfaceSoftware : public Surface {
@@ -32,6 +36,8 @@ class GPUSurfaceSoftware : public Surface {
 
   bool SupportsScaling() const override;
 
+  bool SupportsPartialRepaint() const override;
+
  private:
   GPUSurfaceSoftwareDelegate* delegate_;
 
@@ -89,19 +89,34 @@ sk_sp<SkSurface> AndroidSurfaceSoftware::AcquireBackingStore(
 }
 
 bool AndroidSurfaceSoftware::PresentBackingStore(
-    sk_sp<SkSurface> backing_store) {
+    sk_sp<SkSurface> backing_store,
+    const SkIRect& dirty) {
   TRACE_EVENT0("flutter", "AndroidSurfaceSoftware::PresentBackingStore");
   if (!IsValid() || backing_store == nullptr) {
     return false;
   }
 
+  if (dirty.isEmpty()) {
+    // The window still shows the contents of the backing store.
+    return true;
+  }
+
   SkPixmap pixmap;
   if (!backing_store->peekPixels(&pixmap)) {
     return false;
   }
 
+  // The window copies the rest of the buffer from the previous one, unless it
+  // enlarges the dirty bounds. The dirty bounds are only meaningful when the
+  // backing store is not scaled to the window.
+  ANativeWindow* window = native_window_->handle();
+  const bool same_size = ANativeWindow_getWidth(window) == pixmap.width() &&
+                         ANativeWindow_getHeight(window) == pixmap.height();
+  ARect dirty_bounds = {dirty.left(), dirty.top(), dirty.right(),
+                        dirty.bottom()};
   ANativeWindow_Buffer native_buffer;
-  if (ANativeWindow_lock(native_window_->handle(), &native_buffer, nullptr)) {
+  if (ANativeWindow_lock(window, &native_buffer,
+                         same_size ? &dirty_bounds : nullptr)) {
     return false;
   }
 
@@ -116,6 +131,11 @@ bool AndroidSurfaceSoftware::PresentBackingStore(
         native_buffer.stride * SkColorTypeBytesPerPixel(color_type));
 
     if (canvas) {
+      if (same_size) {
+        canvas->clipRect(SkRect::MakeLTRB(dirty_bounds.left, dirty_bounds.top,
+                                          dirty_bounds.right,
+                                          dirty_bounds.bottom));
+      }
       SkBitmap bitmap;
       if (bitmap.installPixels(pixmap)) {
         canvas->drawBitmapRect(
@@ -125,7 +145,7 @@ bool AndroidSurfaceSoftware::PresentBackingStore(
     }
   }
 
-  ANativeWindow_unlockAndPost(native_window_->handle());
+  ANativeWindow_unlockAndPost(window);
 
   return true;
 }
@@ -28,7 +28,8 @@ class AndroidSurfaceSoftware : public AndroidSurface,
 
   sk_sp<SkSurface> AcquireBackingStore(const SkISize& size) override;
 
-  bool PresentBackingStore(sk_sp<SkSurface> backing_store) override;
+  bool PresentBackingStore(sk_sp<SkSurface> backing_store,
+                           const SkIRect& dirty) override;
 
   void TeardownOnScreenContext() override;
 
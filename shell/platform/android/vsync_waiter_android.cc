@@ -10,6 +10,7 @@
 #include "flutter/common/threads.h"
 #include "flutter/fml/platform/android/jni_util.h"
 #include "flutter/fml/platform/android/scoped_java_ref.h"
+#include "flutter/fml/task_runner.h"
 #include "flutter/fml/trace_event.h"
 #include "lib/fxl/arraysize.h"
 #include "lib/fxl/logging.h"
@@ -42,13 +43,14 @@ void VsyncWaiterAndroid::OnVsync(int64_t frameTimeNanos,
                                  int64_t frameTargetTimeNanos) {
   Callback callback = std::move(callback_);
   callback_ = Callback();
-  blink::Threads::UI()->PostTask(
+  blink::Threads::PostUITask(
       [callback, frameTimeNanos, frameTargetTimeNanos] {
         callback(fxl::TimePoint::FromEpochDelta(
                      fxl::TimeDelta::FromNanoseconds(frameTimeNanos)),
                  fxl::TimePoint::FromEpochDelta(
                      fxl::TimeDelta::FromNanoseconds(frameTargetTimeNanos)));
-      });
+      },
+      fml::TaskPriority::kFrameCritical);
 }
 
 static void OnNativeVsync(JNIEnv* env,
@@ -11,6 +11,7 @@
 #include <mach/mach_time.h>
 
 #include "flutter/common/threads.h"
+#include "flutter/fml/task_runner.h"
 #include "flutter/glue/trace_event.h"
 #include "lib/fxl/logging.h"
 
@@ -76,9 +77,11 @@
   //
   // We are not using the PostTask for thread switching, but to make task
   // observers work.
-  blink::Threads::UI()->PostTask([
-    callback = _pendingCallback, frame_start_time, frame_target_time
-  ]() { callback(frame_start_time, frame_target_time); });
+  blink::Threads::PostUITask(
+      [callback = _pendingCallback, frame_start_time, frame_target_time]() {
+        callback(frame_start_time, frame_target_time);
+      },
+      fml::TaskPriority::kFrameCritical);
 
   _pendingCallback = nullptr;
 }
@@ -29,7 +29,7 @@ class IOSSurfaceSoftware : public IOSSurface,
 
   sk_sp<SkSurface> AcquireBackingStore(const SkISize& size) override;
 
-  bool PresentBackingStore(sk_sp<SkSurface> backing_store) override;
+  bool PresentBackingStore(sk_sp<SkSurface> backing_store, const SkIRect& dirty) override;
 
  private:
   sk_sp<SkSurface> sk_surface_;
@@ -68,12 +68,21 @@ sk_sp<SkSurface> IOSSurfaceSoftware::AcquireBackingStore(const SkISize& size) {
   return sk_surface_;
 }
 
-bool IOSSurfaceSoftware::PresentBackingStore(sk_sp<SkSurface> backing_store) {
+bool IOSSurfaceSoftware::PresentBackingStore(sk_sp<SkSurface> backing_store,
+                                             const SkIRect& dirty) {
   TRACE_EVENT0("flutter", "IOSSurfaceSoftware::PresentBackingStore");
   if (!IsValid() || backing_store == nullptr) {
     return false;
   }
 
+  if (dirty.isEmpty()) {
+    // The layer still shows the contents of the backing store.
+    return true;
+  }
+
+  // The contents of the layer can only be replaced as a whole, so the image
+  // always covers the entire backing store.
+
   SkPixmap pixmap;
   if (!backing_store->peekPixels(&pixmap)) {
     return false;
@@ -21,6 +21,7 @@
 
 #include "flutter/sky/engine/core/rendering/InlineFlowBox.h"
 #include "flutter/sky/engine/core/rendering/PaintInfo.h"
+#include "flutter/sky/engine/core/rendering/RenderArena.h"
 #include "flutter/sky/engine/core/rendering/RenderObjectInlines.h"
 #include "flutter/sky/engine/core/rendering/RenderParagraph.h"
 #include "flutter/sky/engine/core/rendering/RootInlineBox.h"
@@ -62,11 +63,11 @@ void InlineBox::remove(MarkLineBoxes markLineBoxes) {
 }
 
 void* InlineBox::operator new(size_t sz) {
-  return partitionAlloc(Partitions::getRenderingPartition(), sz);
+  return RenderArena::allocateObject(sz);
 }
 
-void InlineBox::operator delete(void* ptr) {
-  partitionFree(ptr);
+void InlineBox::operator delete(void* ptr, size_t sz) {
+  RenderArena::freeObject(ptr, sz);
 }
 
 #ifndef NDEBUG
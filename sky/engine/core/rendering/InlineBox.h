@@ -107,9 +107,10 @@ class InlineBox {
                            LayoutUnit lineTop,
                            LayoutUnit lineBottom);
 
-  // InlineBoxes are allocated out of the rendering partition.
+  // InlineBoxes are allocated out of the current RenderArena, if any, or else
+  // out of the rendering partition, and freed to wherever they were allocated.
   void* operator new(size_t);
-  void operator delete(void*);
+  void operator delete(void*, size_t);
 
 #ifndef NDEBUG
   void showTreeForThis() const;
@@ -0,0 +1,109 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/sky/engine/core/rendering/RenderArena.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "flutter/sky/engine/platform/Partitions.h"
+
+namespace blink {
+
+// Each chunk is twice the size of the previous one, up to the maximum. The
+// first chunk holds the render tree of a short paragraph.
+static const size_t cRenderArenaInitialChunkSize = 1024;
+static const size_t cRenderArenaMaxChunkSize = 16 * 1024;
+
+// Objects from allocateObject() are preceded by the arena that allocated them,
+// or null for the rendering partition.
+static const size_t cObjectHeaderSize = WTF::kAllocationGranularity;
+COMPILE_ASSERT(sizeof(RenderArena*) <= cObjectHeaderSize,
+               RenderArena_object_header_holds_a_pointer);
+
+RenderArena* RenderArena::s_current = 0;
+
+static size_t roundUpAllocationSize(size_t size) {
+  return (size + WTF::kAllocationGranularity - 1) &
+         ~(WTF::kAllocationGranularity - 1);
+}
+
+RenderArena::RenderArena() : m_cursor(0), m_end(0) {
+  memset(m_freeLists, 0, sizeof(m_freeLists));
+}
+
+RenderArena::~RenderArena() {
+  ASSERT(s_current != this);
+  for (const Chunk& chunk : m_chunks)
+    partitionFreeGeneric(Partitions::getRenderArenaPartition(), chunk.start);
+}
+
+void* RenderArena::allocate(size_t size) {
+  ASSERT(size <= maxObjectSize);
+  size = roundUpAllocationSize(size);
+
+  void*& freeList = m_freeLists[freeListIndex(size)];
+  if (void* result = freeList) {
+    freeList = *static_cast<void**>(result);
+    return result;
+  }
+
+  if (static_cast<size_t>(m_end - m_cursor) < size) {
+    size_t chunkSize = m_chunks.isEmpty()
+                           ? cRenderArenaInitialChunkSize
+                           : std::min(m_chunks.last().size * 2,
+                                      cRenderArenaMaxChunkSize);
+    chunkSize = std::max(chunkSize, size);
+    m_cursor = static_cast<char*>(partitionAllocGeneric(
+        Partitions::getRenderArenaPartition(), chunkSize));
+    m_end = m_cursor + chunkSize;
+    m_chunks.append(Chunk{m_cursor, chunkSize});
+  }
+
+  void* result = m_cursor;
+  m_cursor += size;
+  return result;
+}
+
+void RenderArena::free(void* ptr, size_t size) {
+  ASSERT(contains(ptr));
+  size = roundUpAllocationSize(size);
+
+  void*& freeList = m_freeLists[freeListIndex(size)];
+  *static_cast<void**>(ptr) = freeList;
+  freeList = ptr;
+}
+
+bool RenderArena::contains(const void* ptr) const {
+  const char* address = static_cast<const char*>(ptr);
+  for (const Chunk& chunk : m_chunks) {
+    if (address >= chunk.start && address < chunk.start + chunk.size)
+      return true;
+  }
+  return false;
+}
+
+void* RenderArena::allocateObject(size_t size) {
+  size += cObjectHeaderSize;
+  void* block = s_current
+                    ? s_current->allocate(size)
+                    : partitionAlloc(Partitions::getRenderingPartition(), size);
+  *static_cast<RenderArena**>(block) = s_current;
+  return static_cast<char*>(block) + cObjectHeaderSize;
+}
+
+void RenderArena::freeObject(void* ptr, size_t size) {
+  // The current scope only decides where new objects are allocated. An object
+  // is freed to the arena that allocated it, which must be the current one.
+  void* block = static_cast<char*>(ptr) - cObjectHeaderSize;
+  if (RenderArena* arena = *static_cast<RenderArena**>(block)) {
+    RELEASE_ASSERT(arena == s_current);
+    arena->free(block, size + cObjectHeaderSize);
+    return;
+  }
+  partitionFree(block);
+}
+
+}  // namespace blink
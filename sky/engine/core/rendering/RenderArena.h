@@ -0,0 +1,85 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef SKY_ENGINE_CORE_RENDERING_RENDERARENA_H_
+#define SKY_ENGINE_CORE_RENDERING_RENDERARENA_H_
+
+#include "flutter/sky/engine/wtf/FastAllocBase.h"
+#include "flutter/sky/engine/wtf/Noncopyable.h"
+#include "flutter/sky/engine/wtf/PartitionAlloc.h"
+#include "flutter/sky/engine/wtf/Vector.h"
+
+namespace blink {
+
+// A bump allocator for the render objects and inline boxes of a single render
+// tree. Memory is taken from the render arena partition in chunks that start
+// small and grow as the tree does, and is only returned when the arena is
+// destroyed. Freed objects are kept in free lists by size, so that relayouts
+// reuse the memory of the old inline boxes.
+//
+// While a Scope is active, RenderObject and InlineBox allocate from its arena
+// instead of the rendering partition. Objects are freed to whatever allocated
+// them, but the objects of an arena may only be destroyed within a scope of
+// that arena.
+class RenderArena {
+  WTF_MAKE_NONCOPYABLE(RenderArena);
+  WTF_MAKE_FAST_ALLOCATED;
+
+ public:
+  RenderArena();
+  ~RenderArena();
+
+  void* allocate(size_t);
+  void free(void*, size_t);
+
+  bool contains(const void*) const;
+
+  static RenderArena* current() { return s_current; }
+
+  // Allocates an object from the current arena, if any, or else from the
+  // rendering partition. The object is preceded by a word holding the arena
+  // that allocated it.
+  static void* allocateObject(size_t);
+  // Frees an object allocated by allocateObject(). Crashes if the object
+  // belongs to an arena other than the current one.
+  static void freeObject(void*, size_t);
+
+  class Scope {
+    WTF_MAKE_NONCOPYABLE(Scope);
+
+   public:
+    explicit Scope(RenderArena* arena) : m_previous(s_current) {
+      s_current = arena;
+    }
+    ~Scope() { s_current = m_previous; }
+
+   private:
+    RenderArena* m_previous;
+  };
+
+  // The largest object that may be allocated, the same as for the rendering
+  // partition.
+  static const size_t maxObjectSize = 1024;
+
+ private:
+  static size_t freeListIndex(size_t size) {
+    return size >> WTF::kBucketShift;
+  }
+
+  struct Chunk {
+    char* start;
+    size_t size;
+  };
+
+  static RenderArena* s_current;
+
+  Vector<Chunk> m_chunks;
+  char* m_cursor;
+  char* m_end;
+  void* m_freeLists[(maxObjectSize >> WTF::kBucketShift) + 1];
+};
+
+}  // namespace blink
+
+#endif  // SKY_ENGINE_CORE_RENDERING_RENDERARENA_H_
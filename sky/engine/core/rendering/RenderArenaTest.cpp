@@ -0,0 +1,106 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/sky/engine/core/rendering/RenderArena.h"
+
+#include <utility>
+
+#include "flutter/sky/engine/platform/Partitions.h"
+#include "flutter/sky/engine/wtf/OwnPtr.h"
+#include "flutter/sky/engine/wtf/Vector.h"
+#include "gtest/gtest.h"
+
+namespace blink {
+namespace {
+
+class RenderArenaTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() { Partitions::init(); }
+  static void TearDownTestCase() { Partitions::shutdown(); }
+};
+
+TEST_F(RenderArenaTest, ScopesNest) {
+  RenderArena outer;
+  RenderArena inner;
+  EXPECT_EQ(nullptr, RenderArena::current());
+  {
+    RenderArena::Scope outerScope(&outer);
+    EXPECT_EQ(&outer, RenderArena::current());
+    {
+      RenderArena::Scope innerScope(&inner);
+      EXPECT_EQ(&inner, RenderArena::current());
+    }
+    EXPECT_EQ(&outer, RenderArena::current());
+  }
+  EXPECT_EQ(nullptr, RenderArena::current());
+}
+
+TEST_F(RenderArenaTest, ObjectsOutsideAScopeUseTheRenderingPartition) {
+  RenderArena arena;
+  void* object = RenderArena::allocateObject(64);
+  EXPECT_FALSE(arena.contains(object));
+
+  // Freeing inside a scope still returns the object to the partition instead
+  // of putting it on a free list of the arena.
+  RenderArena::Scope scope(&arena);
+  RenderArena::freeObject(object, 64);
+  void* arenaObject = RenderArena::allocateObject(64);
+  EXPECT_NE(object, arenaObject);
+  EXPECT_TRUE(arena.contains(arenaObject));
+  RenderArena::freeObject(arenaObject, 64);
+}
+
+TEST_F(RenderArenaTest, FreedObjectsAreReused) {
+  RenderArena arena;
+  RenderArena::Scope scope(&arena);
+  void* first = RenderArena::allocateObject(48);
+  EXPECT_TRUE(arena.contains(first));
+  RenderArena::freeObject(first, 48);
+  EXPECT_EQ(first, RenderArena::allocateObject(48));
+  RenderArena::freeObject(first, 48);
+}
+
+TEST_F(RenderArenaTest, FirstChunkIsSmall) {
+  RenderArena arena;
+  char* object = static_cast<char*>(arena.allocate(16));
+  EXPECT_TRUE(arena.contains(object));
+  EXPECT_FALSE(arena.contains(object + 4 * 1024));
+  arena.free(object, 16);
+}
+
+TEST_F(RenderArenaTest, ChunksGrowWithTheTree) {
+  RenderArena arena;
+  RenderArena::Scope scope(&arena);
+  Vector<void*> objects;
+  for (size_t i = 0; i < 1000; ++i) {
+    objects.append(RenderArena::allocateObject(120));
+    EXPECT_TRUE(arena.contains(objects.last()));
+  }
+  for (void* object : objects)
+    RenderArena::freeObject(object, 120);
+}
+
+TEST_F(RenderArenaTest, TreeIsTornDownWithinAScope) {
+  // Paragraphs destroy their render tree inside a scope of its arena and then
+  // delete the arena, which frees all of its chunks at once.
+  OwnPtr<RenderArena> arena = adoptPtr(new RenderArena);
+  Vector<std::pair<void*, size_t>> objects;
+  {
+    RenderArena::Scope scope(arena.get());
+    for (size_t i = 0; i < 200; ++i) {
+      size_t size = 16 + (i % 8) * 24;
+      objects.append(std::make_pair(RenderArena::allocateObject(size), size));
+    }
+  }
+  {
+    RenderArena::Scope scope(arena.get());
+    for (const auto& object : objects)
+      RenderArena::freeObject(object.first, object.second);
+  }
+  EXPECT_EQ(nullptr, RenderArena::current());
+  arena.clear();
+}
+
+}  // namespace
+}  // namespace blink
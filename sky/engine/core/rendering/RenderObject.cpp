@@ -30,6 +30,7 @@
 
 #include <algorithm>
 #include "flutter/sky/engine/core/rendering/HitTestResult.h"
+#include "flutter/sky/engine/core/rendering/RenderArena.h"
 #include "flutter/sky/engine/core/rendering/RenderFlexibleBox.h"
 #include "flutter/sky/engine/core/rendering/RenderGeometryMap.h"
 #include "flutter/sky/engine/core/rendering/RenderInline.h"
@@ -86,12 +87,12 @@ bool RenderObject::s_affectsParentBlock = false;
 #if !ENABLE(OILPAN)
 void* RenderObject::operator new(size_t sz) {
   ASSERT(isMainThread());
-  return partitionAlloc(Partitions::getRenderingPartition(), sz);
+  return RenderArena::allocateObject(sz);
 }
 
-void RenderObject::operator delete(void* ptr) {
+void RenderObject::operator delete(void* ptr, size_t sz) {
   ASSERT(isMainThread());
-  partitionFree(ptr);
+  RenderArena::freeObject(ptr, sz);
 }
 #endif
 
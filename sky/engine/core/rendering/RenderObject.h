@@ -242,9 +242,11 @@ class RenderObject {
   static unsigned instanceCount() { return s_instanceCount; }
 
 #if !ENABLE(OILPAN)
-  // RenderObjects are allocated out of the rendering partition.
+  // RenderObjects are allocated out of the current RenderArena, if any, or
+  // else out of the rendering partition, and freed to wherever they were
+  // allocated.
   void* operator new(size_t);
-  void operator delete(void*);
+  void operator delete(void*, size_t);
 #endif
 
  public:
@@ -50,7 +50,7 @@ struct SameSizeAsRenderText : public RenderObject {
   uint32_t bitfields : 16;
   float widths[4];
   String text;
-  void* pointers[2];
+  void* pointers[3];
 };
 
 COMPILE_ASSERT(sizeof(RenderText) == sizeof(SameSizeAsRenderText),
@@ -72,6 +72,7 @@ RenderText::RenderText(PassRefPtr<StringImpl> str)
 
   m_isAllASCII = m_text.containsOnlyASCII();
   m_canUseSimpleFontCodePath = computeCanUseSimpleFontCodePath();
+  m_containsTab = m_text.find('\t') != kNotFound;
   setIsText();
 }
 
@@ -99,6 +100,7 @@ void RenderText::styleDidChange(StyleDifference diff,
   if (diff.needsFullLayout()) {
     setNeedsLayoutAndPrefWidthsRecalc();
     m_knownToHaveNoOverflowAndNoFallbackFonts = false;
+    m_wordWidths.clear();
   }
 
   // This is an optimization that kicks off font load before layout.
@@ -1229,6 +1231,35 @@ void RenderText::setTextInternal(PassRefPtr<StringImpl> text) {
 
   m_isAllASCII = m_text.containsOnlyASCII();
   m_canUseSimpleFontCodePath = computeCanUseSimpleFontCodePath();
+  m_containsTab = m_text.find('\t') != kNotFound;
+  m_wordWidths.clear();
+}
+
+static inline uint64_t wordWidthKey(unsigned from, unsigned len) {
+  ASSERT(len);
+  return (static_cast<uint64_t>(from) << 32) | len;
+}
+
+bool RenderText::cachedWordWidth(unsigned from,
+                                 unsigned len,
+                                 float& width) const {
+  if (!m_wordWidths || !len)
+    return false;
+  WordWidthMap::const_iterator it = m_wordWidths->find(wordWidthKey(from, len));
+  if (it == m_wordWidths->end())
+    return false;
+  width = it->value;
+  return true;
+}
+
+void RenderText::setCachedWordWidth(unsigned from,
+                                    unsigned len,
+                                    float width) const {
+  if (!len)
+    return;
+  if (!m_wordWidths)
+    m_wordWidths = adoptPtr(new WordWidthMap);
+  m_wordWidths->set(wordWidthKey(from, len), width);
 }
 
 void RenderText::setText(PassRefPtr<StringImpl> text, bool force) {
@@ -29,6 +29,8 @@
 #include "flutter/sky/engine/platform/LengthFunctions.h"
 #include "flutter/sky/engine/platform/text/TextPath.h"
 #include "flutter/sky/engine/wtf/Forward.h"
+#include "flutter/sky/engine/wtf/HashMap.h"
+#include "flutter/sky/engine/wtf/OwnPtr.h"
 #include "flutter/sky/engine/wtf/PassRefPtr.h"
 
 namespace blink {
@@ -166,6 +168,13 @@ class RenderText : public RenderObject {
 
   bool canUseSimpleFontCodePath() const { return m_canUseSimpleFontCodePath; }
 
+  // Widths of the words measured by the line breaker in the style's font. They
+  // are kept across layouts, so that laying out the text again at another
+  // width does not measure the same words again.
+  bool cachedWordWidth(unsigned from, unsigned len, float& width) const;
+  void setCachedWordWidth(unsigned from, unsigned len, float width) const;
+  bool containsTab() const { return m_containsTab; }
+
   void removeAndDestroyTextBoxes();
 
  protected:
@@ -242,6 +251,11 @@ class RenderText : public RenderObject {
   bool m_isAllASCII : 1;
   bool m_canUseSimpleFontCodePath : 1;
   mutable bool m_knownToHaveNoOverflowAndNoFallbackFonts : 1;
+  // Whether the text has a tab character at all. Unlike m_hasTab, which is
+  // only computed along with the preferred widths, this is known whenever the
+  // line breaker measures words: a paragraph laid out at a given width need
+  // not compute its preferred widths first.
+  bool m_containsTab : 1;
 
   float m_minWidth;
   float m_maxWidth;
@@ -252,6 +266,9 @@ class RenderText : public RenderObject {
 
   InlineTextBox* m_firstTextBox;
   InlineTextBox* m_lastTextBox;
+
+  typedef HashMap<uint64_t, float> WordWidthMap;
+  mutable OwnPtr<WordWidthMap> m_wordWidths;
 };
 
 inline UChar RenderText::uncheckedCharacterAt(unsigned i) const {
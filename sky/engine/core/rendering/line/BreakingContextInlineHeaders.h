@@ -458,11 +458,25 @@ ALWAYS_INLINE float textWidth(
     return text->width(from, len, font, xPos, text->style()->direction(),
                        fallbackFonts, &glyphOverflow);
 
+  // The width of a word only depends on its position on the line if it may
+  // contain a tab.
+  bool isCacheable = &font == &text->style()->font() &&
+                     (collapseWhiteSpace || !text->containsTab());
+  float width;
+  if (isCacheable && text->cachedWordWidth(from, len, width))
+    return width;
+
   TextRun run = constructTextRun(text, font, text, from, len, text->style());
   run.setCharacterScanForCodePath(!text->canUseSimpleFontCodePath());
   run.setTabSize(!collapseWhiteSpace, text->style()->tabSize());
   run.setXPos(xPos);
-  return font.width(run, fallbackFonts, &glyphOverflow);
+  width = font.width(run, fallbackFonts, &glyphOverflow);
+
+  // Only words known to need no fallback fonts are cached, since the fallback
+  // fonts are needed to compute the height of the line.
+  if (isCacheable && fallbackFonts && fallbackFonts->isEmpty())
+    text->setCachedWordWidth(from, len, width);
+  return width;
 }
 
 inline bool BreakingContext::handleText(WordMeasurements& wordMeasurements,
@@ -48,13 +48,27 @@ class PLATFORM_EXPORT Partitions {
     return m_renderingAllocator.root();
   }
 
+  // Backs the chunks of the arenas that hold the render trees of paragraphs.
+  ALWAYS_INLINE static WTF::PartitionRootGeneric* getRenderArenaPartition() {
+    return m_renderArenaAllocator.root();
+  }
+
   static size_t currentDOMMemoryUsage() {
     return m_objectModelAllocator.root()->totalSizeOfCommittedPages;
   }
 
+  static size_t currentRenderingMemoryUsage() {
+    return m_renderingAllocator.root()->totalSizeOfCommittedPages;
+  }
+
+  static size_t currentRenderArenaMemoryUsage() {
+    return m_renderArenaAllocator.root()->totalSizeOfCommittedPages;
+  }
+
  private:
   static SizeSpecificPartitionAllocator<3072> m_objectModelAllocator;
   static SizeSpecificPartitionAllocator<1024> m_renderingAllocator;
+  static PartitionAllocatorGeneric m_renderArenaAllocator;
 };
 
 }  // namespace blink
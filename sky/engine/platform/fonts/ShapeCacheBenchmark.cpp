@@ -0,0 +1,88 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "flutter/sky/engine/platform/Partitions.h"
+#include "flutter/sky/engine/platform/fonts/Font.h"
+#include "flutter/sky/engine/platform/fonts/FontDescription.h"
+#include "flutter/sky/engine/platform/fonts/harfbuzz/HarfBuzzShaper.h"
+#include "flutter/sky/engine/platform/text/TextRun.h"
+#include "flutter/sky/engine/wtf/MainThread.h"
+#include "flutter/sky/engine/wtf/Vector.h"
+#include "flutter/sky/engine/wtf/WTF.h"
+#include "flutter/sky/engine/wtf/text/WTFString.h"
+#include "third_party/benchmark/include/benchmark/benchmark_api.h"
+
+namespace blink {
+
+static Font createFont() {
+  FontDescription description;
+  description.setSpecifiedSize(14);
+  description.setComputedSize(14);
+  Font font(description);
+  font.update(nullptr);
+  return font;
+}
+
+// Shapes a list of distinct short labels over and over, as a scrolling list
+// does. The argument is the number of distinct labels.
+static void BM_ShapeCacheLabels(benchmark::State& state) {
+  Font font = createFont();
+  Vector<String> labels;
+  for (int i = 0; i < state.range(0); ++i)
+    labels.append("List item " + String::number(i));
+
+  HarfBuzzShaper::purgeShapeCache();
+  HarfBuzzShaper::ShapeCacheStats before = HarfBuzzShaper::shapeCacheStats();
+
+  size_t index = 0;
+  while (state.KeepRunning()) {
+    TextRun run(labels[index]);
+    HarfBuzzShaper shaper(&font, run);
+    benchmark::DoNotOptimize(shaper.shape());
+    index = (index + 1) % labels.size();
+  }
+
+  HarfBuzzShaper::ShapeCacheStats after = HarfBuzzShaper::shapeCacheStats();
+  const size_t hits = after.hits - before.hits;
+  const size_t lookups = hits + after.misses - before.misses;
+  state.SetLabel(
+      "hit rate " + std::to_string(lookups ? 100 * hits / lookups : 0) +
+      "%, " + std::to_string(after.entries) + " runs, " +
+      std::to_string(after.bytes / 1024) + " KB cached");
+}
+BENCHMARK(BM_ShapeCacheLabels)->Arg(64)->Arg(1024)->Arg(16384);
+
+// Shapes the same paragraph without any cache hits, which measures the cost
+// of the lookups and insertions on top of shaping.
+static void BM_ShapeCacheMisses(benchmark::State& state) {
+  Font font = createFont();
+  TextRun run(String(
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do "
+      "eiusmod tempor incididunt ut labore et dolore magna aliqua."));
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    HarfBuzzShaper::purgeShapeCache();
+    state.ResumeTiming();
+    HarfBuzzShaper shaper(&font, run);
+    benchmark::DoNotOptimize(shaper.shape());
+  }
+}
+BENCHMARK(BM_ShapeCacheMisses);
+
+}  // namespace blink
+
+int main(int argc, char** argv) {
+  WTF::initialize();
+  WTF::initializeMainThread();
+  blink::Partitions::init();
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+
+  blink::Partitions::shutdown();
+  return 0;
+}
@@ -42,13 +42,14 @@
 #include "flutter/sky/engine/platform/text/SurrogatePairAwareTextIterator.h"
 #include "flutter/sky/engine/platform/text/TextBreakIterator.h"
 #include "flutter/sky/engine/wtf/Compiler.h"
+#include "flutter/sky/engine/wtf/DoublyLinkedList.h"
+#include "flutter/sky/engine/wtf/HashFunctions.h"
 #include "flutter/sky/engine/wtf/MathExtras.h"
+#include "flutter/sky/engine/wtf/StringHasher.h"
 #include "flutter/sky/engine/wtf/unicode/Unicode.h"
 #include "hb.h"
 
-#include <list>
-#include <map>
-#include <string>
+#include <string.h>
 
 namespace blink {
 
@@ -74,127 +75,277 @@ class HarfBuzzScopedPtr {
   DestroyFunction m_destroy;
 };
 
-static const unsigned cHarfBuzzCacheMaxSize = 256;
-
-struct CachedShapingResultsLRUNode;
-struct CachedShapingResults;
-typedef std::map<std::wstring, CachedShapingResults*> CachedShapingResultsMap;
-typedef std::list<CachedShapingResultsLRUNode*> CachedShapingResultsLRU;
-
-struct CachedShapingResults {
-  CachedShapingResults(hb_buffer_t* harfBuzzBuffer,
-                       const Font* runFont,
+// Shaped runs are cached by their text, font, direction and locale. Short
+// labels are common, so the cache is bounded by the memory used by the shaped
+// buffers rather than by the number of runs.
+static const size_t cHarfBuzzCacheDefaultBudget = 1024 * 1024;
+static const unsigned cHarfBuzzCacheMinCapacity = 64;
+static const unsigned cHarfBuzzCacheInlineLength = 32;
+
+struct CachedShapingResults
+    : public DoublyLinkedListNode<CachedShapingResults> {
+  CachedShapingResults(unsigned hash,
+                       const UChar* text,
+                       unsigned length,
+                       hb_buffer_t* harfBuzzBuffer,
+                       const Font& runFont,
                        hb_direction_t runDir,
                        const String& newLocale);
   ~CachedShapingResults();
 
+  bool matches(unsigned otherHash,
+               const UChar* otherText,
+               unsigned otherLength,
+               const Font& otherFont,
+               hb_direction_t otherDir,
+               const String& otherLocale) const;
+
+  unsigned hash;
+  Vector<UChar, cHarfBuzzCacheInlineLength> text;
   hb_buffer_t* buffer;
   Font font;
   hb_direction_t dir;
   String locale;
-  CachedShapingResultsLRU::iterator lru;
-};
-
-struct CachedShapingResultsLRUNode {
-  CachedShapingResultsLRUNode(
-      const CachedShapingResultsMap::iterator& cacheEntry);
-  ~CachedShapingResultsLRUNode();
+  size_t bytes;
 
-  CachedShapingResultsMap::iterator entry;
+  CachedShapingResults* m_prev;
+  CachedShapingResults* m_next;
 };
 
-CachedShapingResults::CachedShapingResults(hb_buffer_t* harfBuzzBuffer,
-                                           const Font* fontData,
+CachedShapingResults::CachedShapingResults(unsigned textHash,
+                                           const UChar* textData,
+                                           unsigned length,
+                                           hb_buffer_t* harfBuzzBuffer,
+                                           const Font& fontData,
                                            hb_direction_t dirData,
                                            const String& newLocale)
-    : buffer(harfBuzzBuffer),
-      font(*fontData),
+    : hash(textHash),
+      buffer(harfBuzzBuffer),
+      font(fontData),
       dir(dirData),
-      locale(newLocale) {}
+      locale(newLocale),
+      m_prev(0),
+      m_next(0) {
+  text.append(textData, length);
+  bytes = sizeof(CachedShapingResults) +
+          (text.capacity() > cHarfBuzzCacheInlineLength
+               ? text.capacity() * sizeof(UChar)
+               : 0) +
+          hb_buffer_get_length(buffer) *
+              (sizeof(hb_glyph_info_t) + sizeof(hb_glyph_position_t));
+}
 
 CachedShapingResults::~CachedShapingResults() {
   hb_buffer_destroy(buffer);
 }
 
-CachedShapingResultsLRUNode::CachedShapingResultsLRUNode(
-    const CachedShapingResultsMap::iterator& cacheEntry)
-    : entry(cacheEntry) {}
-
-CachedShapingResultsLRUNode::~CachedShapingResultsLRUNode() {}
+bool CachedShapingResults::matches(unsigned otherHash,
+                                   const UChar* otherText,
+                                   unsigned otherLength,
+                                   const Font& otherFont,
+                                   hb_direction_t otherDir,
+                                   const String& otherLocale) const {
+  return hash == otherHash && text.size() == otherLength &&
+         dir == otherDir &&
+         !memcmp(text.data(), otherText, otherLength * sizeof(UChar)) &&
+         font == otherFont && locale == otherLocale;
+}
 
+// An open addressing hash table with linear probing. The slots only hold
+// pointers to the cached results, which are also linked in least recently
+// used order, so that a lookup does not allocate and an insertion allocates
+// a single node.
 class HarfBuzzRunCache {
  public:
   HarfBuzzRunCache();
   ~HarfBuzzRunCache();
 
-  CachedShapingResults* find(const std::wstring& key) const;
-  void remove(CachedShapingResults* node);
-  void moveToBack(CachedShapingResults* node);
-  bool insert(const std::wstring& key, CachedShapingResults* run);
+  static unsigned hashFont(const Font&);
+  static unsigned hash(const UChar* text,
+                       unsigned length,
+                       unsigned fontHash,
+                       hb_direction_t,
+                       const String& locale);
+
+  CachedShapingResults* find(unsigned hash,
+                             const UChar* text,
+                             unsigned length,
+                             const Font&,
+                             hb_direction_t,
+                             const String& locale);
+  void insert(CachedShapingResults*);
+  void clear();
+  void setBudget(size_t bytes);
+
+  HarfBuzzShaper::ShapeCacheStats stats() const;
 
  private:
-  CachedShapingResultsMap m_harfBuzzRunMap;
-  CachedShapingResultsLRU m_harfBuzzRunLRU;
+  void remove(CachedShapingResults*);
+  void evictToBudget();
+  void rehash(unsigned capacity);
+
+  Vector<CachedShapingResults*> m_slots;
+  DoublyLinkedList<CachedShapingResults> m_lru;
+  unsigned m_size;
+  size_t m_bytes;
+  size_t m_budget;
+  size_t m_hits;
+  size_t m_misses;
+  size_t m_evictions;
 };
 
-HarfBuzzRunCache::HarfBuzzRunCache() {}
+HarfBuzzRunCache::HarfBuzzRunCache()
+    : m_size(0),
+      m_bytes(0),
+      m_budget(cHarfBuzzCacheDefaultBudget),
+      m_hits(0),
+      m_misses(0),
+      m_evictions(0) {
+  m_slots.resize(cHarfBuzzCacheMinCapacity);
+  m_slots.fill(0);
+}
 
 HarfBuzzRunCache::~HarfBuzzRunCache() {
-  for (CachedShapingResultsMap::iterator it = m_harfBuzzRunMap.begin();
-       it != m_harfBuzzRunMap.end(); ++it)
-    delete it->second;
-  for (CachedShapingResultsLRU::iterator it = m_harfBuzzRunLRU.begin();
-       it != m_harfBuzzRunLRU.end(); ++it)
-    delete *it;
+  clear();
 }
 
-bool HarfBuzzRunCache::insert(const std::wstring& key,
-                              CachedShapingResults* data) {
-  std::pair<CachedShapingResultsMap::iterator, bool> results =
-      m_harfBuzzRunMap.insert(CachedShapingResultsMap::value_type(key, data));
+unsigned HarfBuzzRunCache::hashFont(const Font& font) {
+  // Only uses properties that are compared by Font::operator==, so that equal
+  // fonts always hash the same.
+  const FontDescription& description = font.fontDescription();
+  const AtomicString& family = description.family().family();
+  unsigned hashCodes[3] = {
+      family.isNull() ? 0 : family.impl()->hash(),
+      WTF::FloatHash<float>::hash(description.computedSize()),
+      static_cast<unsigned>(description.weight())};
+  return StringHasher::hashMemory<sizeof(hashCodes)>(hashCodes);
+}
 
-  if (!results.second)
-    return false;
+unsigned HarfBuzzRunCache::hash(const UChar* text,
+                                unsigned length,
+                                unsigned fontHash,
+                                hb_direction_t dir,
+                                const String& locale) {
+  unsigned hashCodes[4] = {StringHasher::computeHash(text, length), fontHash,
+                           static_cast<unsigned>(dir),
+                           locale.isNull() ? 0 : locale.impl()->hash()};
+  return StringHasher::hashMemory<sizeof(hashCodes)>(hashCodes);
+}
 
-  CachedShapingResultsLRUNode* node =
-      new CachedShapingResultsLRUNode(results.first);
+CachedShapingResults* HarfBuzzRunCache::find(unsigned hash,
+                                             const UChar* text,
+                                             unsigned length,
+                                             const Font& font,
+                                             hb_direction_t dir,
+                                             const String& locale) {
+  unsigned mask = m_slots.size() - 1;
+  for (unsigned i = hash & mask; m_slots[i]; i = (i + 1) & mask) {
+    CachedShapingResults* entry = m_slots[i];
+    if (entry->matches(hash, text, length, font, dir, locale)) {
+      m_lru.remove(entry);
+      m_lru.append(entry);
+      ++m_hits;
+      return entry;
+    }
+  }
+  ++m_misses;
+  return 0;
+}
+
+void HarfBuzzRunCache::insert(CachedShapingResults* entry) {
+  if (entry->bytes > m_budget) {
+    delete entry;
+    return;
+  }
 
-  m_harfBuzzRunLRU.push_back(node);
-  data->lru = --m_harfBuzzRunLRU.end();
+  // Keep the load factor at or below one half so that probe sequences stay
+  // short.
+  if ((m_size + 1) * 2 > m_slots.size())
+    rehash(m_slots.size() * 2);
+
+  unsigned mask = m_slots.size() - 1;
+  unsigned i = entry->hash & mask;
+  while (m_slots[i])
+    i = (i + 1) & mask;
+  m_slots[i] = entry;
+  m_lru.append(entry);
+  ++m_size;
+  m_bytes += entry->bytes;
+
+  evictToBudget();
+}
 
-  if (m_harfBuzzRunMap.size() > cHarfBuzzCacheMaxSize) {
-    CachedShapingResultsLRUNode* lru = m_harfBuzzRunLRU.front();
-    CachedShapingResults* foo = lru->entry->second;
-    m_harfBuzzRunMap.erase(lru->entry);
-    m_harfBuzzRunLRU.pop_front();
-    delete foo;
-    delete lru;
+void HarfBuzzRunCache::remove(CachedShapingResults* entry) {
+  unsigned mask = m_slots.size() - 1;
+  unsigned i = entry->hash & mask;
+  while (m_slots[i] != entry)
+    i = (i + 1) & mask;
+
+  // Shift the following entries of the probe sequence back so that lookups
+  // never stop early at the emptied slot.
+  m_slots[i] = 0;
+  for (unsigned j = (i + 1) & mask; m_slots[j]; j = (j + 1) & mask) {
+    unsigned home = m_slots[j]->hash & mask;
+    bool reachable = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+    if (reachable)
+      continue;
+    m_slots[i] = m_slots[j];
+    m_slots[j] = 0;
+    i = j;
   }
 
-  return true;
+  m_lru.remove(entry);
+  --m_size;
+  m_bytes -= entry->bytes;
+  delete entry;
 }
 
-inline CachedShapingResults* HarfBuzzRunCache::find(
-    const std::wstring& key) const {
-  CachedShapingResultsMap::const_iterator it = m_harfBuzzRunMap.find(key);
+void HarfBuzzRunCache::evictToBudget() {
+  while (m_bytes > m_budget && !m_lru.isEmpty()) {
+    remove(m_lru.head());
+    ++m_evictions;
+  }
+}
 
-  return it != m_harfBuzzRunMap.end() ? it->second : 0;
+void HarfBuzzRunCache::rehash(unsigned capacity) {
+  m_slots.clear();
+  m_slots.resize(capacity);
+  m_slots.fill(0);
+
+  unsigned mask = capacity - 1;
+  for (CachedShapingResults* entry = m_lru.head(); entry;
+       entry = entry->next()) {
+    unsigned i = entry->hash & mask;
+    while (m_slots[i])
+      i = (i + 1) & mask;
+    m_slots[i] = entry;
+  }
 }
 
-inline void HarfBuzzRunCache::remove(CachedShapingResults* node) {
-  CachedShapingResultsLRUNode* lruNode = *node->lru;
+void HarfBuzzRunCache::clear() {
+  while (CachedShapingResults* entry = m_lru.removeHead())
+    delete entry;
+  m_size = 0;
+  m_bytes = 0;
+  m_slots.clear();
+  m_slots.resize(cHarfBuzzCacheMinCapacity);
+  m_slots.fill(0);
+}
 
-  m_harfBuzzRunLRU.erase(node->lru);
-  m_harfBuzzRunMap.erase(lruNode->entry);
-  delete lruNode;
-  delete node;
+void HarfBuzzRunCache::setBudget(size_t bytes) {
+  m_budget = bytes;
+  evictToBudget();
 }
 
-inline void HarfBuzzRunCache::moveToBack(CachedShapingResults* node) {
-  CachedShapingResultsLRUNode* lruNode = *node->lru;
-  m_harfBuzzRunLRU.erase(node->lru);
-  m_harfBuzzRunLRU.push_back(lruNode);
-  node->lru = --m_harfBuzzRunLRU.end();
+HarfBuzzShaper::ShapeCacheStats HarfBuzzRunCache::stats() const {
+  HarfBuzzShaper::ShapeCacheStats stats;
+  stats.hits = m_hits;
+  stats.misses = m_misses;
+  stats.evictions = m_evictions;
+  stats.entries = m_size;
+  stats.bytes = m_bytes;
+  stats.budget = m_budget;
+  return stats;
 }
 
 HarfBuzzRunCache& harfBuzzRunCache() {
@@ -202,6 +353,18 @@ HarfBuzzRunCache& harfBuzzRunCache() {
   return globalHarfBuzzRunCache;
 }
 
+HarfBuzzShaper::ShapeCacheStats HarfBuzzShaper::shapeCacheStats() {
+  return harfBuzzRunCache().stats();
+}
+
+void HarfBuzzShaper::setShapeCacheBudget(size_t bytes) {
+  harfBuzzRunCache().setBudget(bytes);
+}
+
+void HarfBuzzShaper::purgeShapeCache() {
+  harfBuzzRunCache().clear();
+}
+
 static inline float harfBuzzPositionToFloat(hb_position_t value) {
   return static_cast<float>(value) / (1 << 16);
 }
@@ -843,6 +1006,7 @@ bool HarfBuzzShaper::shapeHarfBuzzRuns() {
   const FontDescription& fontDescription = m_font->fontDescription();
   const String& localeString = fontDescription.locale();
   CString locale = localeString.latin1();
+  unsigned fontHash = HarfBuzzRunCache::hashFont(*m_font);
 
   for (unsigned i = 0; i < m_harfBuzzRuns.size(); ++i) {
     unsigned runIndex = m_run.rtl() ? m_harfBuzzRuns.size() - i - 1 : i;
@@ -864,24 +1028,20 @@ bool HarfBuzzShaper::shapeHarfBuzzRuns() {
     hb_buffer_set_direction(harfBuzzBuffer.get(), currentRun->direction());
 
     const UChar* src = m_normalizedBuffer.get() + currentRun->startIndex();
-    std::wstring key(src, src + currentRun->numCharacters());
+    unsigned hash =
+        HarfBuzzRunCache::hash(src, currentRun->numCharacters(), fontHash,
+                               currentRun->direction(), localeString);
 
-    CachedShapingResults* cachedResults = runCache.find(key);
+    CachedShapingResults* cachedResults =
+        runCache.find(hash, src, currentRun->numCharacters(), *m_font,
+                      currentRun->direction(), localeString);
     if (cachedResults) {
-      if (cachedResults->dir == currentRun->direction() &&
-          cachedResults->font == *m_font &&
-          cachedResults->locale == localeString) {
-        currentRun->applyShapeResult(cachedResults->buffer);
-        setGlyphPositionsForHarfBuzzRun(currentRun, cachedResults->buffer);
-
-        hb_buffer_clear_contents(harfBuzzBuffer.get());
+      currentRun->applyShapeResult(cachedResults->buffer);
+      setGlyphPositionsForHarfBuzzRun(currentRun, cachedResults->buffer);
 
-        runCache.moveToBack(cachedResults);
+      hb_buffer_clear_contents(harfBuzzBuffer.get());
 
-        continue;
-      }
-
-      runCache.remove(cachedResults);
+      continue;
     }
 
     // Add a space as pre-context to the buffer. This prevents showing
@@ -919,9 +1079,9 @@ bool HarfBuzzShaper::shapeHarfBuzzRuns() {
     currentRun->applyShapeResult(harfBuzzBuffer.get());
     setGlyphPositionsForHarfBuzzRun(currentRun, harfBuzzBuffer.get());
 
-    runCache.insert(
-        key, new CachedShapingResults(harfBuzzBuffer.get(), m_font,
-                                      currentRun->direction(), localeString));
+    runCache.insert(new CachedShapingResults(
+        hash, src, currentRun->numCharacters(), harfBuzzBuffer.get(), *m_font,
+        currentRun->direction(), localeString));
 
     harfBuzzBuffer.set(hb_buffer_create());
   }
@@ -65,6 +65,21 @@ class HarfBuzzShaper final {
   FloatRect selectionRect(const FloatPoint&, int height, int from, int to);
   FloatBoxExtent glyphBoundingBox() const { return m_glyphBoundingBox; }
 
+  // Counters of the process wide cache of shaped runs. |bytes| and |budget|
+  // measure the memory used by the cached glyph buffers.
+  struct ShapeCacheStats {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t entries;
+    size_t bytes;
+    size_t budget;
+  };
+
+  static ShapeCacheStats shapeCacheStats();
+  static void setShapeCacheBudget(size_t bytes);
+  static void purgeShapeCache();
+
  private:
   class HarfBuzzRun {
    public:
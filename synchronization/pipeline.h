@@ -6,15 +6,15 @@
 #define SYNCHRONIZATION_PIPELINE_H_
 
 #include "flutter/glue/trace_event.h"
-#include "flutter/synchronization/pipeline.h"
-#include "flutter/synchronization/semaphore.h"
 #include "lib/fxl/functional/closure.h"
+#include "lib/fxl/logging.h"
 #include "lib/fxl/macros.h"
 #include "lib/fxl/memory/ref_counted.h"
 
+#include <atomic>
+#include <functional>
 #include <memory>
-#include <mutex>
-#include <queue>
+#include <vector>
 
 namespace flutter {
 
@@ -24,6 +24,17 @@ enum class PipelineConsumeResult {
   MoreAvailable,
 };
 
+enum class PipelineMode {
+  // Resources are consumed in the order they were produced. Produce fails
+  // while |depth| resources are in flight.
+  Queue,
+  // Only the most recently produced resource is retained. Produce never
+  // fails and replaces a resource that was not consumed yet.
+  ReplacePending,
+};
+
+/// A pipeline of resources from a single producer thread to a single consumer
+/// thread. Neither side ever blocks or takes a lock.
 template <class R>
 class Pipeline : public fxl::RefCountedThreadSafe<Pipeline<R>> {
  public:
@@ -50,10 +61,10 @@ class Pipeline : public fxl::RefCountedThreadSafe<Pipeline<R>> {
 
     ~ProducerContinuation() {
       if (continuation_) {
+        // The continuation is being dropped on the floor. Committing nothing
+        // ends the flow.
         continuation_(nullptr, trace_id_);
         TRACE_EVENT_ASYNC_END0("flutter", "PipelineProduce", trace_id_);
-        // The continuation is being dropped on the floor. End the flow.
-        TRACE_FLOW_END("flutter", "PipelineItem", trace_id_);
       }
     }
 
@@ -84,16 +95,31 @@ class Pipeline : public fxl::RefCountedThreadSafe<Pipeline<R>> {
     FXL_DISALLOW_COPY_AND_ASSIGN(ProducerContinuation);
   };
 
-  explicit Pipeline(uint32_t depth)
-      : empty_(depth), available_(0), last_trace_id_(0) {}
+  explicit Pipeline(uint32_t depth, PipelineMode mode = PipelineMode::Queue)
+      : mode_(mode),
+        depth_(depth),
+        slots_(depth),
+        reserved_count_(0),
+        produced_count_(0),
+        consumed_count_(0),
+        pending_(nullptr),
+        last_trace_id_(0) {}
 
-  ~Pipeline() = default;
+  ~Pipeline() { delete pending_.exchange(nullptr); }
 
-  bool IsValid() const { return empty_.IsValid() && available_.IsValid(); }
+  bool IsValid() const { return depth_ > 0; }
 
+  /// Must only be called on the producer thread, which must also complete
+  /// or drop the continuation.
   ProducerContinuation Produce() {
-    if (!empty_.TryWait()) {
-      return {};
+    if (mode_ == PipelineMode::Queue) {
+      // Every reservation is committed eventually, so the slots of the
+      // reservations that are not consumed yet must all be available.
+      if (reserved_count_ - consumed_count_.load(std::memory_order_acquire) >=
+          depth_) {
+        return {};
+      }
+      reserved_count_++;
     }
 
     return ProducerContinuation{
@@ -104,55 +130,95 @@ class Pipeline : public fxl::RefCountedThreadSafe<Pipeline<R>> {
 
   using Consumer = std::function<void(ResourcePtr)>;
 
+  /// Must only be called on the consumer thread.
   FXL_WARN_UNUSED_RESULT
   PipelineConsumeResult Consume(Consumer consumer) {
     if (consumer == nullptr) {
       return PipelineConsumeResult::NoneAvailable;
     }
 
-    if (!available_.TryWait()) {
-      return PipelineConsumeResult::NoneAvailable;
-    }
+    if (mode_ == PipelineMode::ReplacePending) {
+      std::unique_ptr<Slot> slot(pending_.exchange(nullptr));
+      if (!slot) {
+        return PipelineConsumeResult::NoneAvailable;
+      }
 
-    ResourcePtr resource;
-    size_t trace_id = 0;
-    size_t items_count = 0;
+      {
+        TRACE_EVENT0("flutter", "PipelineConsume");
+        consumer(std::move(slot->resource));
+      }
 
-    {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
-      std::tie(resource, trace_id) = std::move(queue_.front());
-      queue_.pop();
-      items_count = queue_.size();
+      TRACE_FLOW_END("flutter", "PipelineItem", slot->trace_id);
+
+      return pending_.load() != nullptr ? PipelineConsumeResult::MoreAvailable
+                                        : PipelineConsumeResult::Done;
     }
 
+    const size_t consumed = consumed_count_.load(std::memory_order_relaxed);
+    if (consumed == produced_count_.load(std::memory_order_acquire)) {
+      return PipelineConsumeResult::NoneAvailable;
+    }
+
+    Slot& slot = slots_[consumed % depth_];
+    const size_t trace_id = slot.trace_id;
+
     {
       TRACE_EVENT0("flutter", "PipelineConsume");
-      consumer(std::move(resource));
+      consumer(std::move(slot.resource));
     }
 
-    empty_.Signal();
+    // The slot is only handed back to the producer once the consumer is done,
+    // which is what makes a slow consumer apply back pressure.
+    consumed_count_.store(consumed + 1, std::memory_order_release);
 
     TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
 
-    return items_count > 0 ? PipelineConsumeResult::MoreAvailable
-                           : PipelineConsumeResult::Done;
+    return produced_count_.load(std::memory_order_acquire) > consumed + 1
+               ? PipelineConsumeResult::MoreAvailable
+               : PipelineConsumeResult::Done;
   }
 
  private:
-  Semaphore empty_;
-  Semaphore available_;
-  std::mutex queue_mutex_;
-  std::queue<std::pair<ResourcePtr, size_t>> queue_;
+  struct Slot {
+    ResourcePtr resource;
+    size_t trace_id = 0;
+  };
+
+  const PipelineMode mode_;
+  const size_t depth_;
+  // Ring of |depth_| slots used in the |Queue| mode. The slot of the n-th
+  // produced resource is |n % depth_|.
+  std::vector<Slot> slots_;
+  // Only accessed by the producer.
+  size_t reserved_count_;
+  std::atomic_size_t produced_count_;
+  std::atomic_size_t consumed_count_;
+  // The resource waiting for the consumer in the |ReplacePending| mode.
+  std::atomic<Slot*> pending_;
   std::atomic_size_t last_trace_id_;
 
   void ProducerCommit(ResourcePtr resource, size_t trace_id) {
-    {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
-      queue_.emplace(std::move(resource), trace_id);
+    if (mode_ == PipelineMode::ReplacePending) {
+      // A dropped continuation must not replace a frame that is still
+      // waiting for the consumer.
+      if (!resource) {
+        TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
+        return;
+      }
+      std::unique_ptr<Slot> replaced(
+          pending_.exchange(new Slot{std::move(resource), trace_id}));
+      if (replaced) {
+        TRACE_EVENT_INSTANT0("flutter", "PipelineReplacePending");
+        TRACE_FLOW_END("flutter", "PipelineItem", replaced->trace_id);
+      }
+      return;
     }
 
-    // Ensure the queue mutex is not held as that would be a pessimization.
-    available_.Signal();
+    // The slot is available because it was reserved in |Produce|.
+    const size_t produced = produced_count_.load(std::memory_order_relaxed);
+    FXL_DCHECK(produced < reserved_count_);
+    slots_[produced % depth_] = {std::move(resource), trace_id};
+    produced_count_.store(produced + 1, std::memory_order_release);
   }
 
   FXL_DISALLOW_COPY_AND_ASSIGN(Pipeline);
@@ -0,0 +1,75 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <atomic>
+#include <thread>
+
+#include "flutter/synchronization/pipeline.h"
+#include "third_party/benchmark/include/benchmark/benchmark_api.h"
+
+namespace flutter {
+
+using IntPipeline = Pipeline<int>;
+
+// Produces and consumes a resource on the same thread. Measures the overhead
+// of the pipeline itself.
+static void BM_PipelineProduceConsume(benchmark::State& state) {
+  auto pipeline = fxl::MakeRefCounted<IntPipeline>(
+      2, static_cast<PipelineMode>(state.range(0)));
+  IntPipeline::Consumer consumer = [](std::unique_ptr<int> value) {
+    benchmark::DoNotOptimize(value);
+  };
+
+  while (state.KeepRunning()) {
+    pipeline->Produce().Complete(std::make_unique<int>(0));
+    benchmark::DoNotOptimize(pipeline->Consume(consumer));
+  }
+}
+BENCHMARK(BM_PipelineProduceConsume)
+    ->Arg(static_cast<int>(PipelineMode::Queue))
+    ->Arg(static_cast<int>(PipelineMode::ReplacePending));
+
+// Produces resources as fast as possible while a consumer thread consumes
+// them. Reports the number of resources that reached the consumer.
+static void BM_PipelineThroughput(benchmark::State& state) {
+  auto pipeline = fxl::MakeRefCounted<IntPipeline>(
+      2, static_cast<PipelineMode>(state.range(0)));
+  std::atomic_bool done(false);
+  size_t consumed = 0;
+
+  std::thread consumer_thread([pipeline, &done, &consumed]() {
+    IntPipeline::Consumer consumer = [&consumed](std::unique_ptr<int> value) {
+      consumed++;
+    };
+    while (!done.load()) {
+      if (pipeline->Consume(consumer) ==
+          PipelineConsumeResult::NoneAvailable) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  size_t produced = 0;
+  while (state.KeepRunning()) {
+    auto continuation = pipeline->Produce();
+    if (continuation) {
+      continuation.Complete(std::make_unique<int>(0));
+      produced++;
+    }
+  }
+
+  done = true;
+  consumer_thread.join();
+
+  state.SetItemsProcessed(consumed);
+  state.SetLabel(std::to_string(produced) + " produced, " +
+                 std::to_string(consumed) + " consumed");
+}
+BENCHMARK(BM_PipelineThroughput)
+    ->Arg(static_cast<int>(PipelineMode::Queue))
+    ->Arg(static_cast<int>(PipelineMode::ReplacePending));
+
+}  // namespace flutter
+
+BENCHMARK_MAIN();
@@ -0,0 +1,128 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <thread>
+
+#include "flutter/synchronization/pipeline.h"
+#include "gtest/gtest.h"
+
+using IntPipeline = flutter::Pipeline<int>;
+
+TEST(PipelineTest, QueueRespectsDepth) {
+  auto pipeline = fxl::MakeRefCounted<IntPipeline>(2);
+  ASSERT_TRUE(pipeline->IsValid());
+
+  auto continuation1 = pipeline->Produce();
+  auto continuation2 = pipeline->Produce();
+  ASSERT_TRUE(continuation1);
+  ASSERT_TRUE(continuation2);
+  ASSERT_FALSE(pipeline->Produce());
+
+  continuation1.Complete(std::make_unique<int>(1));
+  continuation2.Complete(std::make_unique<int>(2));
+  ASSERT_FALSE(pipeline->Produce());
+
+  int consumed = 0;
+  ASSERT_EQ(pipeline->Consume([&consumed](std::unique_ptr<int> value) {
+    consumed = *value;
+  }),
+            flutter::PipelineConsumeResult::MoreAvailable);
+  ASSERT_EQ(consumed, 1);
+  ASSERT_TRUE(pipeline->Produce());
+}
+
+TEST(PipelineTest, QueueConsumesInOrder) {
+  auto pipeline = fxl::MakeRefCounted<IntPipeline>(3);
+
+  for (int i = 0; i < 10; i++) {
+    pipeline->Produce().Complete(std::make_unique<int>(i));
+    int consumed = -1;
+    ASSERT_EQ(pipeline->Consume([&consumed](std::unique_ptr<int> value) {
+      consumed = *value;
+    }),
+              flutter::PipelineConsumeResult::Done);
+    ASSERT_EQ(consumed, i);
+  }
+
+  ASSERT_EQ(pipeline->Consume([](std::unique_ptr<int>) {}),
+            flutter::PipelineConsumeResult::NoneAvailable);
+}
+
+TEST(PipelineTest, DroppedContinuationProducesNothing) {
+  auto pipeline = fxl::MakeRefCounted<IntPipeline>(1);
+
+  { auto continuation = pipeline->Produce(); }
+
+  bool consumed_null = false;
+  ASSERT_EQ(pipeline->Consume([&consumed_null](std::unique_ptr<int> value) {
+    consumed_null = value == nullptr;
+  }),
+            flutter::PipelineConsumeResult::Done);
+  ASSERT_TRUE(consumed_null);
+}
+
+TEST(PipelineTest, ReplacePendingKeepsLatest) {
+  auto pipeline = fxl::MakeRefCounted<IntPipeline>(
+      1, flutter::PipelineMode::ReplacePending);
+
+  for (int i = 0; i < 3; i++) {
+    auto continuation = pipeline->Produce();
+    ASSERT_TRUE(continuation);
+    continuation.Complete(std::make_unique<int>(i));
+  }
+
+  int consumed = -1;
+  ASSERT_EQ(pipeline->Consume([&consumed](std::unique_ptr<int> value) {
+    consumed = *value;
+  }),
+            flutter::PipelineConsumeResult::Done);
+  ASSERT_EQ(consumed, 2);
+  ASSERT_EQ(pipeline->Consume([](std::unique_ptr<int>) {}),
+            flutter::PipelineConsumeResult::NoneAvailable);
+}
+
+TEST(PipelineTest, ReplacePendingIgnoresDroppedContinuation) {
+  auto pipeline = fxl::MakeRefCounted<IntPipeline>(
+      1, flutter::PipelineMode::ReplacePending);
+
+  pipeline->Produce().Complete(std::make_unique<int>(1));
+  { auto continuation = pipeline->Produce(); }
+
+  int consumed = -1;
+  ASSERT_EQ(pipeline->Consume([&consumed](std::unique_ptr<int> value) {
+    ASSERT_TRUE(value);
+    consumed = *value;
+  }),
+            flutter::PipelineConsumeResult::Done);
+  ASSERT_EQ(consumed, 1);
+}
+
+TEST(PipelineTest, ProducerAndConsumerOnDifferentThreads) {
+  auto pipeline = fxl::MakeRefCounted<IntPipeline>(2);
+  const int count = 10000;
+
+  std::thread producer([pipeline, count]() {
+    for (int i = 0; i < count;) {
+      auto continuation = pipeline->Produce();
+      if (continuation) {
+        continuation.Complete(std::make_unique<int>(i++));
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  while (expected < count) {
+    auto result = pipeline->Consume([&expected](std::unique_ptr<int> value) {
+      ASSERT_EQ(*value, expected);
+      expected++;
+    });
+    if (result == flutter::PipelineConsumeResult::NoneAvailable) {
+      std::this_thread::yield();
+    }
+  }
+
+  producer.join();
+}
@@ -18,6 +18,13 @@ class NegativeSpace implements Canvas, PictureRecorder, Color {
   }
 }
 
+// A shader that the engine cannot unwrap. Replaying a draw that uses it
+// fails, which shows when a batched draw is replayed and whether its paint
+// was recorded.
+class FakeShader implements Shader {
+  dynamic noSuchMethod(Invocation invocation) => null;
+}
+
 void testCanvas(callback(Canvas canvas)) {
   try {
     callback(new Canvas(new PictureRecorder(), new Rect.fromLTRB(0.0, 0.0, 0.0, 0.0)));
@@ -92,4 +99,113 @@ void main() {
     testCanvas((Canvas canvas) => canvas.transform(null));
     testCanvas((Canvas canvas) => canvas.translate(double.NAN, double.NAN));
   });
+
+  group("canvas command buffer", () {
+    final Rect rect = new Rect.fromLTWH(0.0, 0.0, 10.0, 10.0);
+    final Gradient gradient = new Gradient.linear(Offset.zero,
+        const Offset(10.0, 0.0), <Color>[const Color(0xFF000000), const Color(0xFFFFFFFF)]);
+
+    test("batched commands are replayed before unbatched ones", () {
+      PictureRecorder recorder = new PictureRecorder();
+      Canvas canvas = new Canvas(recorder);
+      canvas.save();
+      canvas.translate(1.0, 2.0);
+      canvas.saveLayer(rect, new Paint());
+      canvas.save();
+      expect(canvas.getSaveCount(), equals(4));
+      canvas.restore();
+      canvas.restore();
+      expect(canvas.getSaveCount(), equals(2));
+
+      canvas.drawRect(rect, new Paint()..shader = new FakeShader());
+      expect(() => canvas.drawPath(new Path(), new Paint()), throwsStateError);
+
+      // The failed commands are dropped.
+      canvas.drawRect(rect, new Paint());
+      expect(canvas.getSaveCount(), equals(2));
+      expect(recorder.endRecording(), isNotNull);
+    });
+
+    test("commands are replayed into the canvas that recorded them", () {
+      PictureRecorder recorderA = new PictureRecorder();
+      PictureRecorder recorderB = new PictureRecorder();
+      Canvas canvasA = new Canvas(recorderA);
+      Canvas canvasB = new Canvas(recorderB);
+      canvasA.save();
+      canvasB.save();
+      canvasB.save();
+      canvasA.drawRect(rect, new Paint());
+      canvasB.restore();
+      canvasA.save();
+      expect(canvasA.getSaveCount(), equals(3));
+      expect(canvasB.getSaveCount(), equals(2));
+
+      // A paint recorded for one canvas is recorded again for the other.
+      Paint paint = new Paint()..shader = new FakeShader();
+      canvasA.drawRect(rect, paint);
+      expect(() => canvasA.getSaveCount(), throwsStateError);
+      canvasB.drawRect(rect, paint);
+      expect(() => canvasB.getSaveCount(), throwsStateError);
+
+      expect(recorderA.endRecording(), isNotNull);
+      expect(recorderB.endRecording(), isNotNull);
+    });
+
+    test("paints are recorded again when they change", () {
+      PictureRecorder recorder = new PictureRecorder();
+      Canvas canvas = new Canvas(recorder);
+      Paint paint = new Paint()..shader = gradient;
+      canvas.drawRect(rect, paint);
+      canvas.drawRect(rect, paint);
+      paint.shader = new FakeShader();
+      canvas.drawRect(rect, paint);
+      expect(() => canvas.getSaveCount(), throwsStateError);
+
+      // A different paint with the same fields has a different shader.
+      canvas.drawRect(rect, new Paint()..shader = gradient);
+      canvas.drawRect(rect, new Paint()..shader = new FakeShader());
+      expect(() => canvas.getSaveCount(), throwsStateError);
+
+      // Mutating a paint without a shader, including across full buffers.
+      paint.shader = null;
+      for (int i = 0; i < 2000; i += 1) {
+        paint
+          ..color = new Color(0xFF000000 + i)
+          ..strokeWidth = i.toDouble()
+          ..style = i.isEven ? PaintingStyle.fill : PaintingStyle.stroke;
+        canvas.drawRect(rect, paint);
+        canvas.drawCircle(Offset.zero, 5.0, paint);
+      }
+      expect(canvas.getSaveCount(), equals(1));
+
+      // Giving the paint a shader again records it, even though its fields
+      // have not changed since the last draw.
+      canvas.drawRect(rect, paint);
+      paint.shader = new FakeShader();
+      canvas.drawRect(rect, paint);
+      expect(() => canvas.getSaveCount(), throwsStateError);
+      expect(recorder.endRecording(), isNotNull);
+    });
+
+    test("ending a recording replays its commands", () {
+      PictureRecorder recorder = new PictureRecorder();
+      Canvas canvas = new Canvas(recorder);
+      canvas.drawRect(rect, new Paint()..shader = new FakeShader());
+      expect(() => recorder.endRecording(), throwsStateError);
+
+      recorder = new PictureRecorder();
+      canvas = new Canvas(recorder);
+      canvas.drawRect(rect, new Paint()..shader = gradient);
+      canvas.save();
+      expect(recorder.endRecording(), isNotNull);
+      expect(recorder.isRecording, isFalse);
+
+      // Nothing recorded for the ended canvas reaches the next one.
+      PictureRecorder next = new PictureRecorder();
+      Canvas nextCanvas = new Canvas(next);
+      nextCanvas.drawRect(rect, new Paint());
+      expect(nextCanvas.getSaveCount(), equals(1));
+      expect(next.endRecording(), isNotNull);
+    });
+  });
 }
@@ -17,4 +17,42 @@ void main() {
     expect(paragraph.width, isNonZero);
     expect(paragraph.height, isNonZero);
   });
+
+  test("Should be able to layout a paragraph asynchronously", () async {
+    ParagraphBuilder builder = new ParagraphBuilder(new ParagraphStyle());
+    builder.addText('Hello');
+    Paragraph paragraph = builder.build();
+
+    Paragraph laidOut =
+        await paragraph.layoutAsync(new ParagraphConstraints(width: 800.0));
+    expect(laidOut, same(paragraph));
+    expect(paragraph.width, isNonZero);
+    expect(paragraph.height, isNonZero);
+  });
+
+  test("A later layout should not be overwritten by an async one", () async {
+    ParagraphBuilder builder = new ParagraphBuilder(new ParagraphStyle());
+    builder.addText('Hello');
+    Paragraph paragraph = builder.build();
+
+    Future<Paragraph> pending =
+        paragraph.layoutAsync(new ParagraphConstraints(width: 800.0));
+    paragraph.layout(new ParagraphConstraints(width: 400.0));
+    await pending;
+    expect(paragraph.width, equals(400.0));
+  });
+
+  test("Reading a paragraph should wait for an async layout", () async {
+    ParagraphBuilder builder = new ParagraphBuilder(new ParagraphStyle());
+    builder.addText('Hello');
+    Paragraph paragraph = builder.build();
+
+    Future<Paragraph> pending =
+        paragraph.layoutAsync(new ParagraphConstraints(width: 800.0));
+    double height = paragraph.height;
+    expect(height, isNonZero);
+    expect(paragraph.width, equals(800.0));
+    await pending;
+    expect(paragraph.height, equals(height));
+  });
 }
@@ -0,0 +1,169 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'dart:ui';
+
+import 'package:test/test.dart';
+
+const String kText = 'Hello world, hello paragraph';
+
+// Builds a paragraph of a single run of text. Unless [renderTree] is set, a
+// paragraph like this is laid out and painted without a render tree while it
+// fits on one line. An extra pop makes the builder create the render tree
+// right away, as it does for a paragraph with more than one run.
+Paragraph buildParagraph(ParagraphStyle paragraphStyle, {
+  TextStyle style,
+  bool renderTree: false,
+}) {
+  ParagraphBuilder builder = new ParagraphBuilder(paragraphStyle);
+  if (style != null)
+    builder.pushStyle(style);
+  builder.addText(kText);
+  if (style != null)
+    builder.pop();
+  if (renderTree)
+    builder.pop();
+  return builder.build();
+}
+
+// Lays out both versions of the paragraph at a width wide enough for one
+// line, exactly as wide as the text, and narrow enough to break the text into
+// lines, and checks that they report the same metrics, paint without error
+// and, once the fast path has handed over to the render tree, report the same
+// boxes.
+void expectSameLayout(ParagraphStyle paragraphStyle, {TextStyle style}) {
+  double textWidth =
+      buildParagraph(paragraphStyle, style: style).maxIntrinsicWidth;
+  for (double width in <double>[800.0, textWidth, 60.0]) {
+    Paragraph fast = buildParagraph(paragraphStyle, style: style);
+    Paragraph slow =
+        buildParagraph(paragraphStyle, style: style, renderTree: true);
+    ParagraphConstraints constraints = new ParagraphConstraints(width: width);
+
+    expect(fast.maxIntrinsicWidth, equals(slow.maxIntrinsicWidth));
+
+    fast.layout(constraints);
+    slow.layout(constraints);
+    expect(fast.width, equals(slow.width), reason: 'width at $width');
+    expect(fast.height, equals(slow.height), reason: 'height at $width');
+    expect(fast.alphabeticBaseline, equals(slow.alphabeticBaseline),
+        reason: 'alphabetic baseline at $width');
+    expect(fast.ideographicBaseline, equals(slow.ideographicBaseline),
+        reason: 'ideographic baseline at $width');
+    expect(fast.didExceedMaxLines, equals(slow.didExceedMaxLines));
+
+    // Paint before anything hands the fast path over to the render tree.
+    PictureRecorder recorder = new PictureRecorder();
+    Canvas canvas =
+        new Canvas(recorder, new Rect.fromLTWH(0.0, 0.0, width, 100.0));
+    canvas.drawParagraph(fast, Offset.zero);
+    canvas.drawParagraph(slow, Offset.zero);
+    expect(recorder.endRecording(), isNotNull);
+
+    // The fast path paints the run at the position of the single text box that
+    // the render tree lays out for it.
+    List<TextBox> boxes = slow.getBoxesForRange(0, kText.length);
+    expect(fast.getBoxesForRange(0, kText.length), equals(boxes));
+    expect(fast.getBoxesForRange(6, 11), equals(slow.getBoxesForRange(6, 11)));
+    expect(fast.minIntrinsicWidth, equals(slow.minIntrinsicWidth));
+
+    // The render tree that replaced the fast path keeps the same layout.
+    expect(fast.width, equals(slow.width));
+    expect(fast.height, equals(slow.height));
+    expect(fast.alphabeticBaseline, equals(slow.alphabeticBaseline));
+  }
+}
+
+const List<String> kRuns = const <String>[
+  'The quick brown fox ',
+  'jumps over\tthe lazy dog, ',
+  'again and again and again.',
+];
+
+// Builds a paragraph of several runs, which is laid out with a render tree.
+Paragraph buildRuns() {
+  ParagraphBuilder builder = new ParagraphBuilder(new ParagraphStyle());
+  builder.addText(kRuns[0]);
+  builder.pushStyle(new TextStyle(fontSize: 20.0, letterSpacing: 1.0));
+  builder.addText(kRuns[1]);
+  builder.pop();
+  builder.addText(kRuns[2]);
+  return builder.build();
+}
+
+void expectSameMetrics(Paragraph actual, Paragraph expected, String reason) {
+  expect(actual.width, equals(expected.width), reason: reason);
+  expect(actual.height, equals(expected.height), reason: reason);
+  expect(actual.alphabeticBaseline, equals(expected.alphabeticBaseline),
+      reason: reason);
+  expect(actual.ideographicBaseline, equals(expected.ideographicBaseline),
+      reason: reason);
+  expect(actual.didExceedMaxLines, equals(expected.didExceedMaxLines),
+      reason: reason);
+  int length = kRuns.join().length;
+  expect(actual.getBoxesForRange(0, length),
+      equals(expected.getBoxesForRange(0, length)), reason: reason);
+  expect(actual.getBoxesForRange(24, 40),
+      equals(expected.getBoxesForRange(24, 40)), reason: reason);
+}
+
+void main() {
+  test("Single run matches the render tree", () {
+    expectSameLayout(new ParagraphStyle());
+  });
+
+  test("Single run with a font size matches the render tree", () {
+    expectSameLayout(new ParagraphStyle(fontSize: 23.0));
+  });
+
+  test("Single run with a line height matches the render tree", () {
+    expectSameLayout(new ParagraphStyle(fontSize: 15.0, lineHeight: 2.5));
+  });
+
+  test("Aligned single run matches the render tree", () {
+    for (TextAlign align in TextAlign.values)
+      expectSameLayout(new ParagraphStyle(textAlign: align));
+  });
+
+  test("Single run in a pushed style matches the render tree", () {
+    expectSameLayout(new ParagraphStyle(),
+        style: new TextStyle(color: const Color(0xFF00FF00)));
+  });
+
+  test("Single run with a line height in a pushed style matches", () {
+    expectSameLayout(new ParagraphStyle(lineHeight: 1.5),
+        style: new TextStyle(height: 1.5));
+  });
+
+  test("Single run with letter spacing matches the render tree", () {
+    expectSameLayout(new ParagraphStyle(),
+        style: new TextStyle(letterSpacing: 3.0, wordSpacing: 5.0));
+  });
+
+  test("Laying out again at an earlier width matches a fresh layout", () {
+    Paragraph paragraph = buildRuns();
+    for (double width in <double>[300.0, 120.0, 300.0, 800.0, 120.0]) {
+      paragraph.layout(new ParagraphConstraints(width: width));
+      Paragraph fresh = buildRuns()
+        ..layout(new ParagraphConstraints(width: width));
+      expectSameMetrics(paragraph, fresh, 'width $width');
+    }
+  });
+
+  test("Metrics read between layouts match a fresh layout", () {
+    Paragraph paragraph = buildRuns();
+    paragraph.layout(new ParagraphConstraints(width: 300.0));
+    double height = paragraph.height;
+    paragraph.layout(new ParagraphConstraints(width: 120.0));
+    expect(paragraph.height, greaterThan(height));
+    paragraph.layout(new ParagraphConstraints(width: 300.0));
+    expect(paragraph.height, equals(height));
+
+    Paragraph fresh = buildRuns()
+      ..layout(new ParagraphConstraints(width: 300.0));
+    expectSameMetrics(paragraph, fresh, 'width 300.0');
+    expect(paragraph.minIntrinsicWidth, equals(fresh.minIntrinsicWidth));
+    expect(paragraph.maxIntrinsicWidth, equals(fresh.maxIntrinsicWidth));
+  });
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2017 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "third_party/benchmark/include/benchmark/benchmark_api.h"
+
+#include <minikin/FontCollection.h>
+#include "lib/fxl/command_line.h"
+#include "lib/fxl/logging.h"
+#include "third_party/icu/source/common/unicode/unistr.h"
+#include "txt/font_collection.h"
+#include "utils.h"
+
+namespace txt {
+
+// Itemizes a long run of text. With an argument of 0 the text is Latin and
+// covered by the first font family. With an argument of 1 every sentence also
+// contains CJK characters that are matched to fallback fonts.
+static void BM_FontCollectionItemize(benchmark::State& state) {
+  std::string sentence =
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. ";
+  if (state.range(0) == 1)
+    sentence += "\xE4\xBD\xA0\xE5\xA5\xBD\xE4\xB8\x96\xE7\x95\x8C. ";
+  std::string text;
+  for (int i = 0; i < 50; ++i)
+    text += sentence;
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::vector<uint16_t> u16_text(icu_text.getBuffer(),
+                                 icu_text.getBuffer() + icu_text.length());
+
+  std::shared_ptr<minikin::FontCollection> collection =
+      GetTestFontCollection()->GetMinikinFontCollectionForFamily("Roboto");
+  minikin::FontStyle style;
+  std::vector<minikin::FontCollection::Run> runs;
+  while (state.KeepRunning()) {
+    runs.clear();
+    collection->itemize(u16_text.data(), u16_text.size(), style, &runs);
+  }
+  state.SetItemsProcessed(state.iterations() * u16_text.size());
+}
+BENCHMARK(BM_FontCollectionItemize)->Arg(0)->Arg(1);
+
+}  // namespace txt
@@ -100,6 +100,135 @@ static void BM_ParagraphLongLayout(benchmark::State& state) {
 }
 BENCHMARK(BM_ParagraphLongLayout);
 
+// Lays out the same long paragraph on several threads at once. All threads
+// share one font collection and the process wide layout caches.
+static void BM_ParagraphLongLayoutMultiThreaded(benchmark::State& state) {
+  static std::shared_ptr<FontCollection> font_collection =
+      GetTestFontCollection();
+
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilder builder(paragraph_style, font_collection);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = builder.Build();
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300, true);
+  }
+}
+BENCHMARK(BM_ParagraphLongLayoutMultiThreaded)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+// Lays out the same long paragraph at 50 widths, as during a resize animation
+// or when the framework probes the intrinsic widths. The word and run caches
+// start cold. With an argument of 1 the paragraph is relaid out, so only the
+// first width shapes the text. With 0 the paragraph is laid out from scratch
+// with cold caches for every width, as before relayout was supported.
+static void BM_ParagraphLayoutManyWidths(benchmark::State& state) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = builder.Build();
+  const bool relayout = state.range(0) != 0;
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    for (int i = 0; i < 50; ++i) {
+      if (!relayout || i == 0) {
+        minikin::Layout::purgeCaches();
+        txt::Paragraph::PurgeShapedRunCache();
+      }
+      if (!relayout)
+        paragraph->SetDirty();
+      paragraph->Layout(100 + i * 10);
+    }
+  }
+}
+BENCHMARK(BM_ParagraphLayoutManyWidths)->Arg(0)->Arg(1);
+
+// Lays out 1MB of text made of many lines, such as a log file, with the lines
+// broken on up to the given number of threads.
+static void BM_ParagraphParallelLineBreaks(benchmark::State& state) {
+  const char* line =
+      "12:00:00.000 I/flutter: Lorem ipsum dolor sit amet, consectetur "
+      "adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore "
+      "magna aliqua.\n";
+  auto icu_line = icu::UnicodeString::fromUTF8(line);
+  std::u16string u16_text;
+  while (u16_text.size() < 1024 * 1024) {
+    u16_text.append(icu_line.getBuffer(),
+                    icu_line.getBuffer() + icu_line.length());
+  }
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = builder.Build();
+  paragraph->SetMaxLineBreakThreads(state.range(0));
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300, true);
+  }
+}
+BENCHMARK(BM_ParagraphParallelLineBreaks)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
 static void BM_ParagraphJustifyLayout(benchmark::State& state) {
   const char* text =
       "This is a very long sentence to test if the text will properly wrap "
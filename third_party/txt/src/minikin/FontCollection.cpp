@@ -42,7 +42,7 @@ static inline T max(T a, T b) {
 const uint32_t EMOJI_STYLE_VS = 0xFE0F;
 const uint32_t TEXT_STYLE_VS = 0xFE0E;
 
-uint32_t FontCollection::sNextId = 0;
+std::atomic<uint32_t> FontCollection::sNextId(0);
 
 FontCollection::FontCollection(std::shared_ptr<FontFamily>&& typeface)
     : mMaxChar(0) {
@@ -59,7 +59,6 @@ FontCollection::FontCollection(
 
 void FontCollection::init(
     const vector<std::shared_ptr<FontFamily>>& typefaces) {
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
   mId = sNextId++;
   vector<uint32_t> lastChar;
   size_t nTypefaces = typefaces.size();
@@ -397,8 +396,6 @@ bool FontCollection::hasVariationSelector(uint32_t baseCodepoint,
     return false;
   }
 
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
-
   // Currently mRanges can not be used here since it isn't aware of the
   // variation sequence.
   for (size_t i = 0; i < mVSFamilyVec.size(); i++) {
@@ -499,6 +496,39 @@ void FontCollection::itemize(const uint16_t* string,
     }
     prevCh = ch;
     run->end = nextUtf16Pos;  // exclusive
+
+    // The first font family wins every character it covers. While it is in
+    // use, skip over the following characters that it covers in bulk instead
+    // of scoring the families for each of them.
+    if (lastFamily == mFamilies[0].get() && nextCh != kEndOfString) {
+      const uint16_t* rest = string + nextUtf16Pos;
+      size_t count = lastFamily->getCoverage().countCoveredPrefix(
+          rest, string_size - nextUtf16Pos);
+      // A character followed by a variation selector may be matched to
+      // another family, so leave variation selectors and the characters
+      // before them to the loop.
+      for (size_t i = 0; i < count; i++) {
+        if (isVariationSelector(rest[i])) {
+          count = i;
+          break;
+        }
+      }
+      if (count > 0 && nextUtf16Pos + count < string_size &&
+          (isVariationSelector(rest[count]) || U16_IS_LEAD(rest[count]))) {
+        count--;
+      }
+      if (count > 0) {
+        prevCh = rest[count - 1];
+        nextUtf16Pos += count;
+        run->end = nextUtf16Pos;
+        readLength = nextUtf16Pos;
+        if (readLength < string_size) {
+          U16_NEXT(string, readLength, string_size, nextCh);
+        } else {
+          nextCh = kEndOfString;
+        }
+      }
+    }
   } while (nextCh != kEndOfString);
 }
 
@@ -538,6 +568,13 @@ std::shared_ptr<FontCollection> FontCollection::createCollectionWithVariation(
   return std::shared_ptr<FontCollection>(new FontCollection(families));
 }
 
+std::shared_ptr<FontCollection> FontCollection::createCollectionWithFamilies(
+    const std::vector<std::shared_ptr<FontFamily>>& families) const {
+  std::shared_ptr<FontCollection> collection(new FontCollection(families));
+  collection->mId = mId;
+  return collection;
+}
+
 uint32_t FontCollection::getId() const {
   return mId;
 }
@@ -17,6 +17,7 @@
 #ifndef MINIKIN_FONT_COLLECTION_H
 #define MINIKIN_FONT_COLLECTION_H
 
+#include <atomic>
 #include <memory>
 #include <unordered_set>
 #include <vector>
@@ -66,6 +67,13 @@ class FontCollection {
   std::shared_ptr<FontCollection> createCollectionWithVariation(
       const std::vector<FontVariation>& variations);
 
+  // libtxt extension: creates a new FontCollection of |families| that keeps
+  // the id of this collection, so that layouts cached for this collection are
+  // reused. |families| must start with the families of this collection and
+  // only add families that its fallback font provider has returned.
+  std::shared_ptr<FontCollection> createCollectionWithFamilies(
+      const std::vector<std::shared_ptr<FontFamily>>& families) const;
+
   const std::unordered_set<AxisTag>& getSupportedTags() const {
     return mSupportedAxes;
   }
@@ -117,7 +125,7 @@ class FontCollection {
                                            const FontFamily& fontFamily);
 
   // static for allocating unique id's
-  static uint32_t sNextId;
+  static std::atomic<uint32_t> sNextId;
 
   // unique id for this font collection (suitable for cache key)
   uint32_t mId;
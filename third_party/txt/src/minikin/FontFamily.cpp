@@ -56,7 +56,6 @@ android::hash_t FontStyle::hash() const {
 
 // static
 uint32_t FontStyle::registerLanguageList(const std::string& languages) {
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
   return FontLanguageListCache::getId(languages);
 }
 
@@ -72,7 +71,7 @@ Font::Font(const std::shared_ptr<MinikinFont>& typeface, FontStyle style)
 Font::Font(std::shared_ptr<MinikinFont>&& typeface, FontStyle style)
     : typeface(typeface), style(style) {}
 
-std::unordered_set<AxisTag> Font::getSupportedAxesLocked() const {
+std::unordered_set<AxisTag> Font::getSupportedAxes() const {
   const uint32_t fvarTag = MinikinFont::MakeTag('f', 'v', 'a', 'r');
   HbBlob fvarTable(getFontTable(typeface.get(), fvarTag));
   if (fvarTable.size() == 0) {
@@ -115,7 +114,6 @@ FontFamily::FontFamily(uint32_t langId, int variant, std::vector<Font>&& fonts)
 bool FontFamily::analyzeStyle(const std::shared_ptr<MinikinFont>& typeface,
                               int* weight,
                               bool* italic) {
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
   const uint32_t os2Tag = MinikinFont::MakeTag('O', 'S', '/', '2');
   HbBlob os2Table(getFontTable(typeface.get(), os2Tag));
   if (os2Table.get() == nullptr)
@@ -175,7 +173,6 @@ bool FontFamily::isColorEmojiFamily() const {
 }
 
 void FontFamily::computeCoverage() {
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
   const FontStyle defaultStyle;
   const MinikinFont* typeface = getClosestMatch(defaultStyle).font;
   const uint32_t cmapTag = MinikinFont::MakeTag('c', 'm', 'a', 'p');
@@ -189,14 +186,13 @@ void FontFamily::computeCoverage() {
 
   for (size_t i = 0; i < mFonts.size(); ++i) {
     std::unordered_set<AxisTag> supportedAxes =
-        mFonts[i].getSupportedAxesLocked();
+        mFonts[i].getSupportedAxes();
     mSupportedAxes.insert(supportedAxes.begin(), supportedAxes.end());
   }
 }
 
 bool FontFamily::hasGlyph(uint32_t codepoint,
                           uint32_t variationSelector) const {
-  assertMinikinLocked();
   if (variationSelector != 0 && !mHasVSTable) {
     // Early exit if the variation selector is specified but the font doesn't
     // have a cmap format 14 subtable.
@@ -204,7 +200,7 @@ bool FontFamily::hasGlyph(uint32_t codepoint,
   }
 
   const FontStyle defaultStyle;
-  hb_font_t* font = getHbFontLocked(getClosestMatch(defaultStyle).font);
+  hb_font_t* font = getHbFont(getClosestMatch(defaultStyle).font);
   uint32_t unusedGlyph;
   bool result =
       hb_font_get_glyph(font, codepoint, variationSelector, &unusedGlyph);
@@ -233,8 +229,7 @@ std::shared_ptr<FontFamily> FontFamily::createFamilyWithVariation(
   std::vector<Font> fonts;
   for (const Font& font : mFonts) {
     bool supportedVariations = false;
-    std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
-    std::unordered_set<AxisTag> supportedAxes = font.getSupportedAxesLocked();
+    std::unordered_set<AxisTag> supportedAxes = font.getSupportedAxes();
     if (!supportedAxes.empty()) {
       for (const FontVariation& variation : variations) {
         if (supportedAxes.find(variation.axisTag) != supportedAxes.end()) {
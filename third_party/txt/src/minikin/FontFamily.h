@@ -120,7 +120,7 @@ struct Font {
   std::shared_ptr<MinikinFont> typeface;
   FontStyle style;
 
-  std::unordered_set<AxisTag> getSupportedAxesLocked() const;
+  std::unordered_set<AxisTag> getSupportedAxes() const;
 };
 
 struct FontVariation {
@@ -161,7 +161,7 @@ class FontFamily {
   const SparseBitSet& getCoverage() const { return mCoverage; }
 
   // Returns true if the font has a glyph for the code point and variation
-  // selector pair. Caller should acquire a lock before calling the method.
+  // selector pair.
   bool hasGlyph(uint32_t codepoint, uint32_t variationSelector) const;
 
   // Returns true if this font family has a variaion sequence table (cmap format
@@ -121,6 +121,7 @@ static std::vector<FontLanguage> parseLanguageList(const std::string& input) {
 // static
 uint32_t FontLanguageListCache::getId(const std::string& languages) {
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
+  std::lock_guard<std::mutex> _l(inst->mMutex);
   std::unordered_map<std::string, uint32_t>::const_iterator it =
       inst->mLanguageListLookupTable.find(languages);
   if (it != inst->mLanguageListLookupTable.end()) {
@@ -142,6 +143,7 @@ uint32_t FontLanguageListCache::getId(const std::string& languages) {
 // static
 const FontLanguages& FontLanguageListCache::getById(uint32_t id) {
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
+  std::lock_guard<std::mutex> _l(inst->mMutex);
   LOG_ALWAYS_FATAL_IF(id >= inst->mLanguageLists.size(),
                       "Lookup by unknown language list ID.");
   return inst->mLanguageLists[id];
@@ -149,17 +151,16 @@ const FontLanguages& FontLanguageListCache::getById(uint32_t id) {
 
 // static
 FontLanguageListCache* FontLanguageListCache::getInstance() {
-  assertMinikinLocked();
-  static FontLanguageListCache* instance = nullptr;
-  if (instance == nullptr) {
-    instance = new FontLanguageListCache();
+  static FontLanguageListCache* instance = [] {
+    FontLanguageListCache* cache = new FontLanguageListCache();
 
     // Insert an empty language list for mapping default language list to
     // kEmptyListId. The default language list has only one FontLanguage and it
     // is the unsupported language.
-    instance->mLanguageLists.push_back(FontLanguages());
-    instance->mLanguageListLookupTable.insert(std::make_pair("", kEmptyListId));
-  }
+    cache->mLanguageLists.push_back(FontLanguages());
+    cache->mLanguageListLookupTable.insert(std::make_pair("", kEmptyListId));
+    return cache;
+  }();
   return instance;
 }
 
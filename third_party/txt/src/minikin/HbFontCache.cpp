@@ -18,6 +18,9 @@
 
 #include "HbFontCache.h"
 
+#include <mutex>
+#include <unordered_map>
+
 #include <log/log.h>
 #include <utils/LruCache.h>
 
@@ -29,64 +32,135 @@
 
 namespace minikin {
 
+// Fonts are evicted by an estimate of the memory they hold. HarfBuzz copies
+// the tables it reads out of the font, so a font with large tables (CJK fonts
+// with big cmap, hmtx and GSUB tables) weighs far more than a Latin one.
 class HbFontCache : private android::OnEntryRemoved<int32_t, hb_font_t*> {
  public:
-  HbFontCache() : mCache(kMaxEntries) {
+  HbFontCache()
+      : mCache(android::LruCache<int32_t, hb_font_t*>::kUnlimitedCapacity),
+        mBudget(kDefaultBudget),
+        mHits(0),
+        mMisses(0),
+        mEvictions(0),
+        mBytes(0) {
     mCache.setOnEntryRemovedListener(this);
   }
 
   // callback for OnEntryRemoved
-  void operator()(int32_t& /* key */, hb_font_t*& value) {
+  void operator()(int32_t& key, hb_font_t*& value) {
+    auto it = mFontBytes.find(key);
+    mBytes -= it->second;
+    mFontBytes.erase(it);
     hb_font_destroy(value);
   }
 
-  hb_font_t* get(int32_t fontId) { return mCache.get(fontId); }
+  hb_font_t* get(int32_t fontId) {
+    hb_font_t* font = mCache.get(fontId);
+    if (font != nullptr) {
+      mHits++;
+    } else {
+      mMisses++;
+    }
+    return font;
+  }
 
-  void put(int32_t fontId, hb_font_t* font) { mCache.put(fontId, font); }
+  void put(int32_t fontId, hb_font_t* font, size_t bytes) {
+    mFontBytes[fontId] = bytes;
+    mBytes += bytes;
+    mCache.put(fontId, font);
+    trim();
+  }
 
   void clear() { mCache.clear(); }
 
   void remove(int32_t fontId) { mCache.remove(fontId); }
 
+  void setBudget(size_t bytes) {
+    mBudget = bytes;
+    trim();
+  }
+
+  CacheStats getStats() const {
+    CacheStats stats;
+    stats.hits = mHits;
+    stats.misses = mMisses;
+    stats.evictions = mEvictions;
+    stats.entries = mCache.size();
+    stats.bytes = mBytes;
+    stats.budget = mBudget;
+    return stats;
+  }
+
  private:
-  static const size_t kMaxEntries = 100;
+  static const size_t kDefaultBudget = 8 * 1024 * 1024;
+
+  void trim() {
+    while (mBytes > mBudget && mCache.removeOldest()) {
+      mEvictions++;
+    }
+  }
 
   android::LruCache<int32_t, hb_font_t*> mCache;
+  std::unordered_map<int32_t, size_t> mFontBytes;
+  size_t mBudget;
+  size_t mHits;
+  size_t mMisses;
+  size_t mEvictions;
+  size_t mBytes;
 };
 
-HbFontCache* getFontCacheLocked() {
-  assertMinikinLocked();
-  static HbFontCache* cache = nullptr;
-  if (cache == nullptr) {
-    cache = new HbFontCache();
+// The tables HarfBuzz reads to map characters to glyphs, to measure glyphs and
+// to shape runs. Not all of them are read for every font, so this
+// overestimates fonts that are only used to measure text.
+static const uint32_t kHbFontTables[] = {
+    HB_TAG('c', 'm', 'a', 'p'), HB_TAG('h', 'e', 'a', 'd'),
+    HB_TAG('h', 'h', 'e', 'a'), HB_TAG('h', 'm', 't', 'x'),
+    HB_TAG('m', 'a', 'x', 'p'), HB_TAG('G', 'D', 'E', 'F'),
+    HB_TAG('G', 'S', 'U', 'B'), HB_TAG('G', 'P', 'O', 'S'),
+};
+
+// Allowance for the font objects and the shaping plans cached on the face.
+static const size_t kHbFontOverhead = 4 * 1024;
+
+static size_t getHbFontMemoryUsage(const MinikinFont* minikinFont) {
+  size_t bytes = kHbFontOverhead;
+  for (uint32_t tag : kHbFontTables) {
+    bytes += minikinFont->GetTableSize(tag);
   }
+  return bytes;
+}
+
+// Guards the font cache. Fonts handed out are references of their own, so
+// they stay valid when they are evicted while in use on another thread.
+static std::mutex gHbFontCacheLock;
+
+HbFontCache* getFontCacheLocked() {
+  static HbFontCache* cache = new HbFontCache();
   return cache;
 }
 
-void purgeHbFontCacheLocked() {
-  assertMinikinLocked();
+void purgeHbFontCache() {
+  std::lock_guard<std::mutex> _l(gHbFontCacheLock);
   getFontCacheLocked()->clear();
 }
 
-void purgeHbFontLocked(const MinikinFont* minikinFont) {
-  assertMinikinLocked();
+void purgeHbFont(const MinikinFont* minikinFont) {
+  std::lock_guard<std::mutex> _l(gHbFontCacheLock);
   const int32_t fontId = minikinFont->GetUniqueId();
   getFontCacheLocked()->remove(fontId);
 }
 
 // Returns a new reference to a hb_font_t object, caller is
 // responsible for calling hb_font_destroy() on it.
-hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
-  assertMinikinLocked();
+hb_font_t* getHbFont(const MinikinFont* minikinFont) {
   // TODO: get rid of nullFaceFont
-  static hb_font_t* nullFaceFont = nullptr;
+  static hb_font_t* nullFaceFont = hb_font_create(nullptr);
   if (minikinFont == nullptr) {
-    if (nullFaceFont == nullptr) {
-      nullFaceFont = hb_font_create(nullptr);
-    }
     return hb_font_reference(nullFaceFont);
   }
 
+  std::lock_guard<std::mutex> _l(gHbFontCacheLock);
   HbFontCache* fontCache = getFontCacheLocked();
   const int32_t fontId = minikinFont->GetUniqueId();
   hb_font_t* font = fontCache->get(fontId);
@@ -110,8 +184,21 @@ hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
   hb_font_set_variations(font, variations.data(), variations.size());
   hb_font_destroy(parent_font);
   hb_face_destroy(face);
-  fontCache->put(fontId, font);
-  return hb_font_reference(font);
+  // Take the reference first: a font larger than the budget is evicted as
+  // soon as it is put in the cache.
+  hb_font_reference(font);
+  fontCache->put(fontId, font, getHbFontMemoryUsage(minikinFont));
+  return font;
+}
+
+void setHbFontCacheBudget(size_t bytes) {
+  std::lock_guard<std::mutex> _l(gHbFontCacheLock);
+  getFontCacheLocked()->setBudget(bytes);
+}
+
+CacheStats getHbFontCacheStats() {
+  std::lock_guard<std::mutex> _l(gHbFontCacheLock);
+  return getFontCacheLocked()->getStats();
 }
 
 }  // namespace minikin
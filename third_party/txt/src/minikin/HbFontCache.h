@@ -17,14 +17,22 @@
 #ifndef MINIKIN_HBFONT_CACHE_H
 #define MINIKIN_HBFONT_CACHE_H
 
+#include <minikin/Layout.h>
+
 struct hb_font_t;
 
 namespace minikin {
 class MinikinFont;
 
-void purgeHbFontCacheLocked();
-void purgeHbFontLocked(const MinikinFont* minikinFont);
-hb_font_t* getHbFontLocked(const MinikinFont* minikinFont);
+// The HarfBuzz font cache is safe to use from any thread.
+void purgeHbFontCache();
+void purgeHbFont(const MinikinFont* minikinFont);
+hb_font_t* getHbFont(const MinikinFont* minikinFont);
+
+// Sets the number of bytes the fonts in the cache may hold. The cache is
+// trimmed right away if it holds more than that.
+void setHbFontCacheBudget(size_t bytes);
+CacheStats getHbFontCacheStats();
 
 }  // namespace minikin
 #endif  // MINIKIN_HBFONT_CACHE_H
@@ -20,8 +20,11 @@
 #include <unicode/ubidi.h>
 #include <unicode/utf16.h>
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>  // for debugging
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -51,11 +54,12 @@ const int kDirection_Mask = 0x1;
 struct LayoutContext {
   MinikinPaint paint;
   FontStyle style;
-  std::vector<hb_font_t*> hbFonts;  // parallel to mFaces
+  // Parallel to mFaces. These are sub fonts of the cached fonts, which are
+  // shared by all threads, so that each layout can set its own size on them.
+  std::vector<hb_font_t*> hbFonts;
 
   void clearHbFonts() {
     for (size_t i = 0; i < hbFonts.size(); i++) {
-      hb_font_set_funcs(hbFonts[i], nullptr, nullptr, nullptr);
       hb_font_destroy(hbFonts[i]);
     }
     hbFonts.clear();
@@ -102,6 +106,11 @@ class LayoutCacheKey {
     mChars = NULL;
   }
 
+  // The key holds a copy of the text of the word once it is cached.
+  size_t getMemoryUsage() const {
+    return sizeof(LayoutCacheKey) + mNchars * sizeof(uint16_t);
+  }
+
   void doLayout(Layout* layout,
                 LayoutContext* ctx,
                 const std::shared_ptr<FontCollection>& collection) const {
@@ -132,42 +141,149 @@ class LayoutCacheKey {
   android::hash_t computeHash() const;
 };
 
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
+// The layout cache is split into shards by key hash, each with a lock of its
+// own, so that threads laying out text at the same time rarely contend. Words
+// are laid out without holding any lock. Cached layouts are shared with the
+// callers, which keeps them alive when they are evicted while still in use.
+//
+// Entries are evicted by the memory they hold rather than by their number:
+// text that is not broken up by spaces or ideographs (kana, Thai, long URLs)
+// is cached as words as long as the whole run, while the words of short labels
+// hold a few dozen bytes each. Every shard gets an equal part of the budget.
+class LayoutCache {
  public:
-  LayoutCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
+  LayoutCache() : mBudget(kDefaultBudget) {}
+
+  void clear() {
+    for (Shard& shard : mShards) {
+      std::lock_guard<std::mutex> _l(shard.mutex);
+      shard.cache.clear();
+    }
+  }
+
+  void setBudget(size_t bytes) {
+    mBudget = bytes;
+    for (Shard& shard : mShards) {
+      std::lock_guard<std::mutex> _l(shard.mutex);
+      shard.trim(bytes / kShardCount);
+    }
   }
 
-  void clear() { mCache.clear(); }
+  CacheStats getStats() {
+    CacheStats stats = {};
+    for (Shard& shard : mShards) {
+      std::lock_guard<std::mutex> _l(shard.mutex);
+      stats.hits += shard.hits;
+      stats.misses += shard.misses;
+      stats.evictions += shard.evictions;
+      stats.entries += shard.cache.size();
+      stats.bytes += shard.bytes;
+    }
+    stats.budget = mBudget;
+    return stats;
+  }
 
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
+  std::shared_ptr<Layout> get(
+      LayoutCacheKey& key,
+      LayoutContext* ctx,
+      const std::shared_ptr<FontCollection>& collection) {
+    Shard& shard = mShards[key.hash() % kShardCount];
+    {
+      std::lock_guard<std::mutex> _l(shard.mutex);
+      std::shared_ptr<Layout> layout = shard.cache.get(key);
+      if (layout != nullptr) {
+        shard.hits++;
+        return layout;
+      }
+      shard.misses++;
+    }
+
+    auto layout = std::make_shared<Layout>();
+    key.doLayout(layout.get(), ctx, collection);
+
+    std::lock_guard<std::mutex> _l(shard.mutex);
+    // Another thread may have laid out the same word in the meantime.
+    if (shard.cache.get(key) == nullptr) {
       key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
+      shard.bytes += key.getMemoryUsage() + layout->getMemoryUsage();
+      shard.cache.put(key, layout);
+      shard.trim(mBudget / kShardCount);
     }
     return layout;
   }
 
  private:
-  // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
-    key.freeText();
-    delete value;
-  }
+  static const size_t kDefaultBudget = 4 * 1024 * 1024;
+  static const size_t kShardCount = 16;
+
+  struct Shard : private android::OnEntryRemoved<LayoutCacheKey,
+                                                 std::shared_ptr<Layout>> {
+    Shard()
+        : cache(android::LruCache<LayoutCacheKey, std::shared_ptr<Layout>>::
+                    kUnlimitedCapacity),
+          hits(0),
+          misses(0),
+          evictions(0),
+          bytes(0) {
+      cache.setOnEntryRemovedListener(this);
+    }
+
+    // callback for OnEntryRemoved
+    void operator()(LayoutCacheKey& key, std::shared_ptr<Layout>& value) {
+      bytes -= key.getMemoryUsage() + value->getMemoryUsage();
+      key.freeText();
+      value = nullptr;
+    }
 
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
+    void trim(size_t budget) {
+      while (bytes > budget && cache.removeOldest()) {
+        evictions++;
+      }
+    }
+
+    std::mutex mutex;
+    android::LruCache<LayoutCacheKey, std::shared_ptr<Layout>> cache;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t bytes;
+  };
+
+  std::atomic<size_t> mBudget;
+  Shard mShards[kShardCount];
+};
+
+// HarfBuzz buffers may only be used by one thread at a time. Each layout run
+// borrows a buffer from this pool, which grows to the number of threads that
+// lay out text at the same time.
+class HbBufferPool {
+ public:
+  explicit HbBufferPool(hb_unicode_funcs_t* unicodeFunctions)
+      : mUnicodeFunctions(unicodeFunctions) {}
+
+  hb_buffer_t* acquire() {
+    {
+      std::lock_guard<std::mutex> _l(mMutex);
+      if (!mBuffers.empty()) {
+        hb_buffer_t* buffer = mBuffers.back();
+        mBuffers.pop_back();
+        return buffer;
+      }
+    }
+    hb_buffer_t* buffer = hb_buffer_create();
+    hb_buffer_set_unicode_funcs(buffer, mUnicodeFunctions);
+    return buffer;
+  }
 
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
+  void release(hb_buffer_t* buffer) {
+    std::lock_guard<std::mutex> _l(mMutex);
+    mBuffers.push_back(buffer);
+  }
 
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
+ private:
+  hb_unicode_funcs_t* mUnicodeFunctions;
+  std::mutex mMutex;
+  std::vector<hb_buffer_t*> mBuffers;
 };
 
 static unsigned int disabledDecomposeCompatibility(hb_unicode_funcs_t*,
@@ -184,12 +300,11 @@ class LayoutEngine {
     /* Disable the function used for compatibility decomposition */
     hb_unicode_funcs_set_decompose_compatibility_func(
         unicodeFunctions, disabledDecomposeCompatibility, NULL, NULL);
-    hbBuffer = hb_buffer_create();
-    hb_buffer_set_unicode_funcs(hbBuffer, unicodeFunctions);
+    hbBuffers.reset(new HbBufferPool(unicodeFunctions));
   }
 
-  hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
+  std::unique_ptr<HbBufferPool> hbBuffers;
   LayoutCache layoutCache;
 
   static LayoutEngine& getInstance() {
@@ -198,6 +313,22 @@ class LayoutEngine {
   }
 };
 
+// Returns a HarfBuzz buffer for exclusive use until it goes out of scope.
+class ScopedHbBuffer {
+ public:
+  ScopedHbBuffer()
+      : mBuffer(LayoutEngine::getInstance().hbBuffers->acquire()) {}
+
+  ~ScopedHbBuffer() {
+    LayoutEngine::getInstance().hbBuffers->release(mBuffer);
+  }
+
+  hb_buffer_t* get() const { return mBuffer; }
+
+ private:
+  hb_buffer_t* mBuffer;
+};
+
 bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
   return mId == other.mId && mStart == other.mStart && mCount == other.mCount &&
          mStyle == other.mStyle && mSize == other.mSize &&
@@ -267,34 +398,31 @@ static hb_bool_t harfbuzzGetGlyphHorizontalOrigin(hb_font_t* /* hbFont */,
   return true;
 }
 
-hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
-  assertMinikinLocked();
-
-  static hb_font_funcs_t* hbFuncs = nullptr;
-  static hb_font_funcs_t* hbFuncsForColorBitmap = nullptr;
-
-  hb_font_funcs_t** funcs =
-      forColorBitmapFont ? &hbFuncs : &hbFuncsForColorBitmap;
-  if (*funcs == nullptr) {
-    *funcs = hb_font_funcs_create();
-    if (forColorBitmapFont) {
-      // Don't override the h_advance function since we use HarfBuzz's
-      // implementation for emoji for performance reasons. Note that it is
-      // technically possible for a TrueType font to have outline and embedded
-      // bitmap at the same time. We ignore modified advances of hinted outline
-      // glyphs in that case.
-    } else {
-      // Override the h_advance function since we can't use HarfBuzz's
-      // implemenation. It may return the wrong value if the font uses hinting
-      // aggressively.
-      hb_font_funcs_set_glyph_h_advance_func(
-          *funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
-    }
-    hb_font_funcs_set_glyph_h_origin_func(
-        *funcs, harfbuzzGetGlyphHorizontalOrigin, 0, 0);
-    hb_font_funcs_make_immutable(*funcs);
+static hb_font_funcs_t* createHbFontFuncs(bool forColorBitmapFont) {
+  hb_font_funcs_t* funcs = hb_font_funcs_create();
+  if (forColorBitmapFont) {
+    // Don't override the h_advance function since we use HarfBuzz's
+    // implementation for emoji for performance reasons. Note that it is
+    // technically possible for a TrueType font to have outline and embedded
+    // bitmap at the same time. We ignore modified advances of hinted outline
+    // glyphs in that case.
+  } else {
+    // Override the h_advance function since we can't use HarfBuzz's
+    // implemenation. It may return the wrong value if the font uses hinting
+    // aggressively.
+    hb_font_funcs_set_glyph_h_advance_func(
+        funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
   }
-  return *funcs;
+  hb_font_funcs_set_glyph_h_origin_func(funcs, harfbuzzGetGlyphHorizontalOrigin,
+                                        0, 0);
+  hb_font_funcs_make_immutable(funcs);
+  return funcs;
+}
+
+hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
+  static hb_font_funcs_t* hbFuncs = createHbFontFuncs(false);
+  static hb_font_funcs_t* hbFuncsForColorBitmap = createHbFontFuncs(true);
+  return forColorBitmapFont ? hbFuncsForColorBitmap : hbFuncs;
 }
 
 static bool isColorBitmapFont(hb_font_t* font) {
@@ -330,7 +458,9 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
   // Note: ctx == NULL means we're copying from the cache, no need to create
   // corresponding hb_font object.
   if (ctx != NULL) {
-    hb_font_t* font = getHbFontLocked(face.font);
+    hb_font_t* cachedFont = getHbFont(face.font);
+    hb_font_t* font = hb_font_create_sub_font(cachedFont);
+    hb_font_destroy(cachedFont);
     // Temporarily removed to fix advance integer rounding.
     // This is likely due to very old versions of harfbuzz and ICU.
     // hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(font)),
@@ -341,10 +471,7 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
 }
 
 static hb_script_t codePointToScript(hb_codepoint_t codepoint) {
-  static hb_unicode_funcs_t* u = 0;
-  if (!u) {
-    u = LayoutEngine::getInstance().unicodeFunctions;
-  }
+  static hb_unicode_funcs_t* u = LayoutEngine::getInstance().unicodeFunctions;
   return hb_unicode_script(u, codepoint);
 }
 
@@ -604,8 +731,6 @@ void Layout::doLayout(const uint16_t* buf,
                       const FontStyle& style,
                       const MinikinPaint& paint,
                       const std::shared_ptr<FontCollection>& collection) {
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -628,8 +753,6 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -736,9 +859,9 @@ float Layout::doLayoutWord(const uint16_t* buf,
     }
     advance = layoutForWord.getAdvance();
   } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
+    std::shared_ptr<Layout> layoutForWord = cache.get(key, ctx, collection);
     if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
+      layout->appendLayout(layoutForWord.get(), bufStart, wordSpacing);
     }
     if (advances) {
       layoutForWord->getAdvances(advances);
@@ -763,7 +886,7 @@ static void addFeatures(const string& str, vector<hb_feature_t>* features) {
   const char* end = start + str.size();
 
   while (start < end) {
-    static hb_feature_t feature;
+    hb_feature_t feature;
     const char* p = strchr(start, ',');
     if (!p)
       p = end;
@@ -934,7 +1057,8 @@ void Layout::doLayoutRun(const uint16_t* buf,
                          bool isRtl,
                          LayoutContext* ctx,
                          const std::shared_ptr<FontCollection>& collection) {
-  hb_buffer_t* buffer = LayoutEngine::getInstance().hbBuffer;
+  ScopedHbBuffer scopedBuffer;
+  hb_buffer_t* buffer = scopedBuffer.get();
   vector<FontCollection::Run> items;
   collection->itemize(buf + start, count, ctx->style, &items);
 
@@ -1196,11 +1320,24 @@ void Layout::getBounds(MinikinRect* bounds) const {
   bounds->set(mBounds);
 }
 
+size_t Layout::getMemoryUsage() const {
+  return sizeof(Layout) + mGlyphs.capacity() * sizeof(LayoutGlyph) +
+         mAdvances.capacity() * sizeof(float) +
+         mFaces.capacity() * sizeof(FakedFont);
+}
+
 void Layout::purgeCaches() {
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
   LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
   layoutCache.clear();
-  purgeHbFontCacheLocked();
+  purgeHbFontCache();
+}
+
+void Layout::setCacheBudget(size_t bytes) {
+  LayoutEngine::getInstance().layoutCache.setBudget(bytes);
+}
+
+CacheStats Layout::getCacheStats() {
+  return LayoutEngine::getInstance().layoutCache.getStats();
 }
 
 }  // namespace minikin
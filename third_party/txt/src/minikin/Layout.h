@@ -42,6 +42,18 @@ struct LayoutGlyph {
 // Internal state used during layout operation
 struct LayoutContext;
 
+// Counters of one of the caches shared by all layouts. |bytes| is an estimate
+// of the memory held by the |entries| currently in the cache, which evicts the
+// least recently used entries when |bytes| exceeds |budget|.
+struct CacheStats {
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+  size_t entries;
+  size_t bytes;
+  size_t budget;
+};
+
 enum {
   kBidi_LTR = 0,
   kBidi_RTL = 1,
@@ -109,9 +121,18 @@ class Layout {
 
   void getBounds(MinikinRect* rect) const;
 
+  // Approximate number of bytes of memory held by this layout.
+  size_t getMemoryUsage() const;
+
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  // Sets the number of bytes the cache of laid out words may hold. The cache
+  // is trimmed right away if it holds more than that.
+  static void setCacheBudget(size_t bytes);
+
+  static CacheStats getCacheStats();
+
  private:
   friend class LayoutCacheKey;
 
@@ -171,6 +171,16 @@ class LineBreaker {
                     size_t end,
                     bool isRtl);
 
+  // Same as addStyleRun, but takes the widths of the characters in the range
+  // from the width buffer instead of measuring the text. Used to break text
+  // that was measured before at another line width.
+  float addMeasuredStyleRun(MinikinPaint* paint,
+                            const std::shared_ptr<FontCollection>& typeface,
+                            FontStyle style,
+                            size_t start,
+                            size_t end,
+                            bool isRtl);
+
   void addReplacement(size_t start, size_t end, float width);
 
   size_t computeBreaks();
@@ -225,6 +235,14 @@ class LineBreaker {
 
   float getSpaceWidth() const;
 
+  float addStyleRunImpl(MinikinPaint* paint,
+                        const std::shared_ptr<FontCollection>& typeface,
+                        FontStyle style,
+                        size_t start,
+                        size_t end,
+                        bool isRtl,
+                        bool measure);
+
   void computeBreaksGreedy();
 
   void computeBreaksOptimal(bool isRectangular);
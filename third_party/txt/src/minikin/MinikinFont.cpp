@@ -21,8 +21,7 @@
 namespace minikin {
 
 MinikinFont::~MinikinFont() {
-  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
-  purgeHbFontLocked(this);
+  purgeHbFont(this);
 }
 
 }  // namespace minikin
@@ -103,6 +103,10 @@ class MinikinFont {
 
   virtual hb_face_t* CreateHarfBuzzFace() const { return nullptr; }
 
+  // Returns the size in bytes of the font table with the given tag, or 0 if
+  // the font has no such table or the size is unknown.
+  virtual size_t GetTableSize(uint32_t /* tag */) const { return 0; }
+
   virtual const std::vector<minikin::FontVariation>& GetAxes() const = 0;
 
   virtual std::shared_ptr<MinikinFont> createFontWithVariation(
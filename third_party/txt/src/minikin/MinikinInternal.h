@@ -19,8 +19,6 @@
 #ifndef MINIKIN_INTERNAL_H
 #define MINIKIN_INTERNAL_H
 
-#include <mutex>
-
 #include <hb.h>
 
 #include <minikin/MinikinFont.h>
@@ -28,13 +26,10 @@
 namespace minikin {
 
 // All external Minikin interfaces are designed to be thread-safe.
-// Presently, that's implemented by through a global lock, and having
-// all external interfaces take that lock.
-
-extern std::recursive_mutex gMinikinLock;
-
-// Aborts if gMinikinLock is not acquired. Do nothing on the release build.
-void assertMinikinLocked();
+// Fonts, font families and font collections are immutable once created. The
+// caches shared between threads (layouts, HarfBuzz fonts and language lists)
+// are each guarded by a lock of their own, which is only held while the cache
+// is looked up or updated and never while text is shaped.
 
 hb_blob_t* getFontTable(const MinikinFont* minikinFont, uint32_t tag);
 
@@ -107,6 +107,31 @@ void SparseBitSet::initFromRanges(const uint32_t* ranges, size_t nRanges) {
   }
 }
 
+size_t SparseBitSet::countCoveredPrefix(const uint16_t* text,
+                                        size_t count) const {
+  // Text mostly stays within a few pages, so only look up the bitmap of a page
+  // when the text moves to another page.
+  uint32_t currentPage = kNotFound;
+  const element* bitmap = nullptr;
+  for (size_t i = 0; i < count; i++) {
+    const uint32_t ch = text[i];
+    if (ch >= mMaxVal || (ch & 0xF800) == 0xD800) {
+      return i;
+    }
+    const uint32_t page = ch >> kLogValuesPerPage;
+    if (page != currentPage) {
+      currentPage = page;
+      bitmap = &mBitmaps[mIndices[page]];
+    }
+    const uint32_t index = ch & kPageMask;
+    if ((bitmap[index >> kLogBitsPerEl] & (kElFirst >> (index & kElMask))) ==
+        0) {
+      return i;
+    }
+  }
+  return count;
+}
+
 #if defined(_WIN32)
 int SparseBitSet::CountLeadingZeros(element x) {
   return sizeof(element) <= sizeof(int) ? clz_win(x) : clzl_win(x);
@@ -56,6 +56,12 @@ class SparseBitSet {
            0;
   }
 
+  // The number of leading code units of the UTF-16 |text| that are in the set.
+  // Stops at the first code unit that is not in the set or is a surrogate.
+  // This checks a whole run of text much faster than calling get() for each
+  // character.
+  size_t countCoveredPrefix(const uint16_t* text, size_t count) const;
+
   // One more than the maximum value in the set, or zero if empty
   uint32_t length() const { return mMaxVal; }
 
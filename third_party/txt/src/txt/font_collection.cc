@@ -60,23 +60,31 @@ FontCollection::FontCollection() : enable_font_fallback_(true) {}
 FontCollection::~FontCollection() = default;
 
 size_t FontCollection::GetFontManagersCount() const {
-  return GetFontManagerOrder().size();
+  std::lock_guard<std::mutex> lock(mutex_);
+  return GetFontManagerOrderLocked().size();
 }
 
 void FontCollection::SetDefaultFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::lock_guard<std::mutex> lock(mutex_);
   default_font_manager_ = font_manager;
+  fallback_match_cache_.clear();
 }
 
 void FontCollection::SetAssetFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::lock_guard<std::mutex> lock(mutex_);
   asset_font_manager_ = font_manager;
+  fallback_match_cache_.clear();
 }
 
 void FontCollection::SetTestFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::lock_guard<std::mutex> lock(mutex_);
   test_font_manager_ = font_manager;
+  fallback_match_cache_.clear();
 }
 
 // Return the available font managers in the order they should be queried.
-std::vector<sk_sp<SkFontMgr>> FontCollection::GetFontManagerOrder() const {
+std::vector<sk_sp<SkFontMgr>> FontCollection::GetFontManagerOrderLocked()
+    const {
   std::vector<sk_sp<SkFontMgr>> order;
   if (test_font_manager_)
     order.push_back(test_font_manager_);
@@ -88,18 +96,39 @@ std::vector<sk_sp<SkFontMgr>> FontCollection::GetFontManagerOrder() const {
 }
 
 void FontCollection::DisableFontFallback() {
+  std::lock_guard<std::mutex> lock(mutex_);
   enable_font_fallback_ = false;
 }
 
 std::shared_ptr<minikin::FontCollection>
 FontCollection::GetMinikinFontCollectionForFamily(const std::string& family) {
-  // Look inside the font collections cache first.
+  std::lock_guard<std::mutex> lock(mutex_);
+  return GetMinikinFontCollectionForFamilyLocked(family);
+}
+
+std::shared_ptr<minikin::FontCollection>
+FontCollection::GetMinikinFontCollectionForFamilyLocked(
+    const std::string& family) {
+  // Look inside the font collections cache first. Collections created before
+  // more fallback fonts were discovered are replaced with new collections that
+  // include them, reusing the family that was already matched. A minikin
+  // collection cannot grow while other threads lay out text with it, so the
+  // new one takes over the id of the old one instead, and words shaped with
+  // the old one stay in the layout cache. They were shaped with fallback fonts
+  // that the new collection contains.
   auto cached = font_collections_cache_.find(family);
   if (cached != font_collections_cache_.end()) {
-    return cached->second;
+    CachedFontCollection& entry = cached->second;
+    if (enable_font_fallback_ &&
+        entry.fallback_count != fallback_fonts_.size()) {
+      entry.collection = CreateMinikinFontCollectionLocked(
+          entry.primary_family, entry.collection);
+      entry.fallback_count = fallback_fonts_.size();
+    }
+    return entry.collection;
   }
 
-  for (sk_sp<SkFontMgr>& manager : GetFontManagerOrder()) {
+  for (sk_sp<SkFontMgr>& manager : GetFontManagerOrderLocked()) {
     auto font_style_set = manager->matchFamily(family.c_str());
     if (font_style_set == nullptr || font_style_set->count() == 0) {
       continue;
@@ -131,54 +160,85 @@ FontCollection::GetMinikinFontCollectionForFamily(const std::string& family) {
     auto minikin_family =
         std::make_shared<minikin::FontFamily>(std::move(minikin_fonts));
 
-    // Create a vector of font families for the Minikin font collection.
-    std::vector<std::shared_ptr<minikin::FontFamily>> minikin_families = {
-        minikin_family,
-    };
-    if (enable_font_fallback_) {
-      for (const auto& fallback : fallback_fonts_)
-        minikin_families.push_back(fallback.second);
-    }
-
-    // Create the minikin font collection.
     auto font_collection =
-        std::make_shared<minikin::FontCollection>(std::move(minikin_families));
-    if (enable_font_fallback_) {
-      font_collection->set_fallback_font_provider(
-          std::make_unique<TxtFallbackFontProvider>(shared_from_this()));
-    }
+        CreateMinikinFontCollectionLocked(minikin_family, nullptr);
 
     // Cache the font collection for future queries.
-    font_collections_cache_[family] = font_collection;
+    font_collections_cache_[family] = {minikin_family, font_collection,
+                                       fallback_fonts_.size()};
 
     return font_collection;
   }
 
   const auto default_font_family = GetDefaultFontFamily();
   if (family != default_font_family) {
-    return GetMinikinFontCollectionForFamily(default_font_family);
+    return GetMinikinFontCollectionForFamilyLocked(default_font_family);
   }
 
   // No match found in any of our font managers.
   return nullptr;
 }
 
+std::shared_ptr<minikin::FontCollection>
+FontCollection::CreateMinikinFontCollectionLocked(
+    const std::shared_ptr<minikin::FontFamily>& primary_family,
+    const std::shared_ptr<minikin::FontCollection>& previous) {
+  // Create a vector of font families for the Minikin font collection.
+  std::vector<std::shared_ptr<minikin::FontFamily>> minikin_families = {
+      primary_family,
+  };
+  if (enable_font_fallback_) {
+    for (const auto& fallback : fallback_fonts_)
+      minikin_families.push_back(fallback.second);
+  }
+
+  // Create the minikin font collection.
+  std::shared_ptr<minikin::FontCollection> font_collection;
+  if (previous) {
+    font_collection = previous->createCollectionWithFamilies(minikin_families);
+  } else {
+    font_collection =
+        std::make_shared<minikin::FontCollection>(std::move(minikin_families));
+  }
+  if (enable_font_fallback_) {
+    font_collection->set_fallback_font_provider(
+        std::make_unique<TxtFallbackFontProvider>(shared_from_this()));
+  }
+  return font_collection;
+}
+
 const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
     uint32_t ch) {
-  for (const sk_sp<SkFontMgr>& manager : GetFontManagerOrder()) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Querying the font managers is expensive, so remember the outcome for each
+  // character, including the characters that no font can render.
+  auto cached = fallback_match_cache_.find(ch);
+  if (cached != fallback_match_cache_.end()) {
+    return *cached->second;
+  }
+
+  const std::shared_ptr<minikin::FontFamily>* match = &null_family_;
+  for (const sk_sp<SkFontMgr>& manager : GetFontManagerOrderLocked()) {
     sk_sp<SkTypeface> typeface(
         manager->matchFamilyStyleCharacter(0, SkFontStyle(), nullptr, 0, ch));
     if (!typeface)
       continue;
 
-    return GetFontFamilyForTypeface(typeface);
+    match = &GetFontFamilyForTypefaceLocked(typeface);
+    break;
   }
 
-  return null_family_;
+  if (fallback_match_cache_.size() >= kMaxFallbackMatches) {
+    fallback_match_cache_.clear();
+  }
+  fallback_match_cache_[ch] = match;
+  return *match;
 }
 
 const std::shared_ptr<minikin::FontFamily>&
-FontCollection::GetFontFamilyForTypeface(const sk_sp<SkTypeface>& typeface) {
+FontCollection::GetFontFamilyForTypefaceLocked(
+    const sk_sp<SkTypeface>& typeface) {
   SkFontID typeface_id = typeface->uniqueID();
   auto fallback_it = fallback_fonts_.find(typeface_id);
   if (fallback_it != fallback_fonts_.end()) {
@@ -192,19 +252,15 @@ FontCollection::GetFontFamilyForTypeface(const sk_sp<SkTypeface>& typeface) {
       typeface_id,
       std::make_shared<minikin::FontFamily>(std::move(minikin_fonts))));
 
-  // Clear the cache to force creation of new font collections that will include
-  // this fallback font.
-  font_collections_cache_.clear();
-
   return insert_it.first->second;
 }
 
-void FontCollection::UpdateFallbackFonts(sk_sp<SkFontMgr> manager) {
+void FontCollection::UpdateFallbackFontsLocked(sk_sp<SkFontMgr> manager) {
   for (const std::string& family : last_resort_fonts) {
     sk_sp<SkTypeface> typeface(
         manager->matchFamilyStyle(family.c_str(), SkFontStyle()));
     if (typeface) {
-      GetFontFamilyForTypeface(typeface);
+      GetFontFamilyForTypefaceLocked(typeface);
     }
   }
 }
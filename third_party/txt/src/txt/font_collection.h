@@ -20,6 +20,7 @@
 #include <deque>
 #include <memory>
 #include <string>
+#include <mutex>
 #include <unordered_map>
 #include "lib/fxl/macros.h"
 #include "minikin/FontCollection.h"
@@ -53,22 +54,54 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   void DisableFontFallback();
 
  private:
+  // Guards all of the state below so that paragraphs may be laid out on more
+  // than one thread.
+  mutable std::mutex mutex_;
   sk_sp<SkFontMgr> default_font_manager_;
   sk_sp<SkFontMgr> asset_font_manager_;
   sk_sp<SkFontMgr> test_font_manager_;
-  std::unordered_map<std::string, std::shared_ptr<minikin::FontCollection>>
-      font_collections_cache_;
+
+  // A minikin font collection together with what it was built from. A new
+  // collection is built from |primary_family| when fallback fonts have been
+  // discovered since it was created.
+  struct CachedFontCollection {
+    std::shared_ptr<minikin::FontFamily> primary_family;
+    std::shared_ptr<minikin::FontCollection> collection;
+    size_t fallback_count;
+  };
+  std::unordered_map<std::string, CachedFontCollection> font_collections_cache_;
   std::unordered_map<SkFontID, std::shared_ptr<minikin::FontFamily>>
       fallback_fonts_;
+  // Results of |MatchFallbackFont| by code point. Characters that no font
+  // manager can render map to |null_family_| so that they are only looked up
+  // once. The values point into |fallback_fonts_| or at |null_family_|, which
+  // outlive any entry, so references handed out to minikin stay valid when
+  // this cache is cleared. The cache is cleared once it holds
+  // |kMaxFallbackMatches| code points, so that text with many code points
+  // that no font can render does not grow it without bound.
+  static constexpr size_t kMaxFallbackMatches = 1024;
+  std::unordered_map<uint32_t, const std::shared_ptr<minikin::FontFamily>*>
+      fallback_match_cache_;
   std::shared_ptr<minikin::FontFamily> null_family_;
   bool enable_font_fallback_;
 
-  std::vector<sk_sp<SkFontMgr>> GetFontManagerOrder() const;
+  std::vector<sk_sp<SkFontMgr>> GetFontManagerOrderLocked() const;
+
+  std::shared_ptr<minikin::FontCollection>
+  GetMinikinFontCollectionForFamilyLocked(const std::string& family);
 
-  const std::shared_ptr<minikin::FontFamily>& GetFontFamilyForTypeface(
+  const std::shared_ptr<minikin::FontFamily>& GetFontFamilyForTypefaceLocked(
       const sk_sp<SkTypeface>& typeface);
 
-  void UpdateFallbackFonts(sk_sp<SkFontMgr> manager);
+  // Creates a collection of |primary_family| followed by the fallback fonts.
+  // The collection replaces |previous| if it is not null.
+  std::shared_ptr<minikin::FontCollection> CreateMinikinFontCollectionLocked(
+      const std::shared_ptr<minikin::FontFamily>& primary_family,
+      const std::shared_ptr<minikin::FontCollection>& previous);
+
+  void UpdateFallbackFontsLocked(sk_sp<SkFontMgr> manager);
+
+  FRIEND_TEST(FontCollection, FallbackMatchesAreBounded);
 
   FXL_DISALLOW_COPY_AND_ASSIGN(FontCollection);
 };
@@ -84,6 +84,10 @@ hb_face_t* FontSkia::CreateHarfBuzzFace() const {
   return hb_face_create_for_tables(GetTable, typeface_.get(), 0);
 }
 
+size_t FontSkia::GetTableSize(uint32_t tag) const {
+  return typeface_->getTableSize(tag);
+}
+
 const std::vector<minikin::FontVariation>& FontSkia::GetAxes() const {
   return variations_;
 }
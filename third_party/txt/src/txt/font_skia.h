@@ -36,6 +36,8 @@ class FontSkia : public minikin::MinikinFont {
 
   hb_face_t* CreateHarfBuzzFace() const override;
 
+  size_t GetTableSize(uint32_t tag) const override;
+
   const std::vector<minikin::FontVariation>& GetAxes() const override;
 
   const sk_sp<SkTypeface>& GetSkTypeface() const;
@@ -18,9 +18,17 @@
 
 #include <hb.h>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <limits>
+#include <list>
 #include <map>
-#include <numeric>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -43,32 +51,227 @@
 namespace txt {
 namespace {
 
-const sk_sp<SkTypeface>& GetTypefaceForGlyph(const minikin::Layout& layout,
+// The glyphs of a run of text, assembled from separately laid out pieces of
+// the run in the same way minikin::Layout assembles cached words.
+class GlyphRun {
+ public:
+  explicit GlyphRun(size_t count) : advances_(count, 0), advance_(0) {}
+
+  // Appends the glyphs of |layout|, which laid out |count| code units starting
+  // at |offset| in the run.
+  void Append(const minikin::Layout& layout, size_t offset, size_t count) {
+    // minikin::Layout truncates the origin of every appended word to a whole
+    // pixel. Do the same so that the glyphs end up at the same positions.
+    int x0 = advance_;
+    for (size_t i = 0; i < layout.nGlyphs(); ++i) {
+      glyphs_.push_back({layout.getFont(i), layout.getGlyphId(i),
+                         x0 + layout.getX(i), layout.getY(i)});
+    }
+    for (size_t i = 0; i < count; ++i) {
+      advances_[offset + i] = layout.getCharAdvance(i);
+    }
+    advance_ += layout.getAdvance();
+  }
+
+  size_t nGlyphs() const { return glyphs_.size(); }
+  const minikin::MinikinFont* getFont(size_t i) const {
+    return glyphs_[i].font;
+  }
+  unsigned int getGlyphId(size_t i) const { return glyphs_[i].glyph_id; }
+  float getX(size_t i) const { return glyphs_[i].x; }
+  float getY(size_t i) const { return glyphs_[i].y; }
+  float getCharAdvance(size_t i) const { return advances_[i]; }
+  float getAdvance() const { return advance_; }
+
+  size_t getMemoryUsage() const {
+    return sizeof(GlyphRun) + glyphs_.capacity() * sizeof(Glyph) +
+           advances_.capacity() * sizeof(float);
+  }
+
+ private:
+  struct Glyph {
+    const minikin::MinikinFont* font;
+    unsigned int glyph_id;
+    float x;
+    float y;
+  };
+
+  std::vector<Glyph> glyphs_;
+  std::vector<float> advances_;
+  float advance_;
+};
+
+const sk_sp<SkTypeface>& GetTypefaceForGlyph(const GlyphRun& glyph_run,
                                              size_t index) {
-  const FontSkia* font = static_cast<const FontSkia*>(layout.getFont(index));
+  const FontSkia* font =
+      static_cast<const FontSkia*>(glyph_run.getFont(index));
   return font->GetSkTypeface();
 }
 
-// Return ranges of text that have the same typeface in the layout.
+// Return ranges of text that have the same typeface in the glyph run.
 std::vector<Paragraph::Range<size_t>> GetLayoutTypefaceRuns(
-    const minikin::Layout& layout) {
+    const GlyphRun& glyph_run) {
   std::vector<Paragraph::Range<size_t>> result;
-  if (layout.nGlyphs() == 0)
+  if (glyph_run.nGlyphs() == 0)
     return result;
   size_t run_start = 0;
-  const SkTypeface* run_typeface = GetTypefaceForGlyph(layout, run_start).get();
-  for (size_t i = 1; i < layout.nGlyphs(); ++i) {
-    const SkTypeface* typeface = GetTypefaceForGlyph(layout, i).get();
+  const SkTypeface* run_typeface =
+      GetTypefaceForGlyph(glyph_run, run_start).get();
+  for (size_t i = 1; i < glyph_run.nGlyphs(); ++i) {
+    const SkTypeface* typeface = GetTypefaceForGlyph(glyph_run, i).get();
     if (typeface != run_typeface) {
       result.emplace_back(run_start, i);
       run_start = i;
       run_typeface = typeface;
     }
   }
-  result.emplace_back(run_start, layout.nGlyphs());
+  result.emplace_back(run_start, glyph_run.nGlyphs());
   return result;
 }
 
+// A shaped run of text, split into groups of glyphs that share a typeface.
+// Cached runs also hold one text blob per group so that paragraphs showing
+// the same text in the same style share the blobs.
+struct ShapedRun {
+  explicit ShapedRun(GlyphRun&& run)
+      : glyph_run(std::move(run)),
+        glyph_blobs(GetLayoutTypefaceRuns(glyph_run)) {}
+
+  void BuildBlobs(SkPaint paint) {
+    SkTextBlobBuilder builder;
+    for (const Paragraph::Range<size_t>& glyph_blob : glyph_blobs) {
+      paint.setTypeface(GetTypefaceForGlyph(glyph_run, glyph_blob.start));
+      const SkTextBlobBuilder::RunBuffer& blob_buffer =
+          builder.allocRunPos(paint, glyph_blob.end - glyph_blob.start);
+      for (size_t glyph_index = glyph_blob.start; glyph_index < glyph_blob.end;
+           ++glyph_index) {
+        size_t blob_index = glyph_index - glyph_blob.start;
+        blob_buffer.glyphs[blob_index] = glyph_run.getGlyphId(glyph_index);
+        blob_buffer.pos[blob_index * 2] = glyph_run.getX(glyph_index);
+        blob_buffer.pos[blob_index * 2 + 1] = glyph_run.getY(glyph_index);
+      }
+      blobs.push_back(builder.make());
+    }
+  }
+
+  size_t getMemoryUsage() const {
+    // Each glyph of a blob stores its glyph id and position.
+    return sizeof(ShapedRun) + glyph_run.getMemoryUsage() +
+           glyph_blobs.capacity() * sizeof(Paragraph::Range<size_t>) +
+           blobs.size() * sizeof(SkTextBlob) +
+           glyph_run.nGlyphs() * (sizeof(uint16_t) + 2 * sizeof(SkScalar));
+  }
+
+  GlyphRun glyph_run;
+  std::vector<Paragraph::Range<size_t>> glyph_blobs;
+  std::vector<sk_sp<SkTextBlob>> blobs;
+};
+
+// Identifies a run of text and everything that affects how it is shaped.
+struct ShapedRunKey {
+  std::u16string text;
+  uint32_t collection_id;
+  minikin::FontStyle font;
+  float size;
+  float letter_spacing;
+  float word_spacing;
+  bool is_rtl;
+
+  bool operator==(const ShapedRunKey& other) const {
+    return text == other.text && collection_id == other.collection_id &&
+           font == other.font && size == other.size &&
+           letter_spacing == other.letter_spacing &&
+           word_spacing == other.word_spacing && is_rtl == other.is_rtl;
+  }
+};
+
+struct ShapedRunKeyHash {
+  size_t operator()(const ShapedRunKey& key) const {
+    size_t hash = std::hash<std::u16string>()(key.text);
+    hash = hash * 31 + key.collection_id;
+    hash = hash * 31 + key.font.hash();
+    hash = hash * 31 + std::hash<float>()(key.size);
+    hash = hash * 31 + std::hash<float>()(key.letter_spacing);
+    hash = hash * 31 + std::hash<float>()(key.word_spacing);
+    return hash * 31 + key.is_rtl;
+  }
+};
+
+// Runs longer than this are rarely repeated in other paragraphs, so they are
+// not worth keeping in the shaped run cache.
+const size_t kMaxCachedRunLength = 64;
+
+// Whether minikin::Layout splits the words it shapes at |offset|. Each word is
+// shaped together with the rest of the word around it, so only text between
+// two such offsets is shaped the same way regardless of the surrounding text.
+bool IsWordCacheBoundary(const std::vector<uint16_t>& text, size_t offset) {
+  if (offset == 0 || offset >= text.size())
+    return true;
+  return minikin::getPrevWordBreakForCache(text.data(), offset + 1,
+                                           text.size()) == offset;
+}
+
+// Shaped runs shared by all paragraphs, evicted in least recently used order
+// once they use more than the budget.
+class ShapedRunCache {
+ public:
+  ShapedRunCache() : bytes_(0) {}
+
+  std::shared_ptr<const ShapedRun> Get(const ShapedRunKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end())
+      return nullptr;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->run;
+  }
+
+  void Put(const ShapedRunKey& key, std::shared_ptr<const ShapedRun> run) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Another thread may have shaped the same run in the meantime.
+    if (index_.find(key) != index_.end())
+      return;
+    size_t bytes = sizeof(Entry) + key.text.size() * sizeof(char16_t) +
+                   run->getMemoryUsage();
+    entries_.push_front({key, std::move(run), bytes});
+    index_[key] = entries_.begin();
+    bytes_ += bytes;
+    while (bytes_ > kBudget && entries_.size() > 1) {
+      const Entry& oldest = entries_.back();
+      bytes_ -= oldest.bytes;
+      index_.erase(oldest.key);
+      entries_.pop_back();
+    }
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    entries_.clear();
+    bytes_ = 0;
+  }
+
+ private:
+  static const size_t kBudget = 1 * 1024 * 1024;
+
+  struct Entry {
+    ShapedRunKey key;
+    std::shared_ptr<const ShapedRun> run;
+    size_t bytes;
+  };
+
+  std::mutex mutex_;
+  std::list<Entry> entries_;
+  std::unordered_map<ShapedRunKey, std::list<Entry>::iterator, ShapedRunKeyHash>
+      index_;
+  size_t bytes_;
+};
+
+ShapedRunCache& GetShapedRunCache() {
+  static ShapedRunCache* cache = new ShapedRunCache();
+  return *cache;
+}
+
 int GetWeight(const FontWeight weight) {
   switch (weight) {
     case FontWeight::w100:
@@ -158,10 +361,75 @@ void FindWords(const std::vector<uint16_t>& text,
     words->emplace_back(word_start, end);
 }
 
+// The threads that break long paragraphs into lines, shared by all paragraphs.
+// Threads are started the first time they are needed and then reused by every
+// later layout.
+class LineBreakWorkers {
+ public:
+  static LineBreakWorkers& GetInstance() {
+    // Leaked so that the threads never outlive the pool.
+    static LineBreakWorkers* instance = new LineBreakWorkers();
+    return *instance;
+  }
+
+  // Runs |task| on |count| worker threads and on the calling thread, and
+  // returns once all of them have finished.
+  void RunAndWait(const std::function<void()>& task, size_t count) {
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t remaining = count;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (threads_started_ < count) {
+        std::thread(&LineBreakWorkers::Run, this).detach();
+        ++threads_started_;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        tasks_.push_back([&]() {
+          task();
+          std::lock_guard<std::mutex> done_lock(done_mutex);
+          if (--remaining == 0)
+            done_cv.notify_one();
+        });
+      }
+    }
+    cv_.notify_all();
+
+    task();
+
+    std::unique_lock<std::mutex> done_lock(done_mutex);
+    done_cv.wait(done_lock, [&]() { return remaining == 0; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  size_t threads_started_ = 0;
+
+  LineBreakWorkers() = default;
+
+  void Run() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !tasks_.empty(); });
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+};
+
 }  // namespace
 
 static const float kDoubleDecorationSpacing = 3.0f;
 
+// Text shorter than this is always broken into lines on the calling thread.
+static const size_t kMinParallelLineBreakSize = 64 * 1024;
+
 Paragraph::GlyphPosition::GlyphPosition(double x_start,
                                         double x_advance,
                                         size_t code_unit_index,
@@ -185,14 +453,26 @@ Paragraph::CodeUnitRun::CodeUnitRun(std::vector<GlyphPosition>&& p,
       font_metrics(metrics),
       direction(dir) {}
 
-Paragraph::Paragraph() {
+Paragraph::Paragraph()
+    : max_line_break_threads_(
+          std::max(1u, std::min(4u, std::thread::hardware_concurrency()))) {
   breaker_.setLocale(icu::Locale(), nullptr);
 }
 
 Paragraph::~Paragraph() = default;
 
+void Paragraph::PurgeShapedRunCache() {
+  GetShapedRunCache().Clear();
+}
+
+void Paragraph::SetMaxLineBreakThreads(size_t threads) {
+  max_line_break_threads_ = std::max<size_t>(threads, 1);
+}
+
 void Paragraph::SetText(std::vector<uint16_t> text, StyledRuns runs) {
   needs_layout_ = true;
+  needs_shaping_ = true;
+  word_boundaries_.clear();
   if (text.size() == 0)
     return;
   text_ = std::move(text);
@@ -203,6 +483,12 @@ bool Paragraph::ComputeLineBreaks() {
   line_ranges_.clear();
   line_widths_.clear();
 
+  // The widths of the characters do not depend on the width of the paragraph.
+  // Measure them once and only break the lines again on later layouts.
+  const bool measured = !char_widths_.empty();
+  if (!measured)
+    char_widths_.resize(text_.size());
+
   std::vector<size_t> newline_positions;
   for (size_t i = 0; i < text_.size(); ++i) {
     ULineBreak ulb = static_cast<ULineBreak>(
@@ -212,8 +498,100 @@ bool Paragraph::ComputeLineBreaks() {
   }
   newline_positions.push_back(text_.size());
 
+  // The blocks of text between hard line breaks are broken into lines
+  // independently of each other. Long text is split into chunks of blocks
+  // that are measured and broken on separate threads.
+  size_t thread_count = 1;
+  if (text_.size() >= kMinParallelLineBreakSize)
+    thread_count = std::min(max_line_break_threads_, newline_positions.size());
+  if (thread_count <= 1) {
+    if (!ComputeBlockLineBreaks(&breaker_, newline_positions, 0,
+                                newline_positions.size(), measured,
+                                &line_ranges_, &line_widths_)) {
+      char_widths_.clear();
+      return false;
+    }
+    return true;
+  }
+
+  // Use a few chunks per thread so that threads that finish early can pick up
+  // the remaining work.
+  struct Chunk {
+    size_t first_block;
+    size_t end_block;
+    std::vector<LineRange> line_ranges;
+    std::vector<double> line_widths;
+  };
+  std::vector<Chunk> chunks;
+  const size_t chunk_size = text_.size() / (thread_count * 4) + 1;
+  size_t chunk_first_block = 0;
+  size_t chunk_start = 0;
+  for (size_t i = 0; i < newline_positions.size(); ++i) {
+    if (newline_positions[i] + 1 - chunk_start >= chunk_size ||
+        i == newline_positions.size() - 1) {
+      chunks.push_back({chunk_first_block, i + 1, {}, {}});
+      chunk_first_block = i + 1;
+      chunk_start = newline_positions[i] + 1;
+    }
+  }
+
+  std::atomic<size_t> next_chunk(0);
+  std::atomic<bool> failed(false);
+  auto break_chunks = [&]() {
+    minikin::LineBreaker breaker;
+    breaker.setLocale(icu::Locale(), nullptr);
+    for (size_t i = next_chunk++; i < chunks.size(); i = next_chunk++) {
+      Chunk& chunk = chunks[i];
+      if (!ComputeBlockLineBreaks(&breaker, newline_positions,
+                                  chunk.first_block, chunk.end_block, measured,
+                                  &chunk.line_ranges, &chunk.line_widths)) {
+        failed = true;
+      }
+    }
+  };
+  LineBreakWorkers::GetInstance().RunAndWait(
+      break_chunks, std::min(thread_count, chunks.size()) - 1);
+
+  if (failed) {
+    char_widths_.clear();
+    return false;
+  }
+
+  for (const Chunk& chunk : chunks) {
+    line_ranges_.insert(line_ranges_.end(), chunk.line_ranges.begin(),
+                        chunk.line_ranges.end());
+    line_widths_.insert(line_widths_.end(), chunk.line_widths.begin(),
+                        chunk.line_widths.end());
+  }
+  return true;
+}
+
+bool Paragraph::ComputeBlockLineBreaks(
+    minikin::LineBreaker* breaker,
+    const std::vector<size_t>& newline_positions,
+    size_t first_block,
+    size_t end_block,
+    bool measured,
+    std::vector<LineRange>* line_ranges,
+    std::vector<double>* line_widths) {
+  if (first_block == end_block)
+    return true;
+
+  // Find the first styled run that ends at or after the start of the first
+  // block. This is where breaking the preceding blocks left off.
+  size_t first_block_start =
+      (first_block > 0) ? newline_positions[first_block - 1] + 1 : 0;
   size_t run_index = 0;
-  for (size_t newline_index = 0; newline_index < newline_positions.size();
+  size_t run_end = runs_.size();
+  while (run_index < run_end) {
+    size_t middle = (run_index + run_end) / 2;
+    if (runs_.GetRun(middle).end < first_block_start)
+      run_index = middle + 1;
+    else
+      run_end = middle;
+  }
+
+  for (size_t newline_index = first_block; newline_index < end_block;
        ++newline_index) {
     size_t block_start =
         (newline_index > 0) ? newline_positions[newline_index - 1] + 1 : 0;
@@ -221,18 +599,22 @@ bool Paragraph::ComputeLineBreaks() {
     size_t block_size = block_end - block_start;
 
     if (block_size == 0) {
-      line_ranges_.emplace_back(block_start, block_start, true);
-      line_widths_.push_back(0);
+      line_ranges->emplace_back(block_start, block_start, true);
+      line_widths->push_back(0);
       continue;
     }
 
-    breaker_.setLineWidths(0.0f, 0, width_);
-    breaker_.setJustified(paragraph_style_.text_align == TextAlign::justify);
-    breaker_.setStrategy(paragraph_style_.break_strategy);
-    breaker_.resize(block_size);
-    memcpy(breaker_.buffer(), text_.data() + block_start,
+    breaker->setLineWidths(0.0f, 0, width_);
+    breaker->setJustified(paragraph_style_.text_align == TextAlign::justify);
+    breaker->setStrategy(paragraph_style_.break_strategy);
+    breaker->resize(block_size);
+    memcpy(breaker->buffer(), text_.data() + block_start,
            block_size * sizeof(text_[0]));
-    breaker_.setText();
+    breaker->setText();
+    if (measured) {
+      memcpy(breaker->charWidths(), char_widths_.data() + block_start,
+             block_size * sizeof(char_widths_[0]));
+    }
 
     // Add the runs that include this line to the LineBreaker.
     while (run_index < runs_.size()) {
@@ -249,28 +631,40 @@ bool Paragraph::ComputeLineBreaks() {
       if (collection == nullptr) {
         FXL_LOG(INFO) << "Could not find font collection for family \""
                       << run.style.font_family << "\".";
+        breaker->finish();
         return false;
       }
       size_t run_start = std::max(run.start, block_start) - block_start;
       size_t run_end = std::min(run.end, block_end) - block_start;
       bool isRtl = (paragraph_style_.text_direction == TextDirection::rtl);
-      breaker_.addStyleRun(&paint, collection, font, run_start, run_end, isRtl);
+      if (measured) {
+        breaker->addMeasuredStyleRun(&paint, collection, font, run_start,
+                                     run_end, isRtl);
+      } else {
+        breaker->addStyleRun(&paint, collection, font, run_start, run_end,
+                             isRtl);
+      }
 
       if (run.end > block_end)
         break;
       run_index++;
     }
 
-    size_t breaks_count = breaker_.computeBreaks();
-    const int* breaks = breaker_.getBreaks();
+    if (!measured) {
+      memcpy(char_widths_.data() + block_start, breaker->charWidths(),
+             block_size * sizeof(char_widths_[0]));
+    }
+
+    size_t breaks_count = breaker->computeBreaks();
+    const int* breaks = breaker->getBreaks();
     for (size_t i = 0; i < breaks_count; ++i) {
       size_t break_start = (i > 0) ? breaks[i - 1] : 0;
-      line_ranges_.emplace_back(break_start + block_start,
+      line_ranges->emplace_back(break_start + block_start,
                                 breaks[i] + block_start, i == breaks_count - 1);
-      line_widths_.push_back(breaker_.getWidths()[i]);
+      line_widths->push_back(breaker->getWidths()[i]);
     }
 
-    breaker_.finish();
+    breaker->finish();
   }
 
   return true;
@@ -371,11 +765,18 @@ void Paragraph::Layout(double width, bool force) {
 
   width_ = width;
 
-  if (!ComputeLineBreaks())
-    return;
+  // Only line breaking and positioning depend on the width. The bidi runs,
+  // the widths of the characters and the shaped words are kept until the
+  // text or its styles change.
+  if (needs_shaping_) {
+    bidi_runs_.clear();
+    char_widths_.clear();
+    if (!ComputeBidiRuns(&bidi_runs_))
+      return;
+    needs_shaping_ = false;
+  }
 
-  std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
+  if (!ComputeLineBreaks())
     return;
 
   if (!grapheme_breaker_) {
@@ -396,6 +797,7 @@ void Paragraph::Layout(double width, bool force) {
   line_heights_.clear();
   glyph_lines_.clear();
   code_unit_runs_.clear();
+  line_code_unit_runs_.clear();
 
   minikin::Layout layout;
   SkTextBlobBuilder builder;
@@ -426,7 +828,7 @@ void Paragraph::Layout(double width, bool force) {
 
     // Find the runs comprising this line.
     std::vector<BidiRun> line_runs;
-    for (const BidiRun& bidi_run : bidi_runs) {
+    for (const BidiRun& bidi_run : bidi_runs_) {
       if (bidi_run.start() < line_range.end &&
           bidi_run.end() > line_range.start) {
         line_runs.emplace_back(std::max(bidi_run.start(), line_range.start),
@@ -499,15 +901,60 @@ void Paragraph::Layout(double width, bool force) {
         }
       }
 
-      layout.doLayout(text_ptr, text_start, text_count, text_.size(),
-                      run.is_rtl(), font, minikin_paint,
-                      minikin_font_collection);
+      // Runs that are not ellipsized are shared with other paragraphs that lay
+      // out the same text in the same style. A run that starts or ends in the
+      // middle of a word is shaped in the context of that word, so it is only
+      // shared if both of its ends are word boundaries.
+      std::shared_ptr<const ShapedRun> shaped_run;
+      if (ellipsized_text.empty()) {
+        bool cacheable = text_count <= kMaxCachedRunLength &&
+                         IsWordCacheBoundary(text_, run.start()) &&
+                         IsWordCacheBoundary(text_, run.end());
+        ShapedRunKey key;
+        if (cacheable) {
+          key = {std::u16string(text_.begin() + run.start(),
+                                text_.begin() + run.end()),
+                 minikin_font_collection->getId(),
+                 font,
+                 minikin_paint.size,
+                 minikin_paint.letterSpacing,
+                 minikin_paint.wordSpacing,
+                 run.is_rtl()};
+          shaped_run = GetShapedRunCache().Get(key);
+        }
+        if (!shaped_run) {
+          GlyphRun glyph_run(text_count);
+          layout.doLayout(text_ptr, text_start, text_count, text_.size(),
+                          run.is_rtl() ? minikin::kBidi_Force_RTL
+                                       : minikin::kBidi_Force_LTR,
+                          font, minikin_paint, minikin_font_collection);
+          glyph_run.Append(layout, 0, text_count);
+          auto new_run = std::make_shared<ShapedRun>(std::move(glyph_run));
+          if (cacheable && new_run->glyph_run.nGlyphs() != 0) {
+            new_run->BuildBlobs(paint);
+            GetShapedRunCache().Put(key, new_run);
+          }
+          shaped_run = std::move(new_run);
+        }
+      } else {
+        GlyphRun glyph_run(text_count);
+        layout.doLayout(text_ptr, text_start, text_count, text_.size(),
+                        run.is_rtl() ? minikin::kBidi_Force_RTL
+                                     : minikin::kBidi_Force_LTR,
+                        font, minikin_paint, minikin_font_collection);
+        glyph_run.Append(layout, 0, text_count);
+        shaped_run = std::make_shared<ShapedRun>(std::move(glyph_run));
+      }
 
-      if (layout.nGlyphs() == 0)
+      const GlyphRun& glyph_run = shaped_run->glyph_run;
+      if (glyph_run.nGlyphs() == 0)
         continue;
 
-      // Break the layout into blobs that share the same SkPaint parameters.
-      std::vector<Range<size_t>> glyph_blobs = GetLayoutTypefaceRuns(layout);
+      // The layout is broken into blobs that share the same SkPaint
+      // parameters. Cached blobs can be used as they are unless the glyphs
+      // are moved apart to justify the line.
+      const std::vector<Range<size_t>>& glyph_blobs = shaped_run->glyph_blobs;
+      bool use_cached_blobs = !justify_line && !shaped_run->blobs.empty();
 
       grapheme_breaker_->setText(
           icu::UnicodeString(false, text_ptr + text_start, text_count));
@@ -517,22 +964,30 @@ void Paragraph::Layout(double width, bool force) {
       double word_start_position = std::numeric_limits<double>::quiet_NaN();
 
       // Build a Skia text blob from each group of glyphs.
-      for (const Range<size_t>& glyph_blob : glyph_blobs) {
+      for (size_t blob_number = 0; blob_number < glyph_blobs.size();
+           ++blob_number) {
+        const Range<size_t>& glyph_blob = glyph_blobs[blob_number];
         std::vector<GlyphPosition> glyph_positions;
 
-        paint.setTypeface(GetTypefaceForGlyph(layout, glyph_blob.start));
-        const SkTextBlobBuilder::RunBuffer& blob_buffer =
-            builder.allocRunPos(paint, glyph_blob.end - glyph_blob.start);
+        paint.setTypeface(GetTypefaceForGlyph(glyph_run, glyph_blob.start));
+        const SkTextBlobBuilder::RunBuffer* blob_buffer =
+            use_cached_blobs
+                ? nullptr
+                : &builder.allocRunPos(paint,
+                                       glyph_blob.end - glyph_blob.start);
 
         for (size_t glyph_index = glyph_blob.start;
              glyph_index < glyph_blob.end; ++glyph_index) {
-          size_t blob_index = glyph_index - glyph_blob.start;
-          blob_buffer.glyphs[blob_index] = layout.getGlyphId(glyph_index);
-
-          size_t pos_index = blob_index * 2;
-          double glyph_x_offset = layout.getX(glyph_index) + justify_x_offset;
-          blob_buffer.pos[pos_index] = glyph_x_offset;
-          blob_buffer.pos[pos_index + 1] = layout.getY(glyph_index);
+          double glyph_x_offset =
+              glyph_run.getX(glyph_index) + justify_x_offset;
+          if (blob_buffer) {
+            size_t blob_index = glyph_index - glyph_blob.start;
+            blob_buffer->glyphs[blob_index] =
+                glyph_run.getGlyphId(glyph_index);
+            blob_buffer->pos[blob_index * 2] = glyph_x_offset;
+            blob_buffer->pos[blob_index * 2 + 1] =
+                glyph_run.getY(glyph_index);
+          }
 
           // The glyph may be a ligature.  Determine how many input characters
           // are joined into this glyph.  Note that each character may be
@@ -552,7 +1007,7 @@ void Paragraph::Layout(double width, bool force) {
               break;
             subglyph_code_unit_counts.push_back(glyph_code_units.width());
             while (glyph_code_units.end < static_cast<int32_t>(text_count)) {
-              if (layout.getCharAdvance(glyph_code_units.end) != 0)
+              if (glyph_run.getCharAdvance(glyph_code_units.end) != 0)
                 break;
               if (grapheme_breaker_->next() == icu::BreakIterator::DONE)
                 break;
@@ -561,7 +1016,8 @@ void Paragraph::Layout(double width, bool force) {
               glyph_code_units.end = grapheme_breaker_->current();
             }
           }
-          float glyph_advance = layout.getCharAdvance(glyph_code_units.start);
+          float glyph_advance =
+              glyph_run.getCharAdvance(glyph_code_units.start);
           float subglyph_advance =
               glyph_advance / subglyph_code_unit_counts.size();
 
@@ -604,9 +1060,10 @@ void Paragraph::Layout(double width, bool force) {
 
         SkPaint::FontMetrics metrics;
         paint.getFontMetrics(&metrics);
-        paint_records.emplace_back(run.style(), SkPoint::Make(run_x_offset, 0),
-                                   builder.make(), metrics, line_number,
-                                   layout.getAdvance());
+        paint_records.emplace_back(
+            run.style(), SkPoint::Make(run_x_offset, 0),
+            use_cached_blobs ? shaped_run->blobs[blob_number] : builder.make(),
+            metrics, line_number, glyph_run.getAdvance());
 
         line_glyph_positions.insert(line_glyph_positions.end(),
                                     glyph_positions.begin(),
@@ -626,7 +1083,7 @@ void Paragraph::Layout(double width, bool force) {
             line_number, metrics, run.direction());
       }
 
-      run_x_offset += layout.getAdvance();
+      run_x_offset += glyph_run.getAdvance();
     }
 
     double max_line_spacing = 0;
@@ -695,10 +1152,21 @@ void Paragraph::Layout(double width, bool force) {
     min_intrinsic_width_ = std::min(max_word_width, max_intrinsic_width_);
   }
 
-  std::sort(code_unit_runs_.begin(), code_unit_runs_.end(),
-            [](const CodeUnitRun& a, const CodeUnitRun& b) {
-              return a.code_units.start < b.code_units.start;
-            });
+  // The runs were added in visual order. Sort them by code unit index and
+  // index the runs of each line, which are contiguous because the lines are in
+  // code unit order too.
+  std::stable_sort(code_unit_runs_.begin(), code_unit_runs_.end(),
+                   [](const CodeUnitRun& a, const CodeUnitRun& b) {
+                     return a.code_units.start < b.code_units.start;
+                   });
+  line_code_unit_runs_.assign(glyph_lines_.size(), Range<size_t>(0, 0));
+  for (size_t i = code_unit_runs_.size(); i-- > 0;) {
+    Range<size_t>& line_runs =
+        line_code_unit_runs_[code_unit_runs_[i].line_number];
+    if (line_runs.end == 0)
+      line_runs.end = i + 1;
+    line_runs.start = i;
+  }
 }
 
 double Paragraph::GetLineXOffset(size_t line) {
@@ -755,11 +1223,13 @@ double Paragraph::GetMaxWidth() const {
 
 void Paragraph::SetParagraphStyle(const ParagraphStyle& style) {
   needs_layout_ = true;
+  needs_shaping_ = true;
   paragraph_style_ = style;
 }
 
 void Paragraph::SetFontCollection(
     std::shared_ptr<FontCollection> font_collection) {
+  needs_shaping_ = true;
   font_collection_ = std::move(font_collection);
 }
 
@@ -939,34 +1409,51 @@ std::vector<Paragraph::TextBox> Paragraph::GetRectsForRange(size_t start,
                                                             size_t end) const {
   std::vector<TextBox> boxes;
 
-  for (const CodeUnitRun& run : code_unit_runs_) {
-    if (run.code_units.start >= end)
+  // Start at the runs of the first line that ends after the start of the
+  // range. The runs are sorted by code unit index, so the ones that follow
+  // the range can be skipped.
+  size_t first_line =
+      std::upper_bound(line_ranges_.begin(),
+                       line_ranges_.begin() + line_code_unit_runs_.size(),
+                       start,
+                       [](size_t offset, const LineRange& line) {
+                         return offset < line.end;
+                       }) -
+      line_ranges_.begin();
+  for (size_t line = first_line; line < line_code_unit_runs_.size(); ++line) {
+    if (line_ranges_[line].start >= end)
       break;
-    if (run.code_units.end <= start)
-      continue;
+    const Range<size_t>& line_runs = line_code_unit_runs_[line];
+    for (size_t i = line_runs.start; i < line_runs.end; ++i) {
+      const CodeUnitRun& run = code_unit_runs_[i];
+      if (run.code_units.start >= end)
+        break;
+      if (run.code_units.end <= start)
+        continue;
 
-    double baseline = line_baselines_[run.line_number];
-    SkScalar top = baseline + run.font_metrics.fAscent;
-    SkScalar bottom = baseline + run.font_metrics.fDescent;
+      double baseline = line_baselines_[run.line_number];
+      SkScalar top = baseline + run.font_metrics.fAscent;
+      SkScalar bottom = baseline + run.font_metrics.fDescent;
 
-    SkScalar left, right;
-    if (run.code_units.start >= start && run.code_units.end <= end) {
-      left = run.x_pos.start;
-      right = run.x_pos.end;
-    } else {
-      left = SK_ScalarMax;
-      right = SK_ScalarMin;
-      for (const GlyphPosition& gp : run.positions) {
-        if (gp.code_units.start >= start && gp.code_units.end <= end) {
-          left = std::min(left, static_cast<SkScalar>(gp.x_pos.start));
-          right = std::max(right, static_cast<SkScalar>(gp.x_pos.end));
+      SkScalar left, right;
+      if (run.code_units.start >= start && run.code_units.end <= end) {
+        left = run.x_pos.start;
+        right = run.x_pos.end;
+      } else {
+        left = SK_ScalarMax;
+        right = SK_ScalarMin;
+        for (const GlyphPosition& gp : run.positions) {
+          if (gp.code_units.start >= start && gp.code_units.end <= end) {
+            left = std::min(left, static_cast<SkScalar>(gp.x_pos.start));
+            right = std::max(right, static_cast<SkScalar>(gp.x_pos.end));
+          }
         }
+        if (left == SK_ScalarMax || right == SK_ScalarMin)
+          continue;
       }
-      if (left == SK_ScalarMax || right == SK_ScalarMin)
-        continue;
+      boxes.emplace_back(SkRect::MakeLTRB(left, top, right, bottom),
+                         run.direction);
     }
-    boxes.emplace_back(SkRect::MakeLTRB(left, top, right, bottom),
-                       run.direction);
   }
 
   return boxes;
@@ -978,47 +1465,45 @@ Paragraph::PositionWithAffinity Paragraph::GetGlyphPositionAtCoordinate(
   if (line_heights_.empty())
     return PositionWithAffinity(0, DOWNSTREAM);
 
-  size_t y_index;
-  for (y_index = 0; y_index < line_heights_.size() - 1; ++y_index) {
-    if (dy < line_heights_[y_index])
-      break;
-  }
+  // |line_heights_| holds the bottom of each line, so the line containing |dy|
+  // is the first one whose bottom is below it. Points below the last line hit
+  // the last line.
+  size_t y_index =
+      std::upper_bound(line_heights_.begin(), line_heights_.end() - 1, dy) -
+      line_heights_.begin();
 
   const std::vector<GlyphPosition>& line_glyph_position =
       glyph_lines_[y_index].positions;
   if (line_glyph_position.empty()) {
-    int line_start_index =
-        std::accumulate(glyph_lines_.begin(), glyph_lines_.begin() + y_index, 0,
-                        [](const int a, const GlyphLine& b) {
-                          return a + static_cast<int>(b.total_code_units);
-                        });
-    return PositionWithAffinity(line_start_index, DOWNSTREAM);
-  }
-
-  size_t x_index;
-  const GlyphPosition* gp = nullptr;
-  for (x_index = 0; x_index < line_glyph_position.size(); ++x_index) {
-    double glyph_end = (x_index < line_glyph_position.size() - 1)
-                           ? line_glyph_position[x_index + 1].x_pos.start
-                           : line_glyph_position[x_index].x_pos.end;
-    if (dx < glyph_end) {
-      gp = &line_glyph_position[x_index];
-      break;
-    }
+    return PositionWithAffinity(line_ranges_[y_index].start, DOWNSTREAM);
   }
 
-  if (gp == nullptr) {
-    const GlyphPosition& last_glyph = line_glyph_position.back();
-    return PositionWithAffinity(last_glyph.code_units.end, UPSTREAM);
+  // A glyph extends to the start of the next glyph. Find the first glyph that
+  // ends after |dx|, which is the one before the first glyph starting after it.
+  auto next_glyph = std::upper_bound(
+      line_glyph_position.begin() + 1, line_glyph_position.end(), dx,
+      [](double x, const GlyphPosition& glyph) {
+        return x < glyph.x_pos.start;
+      });
+  const GlyphPosition* gp = &*(next_glyph - 1);
+  if (next_glyph == line_glyph_position.end() && dx >= gp->x_pos.end) {
+    return PositionWithAffinity(gp->code_units.end, UPSTREAM);
   }
 
-  // Find the direction of the run that contains this glyph.
+  // Find the direction of the run of this line that contains this glyph.
   TextDirection direction = TextDirection::ltr;
-  for (const CodeUnitRun& run : code_unit_runs_) {
-    if (gp->code_units.start >= run.code_units.start &&
-        gp->code_units.end <= run.code_units.end) {
-      direction = run.direction;
-      break;
+  const Range<size_t>& line_runs = line_code_unit_runs_[y_index];
+  auto line_runs_end = code_unit_runs_.begin() + line_runs.end;
+  auto run = std::upper_bound(
+      code_unit_runs_.begin() + line_runs.start, line_runs_end,
+      gp->code_units.start, [](size_t offset, const CodeUnitRun& run) {
+        return offset < run.code_units.start;
+      });
+  if (run != code_unit_runs_.begin() + line_runs.start) {
+    --run;
+    if (gp->code_units.start >= run->code_units.start &&
+        gp->code_units.end <= run->code_units.end) {
+      direction = run->direction;
     }
   }
 
@@ -1035,23 +1520,35 @@ Paragraph::Range<size_t> Paragraph::GetWordBoundary(size_t offset) const {
   if (text_.size() == 0)
     return Range<size_t>(0, 0);
 
-  if (!word_breaker_) {
-    UErrorCode status = U_ZERO_ERROR;
-    word_breaker_.reset(
-        icu::BreakIterator::createWordInstance(icu::Locale(), status));
-    if (!U_SUCCESS(status))
-      return Range<size_t>(0, 0);
-  }
+  // Find all of the word boundaries of the text once, so that repeated
+  // queries while a selection is being dragged are binary searches.
+  if (word_boundaries_.empty()) {
+    if (!word_breaker_) {
+      UErrorCode status = U_ZERO_ERROR;
+      word_breaker_.reset(
+          icu::BreakIterator::createWordInstance(icu::Locale(), status));
+      if (!U_SUCCESS(status))
+        return Range<size_t>(0, 0);
+    }
 
-  word_breaker_->setText(icu::UnicodeString(false, text_.data(), text_.size()));
+    word_breaker_->setText(
+        icu::UnicodeString(false, text_.data(), text_.size()));
+    for (int32_t boundary = word_breaker_->first();
+         boundary != icu::BreakIterator::DONE;
+         boundary = word_breaker_->next()) {
+      word_boundaries_.push_back(boundary);
+    }
+  }
 
-  int32_t prev_boundary = word_breaker_->preceding(offset + 1);
-  int32_t next_boundary = word_breaker_->next();
-  if (prev_boundary == icu::BreakIterator::DONE)
-    prev_boundary = offset;
-  if (next_boundary == icu::BreakIterator::DONE)
-    next_boundary = offset;
-  return Range<size_t>(prev_boundary, next_boundary);
+  // The last boundary before |offset + 1| and the one following it.
+  auto next_boundary = std::lower_bound(word_boundaries_.begin(),
+                                        word_boundaries_.end(), offset + 1);
+  size_t prev = (next_boundary == word_boundaries_.begin())
+                    ? offset
+                    : *(next_boundary - 1);
+  size_t next =
+      (next_boundary == word_boundaries_.end()) ? offset : *next_boundary;
+  return Range<size_t>(prev, next);
 }
 
 size_t Paragraph::GetLineCount() const {
@@ -1064,6 +1561,8 @@ bool Paragraph::DidExceedMaxLines() const {
 
 void Paragraph::SetDirty(bool dirty) {
   needs_layout_ = dirty;
+  if (dirty)
+    needs_shaping_ = true;
 }
 
 }  // namespace txt
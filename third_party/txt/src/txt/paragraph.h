@@ -87,7 +87,9 @@ class Paragraph {
   // (10k+ characters) to ensure speedy layout.
   //
   // Layout calculates the positioning of all the glyphs. Must call this method
-  // before Painting and getting any statistics from this class.
+  // before Painting and getting any statistics from this class. Laying out the
+  // same text at a new width reuses the bidi runs and the character widths, and
+  // takes the shaped words from the minikin layout cache.
   void Layout(double width, bool force = false);
 
   // Paints the Laid out text onto the supplied SkCanvas at (x, y) offset from
@@ -148,6 +150,16 @@ class Paragraph {
   // truncated.
   bool DidExceedMaxLines() const;
 
+  // Sets the maximum number of threads that break very long text with hard
+  // line breaks into lines. The text between hard line breaks is measured and
+  // broken on separate threads, which are shared by all paragraphs. One keeps
+  // all of the work on the calling thread.
+  void SetMaxLineBreakThreads(size_t threads);
+
+  // Drops the shaped runs of text that are shared by all paragraphs. Later
+  // layouts shape their text again.
+  static void PurgeShapedRunCache();
+
   // Sets the needs_layout_ to dirty. When Layout() is called, a new Layout will
   // be performed when this is set to true. Can also be used to prevent a new
   // Layout from being calculated by setting to false.
@@ -168,6 +180,7 @@ class Paragraph {
   FRIEND_TEST(ParagraphTest, ItalicsParagraph);
   FRIEND_TEST(ParagraphTest, ChineseParagraph);
   FRIEND_TEST(ParagraphTest, DISABLED_ArabicParagraph);
+  FRIEND_TEST(ParagraphTest, HitTestingBidiParagraph);
   FRIEND_TEST(ParagraphTest, SpacingParagraph);
   FRIEND_TEST(ParagraphTest, LongWordParagraph);
   FRIEND_TEST(ParagraphTest, KernScaleParagraph);
@@ -175,7 +188,12 @@ class Paragraph {
   FRIEND_TEST_WINDOWS_DISABLED(ParagraphTest, EmojiParagraph);
   FRIEND_TEST(ParagraphTest, HyphenBreakParagraph);
   FRIEND_TEST(ParagraphTest, RepeatLayoutParagraph);
+  FRIEND_TEST(ParagraphTest, RelayoutMatchesNewLayout);
   FRIEND_TEST(ParagraphTest, Ellipsize);
+  FRIEND_TEST(ParagraphTest, ParallelLineBreaks);
+  FRIEND_TEST(ParagraphTest, InternedStyles);
+  FRIEND_TEST(ParagraphTest, SharedShapedRuns);
+  FRIEND_TEST(ParagraphTest, SharedShapedRunsKeepWordContext);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -184,8 +202,12 @@ class Paragraph {
   std::shared_ptr<FontCollection> font_collection_;
 
   minikin::LineBreaker breaker_;
+  size_t max_line_break_threads_;
   std::unique_ptr<icu::BreakIterator> grapheme_breaker_;
   mutable std::unique_ptr<icu::BreakIterator> word_breaker_;
+  // The word boundaries of |text_| in ascending order, found on the first call
+  // to GetWordBoundary().
+  mutable std::vector<size_t> word_boundaries_;
 
   struct LineRange {
     LineRange(size_t s, size_t e, bool h) : start(s), end(e), hard_break(h) {}
@@ -219,6 +241,14 @@ class Paragraph {
     const TextStyle* style_;
   };
 
+  // Results of the parts of Layout() that do not depend on the width. They
+  // are kept across Layout() calls and recomputed once the text, the styles or
+  // the font collection change.
+  std::vector<BidiRun> bidi_runs_;
+  // The widths of the characters as measured for line breaking.
+  std::vector<float> char_widths_;
+  bool needs_shaping_ = true;
+
   struct GlyphPosition {
     Range<size_t> code_units;
     Range<double> x_pos;
@@ -261,6 +291,9 @@ class Paragraph {
   // Sorted in code unit index order.
   std::vector<CodeUnitRun> code_unit_runs_;
 
+  // The range of |code_unit_runs_| that belongs to each laid out line.
+  std::vector<Range<size_t>> line_code_unit_runs_;
+
   // The max width of the paragraph as provided in the most recent Layout()
   // call.
   double width_ = -1.0f;
@@ -292,6 +325,18 @@ class Paragraph {
   // Break the text into lines.
   bool ComputeLineBreaks();
 
+  // Breaks the text of the blocks [first_block, end_block) into lines. Block i
+  // ends at newline_positions[i] and starts after the previous one. This only
+  // writes to the parts of the paragraph's state that belong to the blocks,
+  // so disjoint blocks may be broken on different threads.
+  bool ComputeBlockLineBreaks(minikin::LineBreaker* breaker,
+                              const std::vector<size_t>& newline_positions,
+                              size_t first_block,
+                              size_t end_block,
+                              bool measured,
+                              std::vector<LineRange>* line_ranges,
+                              std::vector<double>* line_widths);
+
   // Break the text into runs based on LTR/RTL text direction.
   bool ComputeBidiRuns(std::vector<BidiRun>* result);
 
@@ -39,7 +39,14 @@ void ParagraphBuilder::SetParagraphStyle(const ParagraphStyle& style) {
 }
 
 void ParagraphBuilder::PushStyle(const TextStyle& style) {
-  size_t style_index = runs_.AddStyle(style);
+  PushStyleIndex(runs_.AddStyle(style));
+}
+
+void ParagraphBuilder::PushStyle(TextStyle&& style) {
+  PushStyleIndex(runs_.AddStyle(std::move(style)));
+}
+
+void ParagraphBuilder::PushStyleIndex(size_t style_index) {
   style_stack_.push_back(style_index);
   runs_.StartRun(style_index, text_.size());
 }
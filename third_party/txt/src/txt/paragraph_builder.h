@@ -37,8 +37,10 @@ class ParagraphBuilder {
   ~ParagraphBuilder();
 
   // Push a style to the stack. The corresponding text added with AddText will
-  // use the top-most style.
+  // use the top-most style. Equal styles are only stored once, so a style that
+  // is moved in is not copied.
   void PushStyle(const TextStyle& style);
+  void PushStyle(TextStyle&& style);
 
   // Remove a style from the stack. Useful to apply different styles to chunks
   // of text such as bolding.
@@ -82,6 +84,8 @@ class ParagraphBuilder {
 
   size_t PeekStyleIndex() const;
 
+  void PushStyleIndex(size_t style_index);
+
   FXL_DISALLOW_COPY_AND_ASSIGN(ParagraphBuilder);
 };
 
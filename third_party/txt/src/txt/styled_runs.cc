@@ -16,10 +16,32 @@
 
 #include "styled_runs.h"
 
+#include <functional>
+#include <string>
+
 #include "lib/fxl/logging.h"
 #include "utils/WindowsUtils.h"
 
 namespace txt {
+namespace {
+
+size_t HashStyle(const TextStyle& style) {
+  size_t hash = std::hash<std::string>()(style.font_family);
+  hash = hash * 31 + style.color;
+  hash = hash * 31 + style.decoration;
+  hash = hash * 31 + style.decoration_color;
+  hash = hash * 31 + static_cast<size_t>(style.decoration_style);
+  hash = hash * 31 + std::hash<double>()(style.decoration_thickness_multiplier);
+  hash = hash * 31 + static_cast<size_t>(style.font_weight);
+  hash = hash * 31 + static_cast<size_t>(style.font_style);
+  hash = hash * 31 + static_cast<size_t>(style.text_baseline);
+  hash = hash * 31 + std::hash<double>()(style.font_size);
+  hash = hash * 31 + std::hash<double>()(style.letter_spacing);
+  hash = hash * 31 + std::hash<double>()(style.word_spacing);
+  return hash * 31 + std::hash<double>()(style.height);
+}
+
+}  // namespace
 
 StyledRuns::StyledRuns() = default;
 
@@ -27,32 +49,62 @@ StyledRuns::~StyledRuns() = default;
 
 StyledRuns::StyledRuns(StyledRuns&& other) {
   styles_.swap(other.styles_);
+  style_indices_.swap(other.style_indices_);
   runs_.swap(other.runs_);
 }
 
 const StyledRuns& StyledRuns::operator=(StyledRuns&& other) {
   styles_.swap(other.styles_);
+  style_indices_.swap(other.style_indices_);
   runs_.swap(other.runs_);
   return *this;
 }
 
 void StyledRuns::swap(StyledRuns& other) {
   styles_.swap(other.styles_);
+  style_indices_.swap(other.style_indices_);
   runs_.swap(other.runs_);
 }
 
 size_t StyledRuns::AddStyle(const TextStyle& style) {
-  const size_t style_index = styles_.size();
-  styles_.push_back(style);
+  const size_t hash = HashStyle(style);
+  const size_t style_index = FindStyle(style, hash);
+  if (style_index == styles_.size()) {
+    styles_.push_back(style);
+    style_indices_.emplace(hash, style_index);
+  }
   return style_index;
 }
 
+size_t StyledRuns::AddStyle(TextStyle&& style) {
+  const size_t hash = HashStyle(style);
+  const size_t style_index = FindStyle(style, hash);
+  if (style_index == styles_.size()) {
+    styles_.push_back(std::move(style));
+    style_indices_.emplace(hash, style_index);
+  }
+  return style_index;
+}
+
+size_t StyledRuns::FindStyle(const TextStyle& style, size_t hash) const {
+  auto range = style_indices_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (styles_[it->second].equals(style))
+      return it->second;
+  }
+  return styles_.size();
+}
+
 const TextStyle& StyledRuns::GetStyle(size_t style_index) const {
   return styles_[style_index];
 }
 
 void StyledRuns::StartRun(size_t style_index, size_t start) {
   EndRunIfNeeded(start);
+  // Styles are interned, so equal styles have equal indices.
+  if (!runs_.empty() && runs_.back().style_index == style_index &&
+      runs_.back().end == start)
+    return;
   runs_.push_back(IndexedRun{style_index, start, start});
 }
 
@@ -18,6 +18,7 @@
 #define LIB_TXT_SRC_STYLED_RUNS_H_
 
 #include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "text_style.h"
@@ -48,10 +49,15 @@ class StyledRuns {
 
   void swap(StyledRuns& other);
 
+  // Returns the index of a style equal to |style|, adding it if no such style
+  // was added before. Runs with equal styles therefore share an index.
   size_t AddStyle(const TextStyle& style);
+  size_t AddStyle(TextStyle&& style);
 
   const TextStyle& GetStyle(size_t style_index) const;
 
+  // Starts a run at |start|. If the previous run has the same style and ends
+  // at |start|, it is extended instead.
   void StartRun(size_t style_index, size_t start);
 
   void EndRunIfNeeded(size_t end);
@@ -79,6 +85,7 @@ class StyledRuns {
   FRIEND_TEST(ParagraphTest, HyphenBreakParagraph);
   FRIEND_TEST(ParagraphTest, RepeatLayoutParagraph);
   FRIEND_TEST(ParagraphTest, Ellipsize);
+  FRIEND_TEST(ParagraphTest, InternedStyles);
 
   struct IndexedRun {
     size_t style_index = 0;
@@ -90,7 +97,13 @@ class StyledRuns {
   };
 
   std::vector<TextStyle> styles_;
+  // Indices into |styles_| by the hash of the style.
+  std::unordered_multimap<size_t, size_t> style_indices_;
   std::vector<IndexedRun> runs_;
+
+  // Returns the index of a style equal to |style|, whose hash is |hash|, or
+  // the number of styles if there is none.
+  size_t FindStyle(const TextStyle& style, size_t hash) const;
 };
 
 }  // namespace txt
@@ -39,8 +39,12 @@ bool TextStyle::equals(const TextStyle& other) const {
     return false;
   if (font_style != other.font_style)
     return false;
+  if (text_baseline != other.text_baseline)
+    return false;
   if (font_family != other.font_family)
     return false;
+  if (font_size != other.font_size)
+    return false;
   if (letter_spacing != other.letter_spacing)
     return false;
   if (word_spacing != other.word_spacing)
@@ -51,4 +51,39 @@ TEST(SparseBitSetTest, randomTest) {
   }
 }
 
+TEST(SparseBitSetTest, countCoveredPrefix) {
+  const uint32_t kRanges[] = {'a', 'z' + 1, 0x4E00, 0x9FA0, 0x10000, 0x10100};
+  SparseBitSet bitset(kRanges, 3);
+
+  const uint16_t kLatin[] = {'a', 'b', 'c', 'A', 'd'};
+  EXPECT_EQ(3u, bitset.countCoveredPrefix(kLatin, 5));
+  EXPECT_EQ(2u, bitset.countCoveredPrefix(kLatin, 2));
+  EXPECT_EQ(0u, bitset.countCoveredPrefix(kLatin + 3, 2));
+  EXPECT_EQ(0u, bitset.countCoveredPrefix(kLatin, 0));
+
+  // Runs that cross pages.
+  const uint16_t kMixed[] = {'x', 0x4E00, 0x4F00, 'y', 0x9FA0};
+  EXPECT_EQ(4u, bitset.countCoveredPrefix(kMixed, 5));
+
+  // Surrogates always end the prefix, even if the code point is in the set.
+  const uint16_t kSupplementary[] = {'a', 0xD800, 0xDC00};
+  EXPECT_EQ(1u, bitset.countCoveredPrefix(kSupplementary, 3));
+
+  // Values below the end of the set that are not in it.
+  const uint16_t kUncovered[] = {'a', 0xFFFF};
+  EXPECT_EQ(1u, bitset.countCoveredPrefix(kUncovered, 2));
+
+  // Values at and past the end of the set.
+  const uint32_t kLatinRange[] = {'a', 'z' + 1};
+  SparseBitSet latin(kLatinRange, 1);
+  ASSERT_EQ(static_cast<uint32_t>('z' + 1), latin.length());
+  const uint16_t kBeyond[] = {'y', 'z', '{', 'a'};
+  EXPECT_EQ(2u, latin.countCoveredPrefix(kBeyond, 4));
+  const uint16_t kFarBeyond[] = {'a', 0x4E00};
+  EXPECT_EQ(1u, latin.countCoveredPrefix(kFarBeyond, 2));
+
+  SparseBitSet empty;
+  EXPECT_EQ(0u, empty.countCoveredPrefix(kLatin, 5));
+}
+
 }  // namespace minikin
@@ -17,11 +17,108 @@
 #include "gtest/gtest.h"
 #include "lib/fxl/command_line.h"
 #include "lib/fxl/logging.h"
+#include "third_party/skia/include/core/SkTypeface.h"
+#include "txt/asset_font_manager.h"
+#include "txt/directory_asset_data_provider.h"
 #include "txt/font_collection.h"
 #include "utils.h"
 
 namespace txt {
 
+namespace {
+
+// A font manager for the test fonts that counts the fallback font queries. It
+// matches |fallback_character| with |fallback_family| and no other character.
+class CountingFontManager : public AssetFontManager {
+ public:
+  CountingFontManager(SkUnichar fallback_character,
+                      std::string fallback_family)
+      : AssetFontManager(
+            std::make_unique<DirectoryAssetDataProvider>(GetFontDir())),
+        fallback_character_(fallback_character),
+        fallback_family_(std::move(fallback_family)),
+        match_count_(0) {}
+
+  int match_count() const { return match_count_; }
+
+ private:
+  SkUnichar fallback_character_;
+  std::string fallback_family_;
+  mutable int match_count_;
+
+  // |SkFontMgr|
+  SkTypeface* onMatchFamilyStyleCharacter(const char familyName[],
+                                          const SkFontStyle& style,
+                                          const char* bcp47[],
+                                          int bcp47Count,
+                                          SkUnichar character) const override {
+    match_count_++;
+    if (character != fallback_character_)
+      return nullptr;
+    return matchFamilyStyle(fallback_family_.c_str(), style);
+  }
+};
+
+}  // namespace
+
+TEST(FontCollection, FallbackMissesAreCached) {
+  auto manager = sk_make_sp<CountingFontManager>(0x4E2D, "Homemade Apple");
+  auto font_collection = std::make_shared<FontCollection>();
+  font_collection->SetAssetFontManager(manager);
+
+  ASSERT_EQ(font_collection->MatchFallbackFont(0x1F600), nullptr);
+  ASSERT_EQ(font_collection->MatchFallbackFont(0x1F600), nullptr);
+  ASSERT_EQ(manager->match_count(), 1);
+
+  const auto& match = font_collection->MatchFallbackFont(0x4E2D);
+  ASSERT_NE(match, nullptr);
+  ASSERT_EQ(font_collection->MatchFallbackFont(0x4E2D), match);
+  ASSERT_EQ(manager->match_count(), 2);
+
+  // A new font manager may match characters that the previous ones did not.
+  font_collection->SetAssetFontManager(manager);
+  font_collection->MatchFallbackFont(0x1F600);
+  ASSERT_EQ(manager->match_count(), 3);
+}
+
+TEST(FontCollection, FallbackMatchesAreBounded) {
+  auto manager = sk_make_sp<CountingFontManager>(0x4E2D, "Homemade Apple");
+  auto font_collection = std::make_shared<FontCollection>();
+  font_collection->SetAssetFontManager(manager);
+
+  const uint32_t first = 0xE000;
+  const int count = 4 * FontCollection::kMaxFallbackMatches;
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(font_collection->MatchFallbackFont(first + i), nullptr);
+    ASSERT_LE(font_collection->fallback_match_cache_.size(),
+              size_t{FontCollection::kMaxFallbackMatches});
+  }
+  ASSERT_EQ(manager->match_count(), count);
+}
+
+TEST(FontCollection, CollectionsKeepTheirIdWhenFallbackFontsAreFound) {
+  auto manager = sk_make_sp<CountingFontManager>(0x4E2D, "Homemade Apple");
+  auto font_collection = std::make_shared<FontCollection>();
+  font_collection->SetAssetFontManager(manager);
+
+  auto roboto = font_collection->GetMinikinFontCollectionForFamily("Roboto");
+  ASSERT_NE(roboto, nullptr);
+  ASSERT_EQ(font_collection->GetMinikinFontCollectionForFamily("Roboto"),
+            roboto);
+
+  // Finding a fallback font extends the collection with the fallback font,
+  // without a new id that would invalidate the layouts cached for it.
+  ASSERT_NE(font_collection->MatchFallbackFont(0x4E2D), nullptr);
+  auto extended =
+      font_collection->GetMinikinFontCollectionForFamily("Roboto");
+  ASSERT_NE(extended, roboto);
+  ASSERT_EQ(extended->getId(), roboto->getId());
+
+  auto other = font_collection->GetMinikinFontCollectionForFamily(
+      "Homemade Apple");
+  ASSERT_NE(other->getId(), roboto->getId());
+}
+
 #if 0
 
 TEST(FontCollection, HasDefaultRegistrations) {
@@ -15,6 +15,7 @@
  */
 
 #include "lib/fxl/logging.h"
+#include "minikin/Layout.h"
 #include "render_test.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 #include "third_party/skia/include/core/SkColor.h"
@@ -934,6 +935,100 @@ TEST_F(ParagraphTest, GetGlyphPositionAtCoordinateParagraph) {
   ASSERT_EQ(paragraph->GetGlyphPositionAtCoordinate(85, 10000).position, 75ull);
 }
 
+TEST_F(ParagraphTest, HitTestingBidiParagraph) {
+  // Builds a paragraph that alternates between Latin and Arabic words, each
+  // in a font that covers it, and breaks it into a few lines.
+  auto build = [](const std::vector<std::u16string>& words,
+                  TextDirection direction) {
+    txt::ParagraphStyle paragraph_style;
+    paragraph_style.text_direction = direction;
+    txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+    txt::TextStyle latin_style;
+    latin_style.font_family = "Roboto";
+    latin_style.font_size = 30;
+    latin_style.color = SK_ColorBLACK;
+    txt::TextStyle arabic_style = latin_style;
+    arabic_style.font_family = "Katibeh";
+    for (const std::u16string& word : words) {
+      bool is_arabic = word[0] >= 0x600 && word[0] <= 0x6FF;
+      builder.PushStyle(is_arabic ? arabic_style : latin_style);
+      builder.AddText(word + u" ");
+      builder.Pop();
+    }
+    auto paragraph = builder.Build();
+    paragraph->Layout(300);
+    return paragraph;
+  };
+
+  auto check = [](const txt::Paragraph& paragraph) {
+    ASSERT_GT(paragraph.glyph_lines_.size(), 1ull);
+
+    // The direction of every code unit, found without relying on the order
+    // of the runs.
+    auto direction_at = [&](size_t offset, TextDirection* direction) {
+      for (const auto& run : paragraph.code_unit_runs_) {
+        if (offset >= run.code_units.start && offset < run.code_units.end) {
+          *direction = run.direction;
+          return true;
+        }
+      }
+      return false;
+    };
+
+    size_t rtl_count = 0;
+    for (size_t i = 0; i < paragraph.text_.size(); ++i) {
+      TextDirection direction;
+      if (!direction_at(i, &direction))
+        continue;
+      if (direction == TextDirection::rtl)
+        rtl_count++;
+      auto boxes = paragraph.GetRectsForRange(i, i + 1);
+      for (const auto& box : boxes)
+        ASSERT_EQ(box.direction, direction);
+    }
+    ASSERT_GT(rtl_count, 0ull);
+
+    // Selecting all of the text gives one box per run.
+    ASSERT_EQ(paragraph.GetRectsForRange(0, paragraph.text_.size()).size(),
+              paragraph.code_unit_runs_.size());
+
+    // A point in the left quarter of a glyph is before it in a left-to-right
+    // run and after it in a right-to-left run.
+    for (size_t line = 0; line < paragraph.glyph_lines_.size(); ++line) {
+      double top = line > 0 ? paragraph.line_heights_[line - 1] : 0;
+      double y = (top + paragraph.line_heights_[line]) / 2;
+      for (const auto& gp : paragraph.glyph_lines_[line].positions) {
+        if (gp.x_pos.end - gp.x_pos.start < 1)
+          continue;
+        TextDirection direction;
+        ASSERT_TRUE(direction_at(gp.code_units.start, &direction));
+        auto position = paragraph.GetGlyphPositionAtCoordinate(
+            gp.x_pos.start + (gp.x_pos.end - gp.x_pos.start) / 4, y);
+        if (direction == TextDirection::ltr) {
+          ASSERT_EQ(position.position, gp.code_units.start);
+          ASSERT_EQ(position.affinity, txt::Paragraph::DOWNSTREAM);
+        } else {
+          ASSERT_EQ(position.position, gp.code_units.end);
+          ASSERT_EQ(position.affinity, txt::Paragraph::UPSTREAM);
+        }
+      }
+    }
+  };
+
+  const std::u16string latin = u"Hello";
+  const std::u16string arabic = u"مرحبا";
+
+  // Right-to-left text.
+  check(*build({arabic, arabic, arabic, arabic, arabic, arabic},
+               TextDirection::rtl));
+  // Mixed directions in a left-to-right paragraph.
+  check(*build({latin, arabic, arabic, latin, arabic, latin, arabic, arabic},
+               TextDirection::ltr));
+  // Mixed directions in a right-to-left paragraph.
+  check(*build({arabic, latin, latin, arabic, latin, arabic, latin, latin},
+               TextDirection::rtl));
+}
+
 TEST_F(ParagraphTest, DISABLE_ON_WINDOWS(GetRectsForRangeParagraph)) {
   const char* text =
       "12345,  \"67890\" 12345 67890 12345 67890 12345 67890 12345 67890 12345 "
@@ -1529,6 +1624,65 @@ TEST_F(ParagraphTest, RepeatLayoutParagraph) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, RelayoutMatchesNewLayout) {
+  const char* text =
+      "Sentence to layout at diff widths to get diff line counts. short words "
+      "short words short words short words short words short words short words "
+      "end";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.break_strategy = minikin::kBreakStrategy_HighQuality;
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.font_size = 31;
+  text_style.color = SK_ColorBLACK;
+
+  auto build = [&]() {
+    txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    return builder.Build();
+  };
+
+  // Laying out again at another width reuses the bidi runs and character
+  // widths of the first layout and must give the same result as laying out
+  // from scratch.
+  auto relaid_out = build();
+  relaid_out->Layout(300);
+  ASSERT_FALSE(relaid_out->needs_shaping_);
+  ASSERT_FALSE(relaid_out->char_widths_.empty());
+  relaid_out->Layout(550);
+
+  auto laid_out = build();
+  laid_out->Layout(550);
+
+  ASSERT_EQ(relaid_out->GetLineCount(), laid_out->GetLineCount());
+  ASSERT_EQ(relaid_out->GetHeight(), laid_out->GetHeight());
+  ASSERT_EQ(relaid_out->GetMaxIntrinsicWidth(),
+            laid_out->GetMaxIntrinsicWidth());
+  ASSERT_EQ(relaid_out->glyph_lines_.size(), laid_out->glyph_lines_.size());
+  for (size_t i = 0; i < laid_out->glyph_lines_.size(); ++i) {
+    const auto& expected = laid_out->glyph_lines_[i].positions;
+    const auto& actual = relaid_out->glyph_lines_[i].positions;
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t j = 0; j < expected.size(); ++j) {
+      ASSERT_TRUE(actual[j].code_units == expected[j].code_units);
+      ASSERT_EQ(actual[j].x_pos.start, expected[j].x_pos.start);
+      ASSERT_EQ(actual[j].x_pos.end, expected[j].x_pos.end);
+    }
+  }
+
+  // Marking the paragraph dirty measures the characters again.
+  relaid_out->SetDirty();
+  ASSERT_TRUE(relaid_out->needs_shaping_);
+  relaid_out->Layout(550);
+  ASSERT_EQ(relaid_out->char_widths_, laid_out->char_widths_);
+}
+
 TEST_F(ParagraphTest, Ellipsize) {
   const char* text =
       "This is a very long sentence to test if the text will properly wrap "
@@ -1562,4 +1716,249 @@ TEST_F(ParagraphTest, Ellipsize) {
   ASSERT_EQ(paragraph->records_.size(), 1ull);
 }
 
+TEST_F(ParagraphTest, ParallelLineBreaks) {
+  const char* line =
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua.\n\n";
+  auto icu_line = icu::UnicodeString::fromUTF8(line);
+  std::u16string u16_line(icu_line.getBuffer(),
+                          icu_line.getBuffer() + icu_line.length());
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.color = SK_ColorBLACK;
+  txt::TextStyle bold_style = text_style;
+  bold_style.font_weight = txt::FontWeight::w700;
+
+  // Enough text to be broken on several threads, with styled runs that span
+  // hard line breaks.
+  auto build = [&]() {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+    for (size_t i = 0; i < 1000; ++i) {
+      builder.PushStyle(i % 3 == 0 ? bold_style : text_style);
+      builder.AddText(u16_line);
+      builder.Pop();
+    }
+    return builder.Build();
+  };
+
+  auto serial = build();
+  serial->SetMaxLineBreakThreads(1);
+  serial->Layout(GetTestCanvasWidth());
+
+  auto parallel = build();
+  parallel->SetMaxLineBreakThreads(4);
+  parallel->Layout(GetTestCanvasWidth());
+
+  ASSERT_GE(serial->text_.size(), 64ull * 1024);
+  ASSERT_EQ(serial->line_ranges_.size(), parallel->line_ranges_.size());
+  for (size_t i = 0; i < serial->line_ranges_.size(); ++i) {
+    ASSERT_EQ(serial->line_ranges_[i].start, parallel->line_ranges_[i].start);
+    ASSERT_EQ(serial->line_ranges_[i].end, parallel->line_ranges_[i].end);
+    ASSERT_EQ(serial->line_ranges_[i].hard_break,
+              parallel->line_ranges_[i].hard_break);
+  }
+  ASSERT_EQ(serial->line_widths_, parallel->line_widths_);
+  ASSERT_EQ(serial->char_widths_, parallel->char_widths_);
+  ASSERT_EQ(serial->GetHeight(), parallel->GetHeight());
+
+  // Relayout reuses the measured widths on every thread.
+  parallel->Layout(GetTestCanvasWidth() / 2);
+  serial->Layout(GetTestCanvasWidth() / 2);
+  ASSERT_EQ(serial->line_widths_, parallel->line_widths_);
+}
+
+TEST_F(ParagraphTest, InternedStyles) {
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle bold_style;
+  bold_style.font_family = "Roboto";
+  bold_style.font_weight = txt::FontWeight::w700;
+  bold_style.color = SK_ColorBLACK;
+  txt::TextStyle larger_style = bold_style;
+  larger_style.font_size = 20;
+
+  builder.PushStyle(bold_style);
+  builder.AddText(u"Bold");
+  builder.Pop();
+  builder.PushStyle(bold_style);
+  builder.AddText(u" still bold");
+  builder.Pop();
+  builder.PushStyle(larger_style);
+  builder.AddText(u" larger");
+  builder.Pop();
+
+  auto paragraph = builder.Build();
+
+  // The paragraph style, the bold style and the larger style.
+  ASSERT_EQ(paragraph->runs_.styles_.size(), 3ull);
+  // Adjacent runs with equal styles are merged.
+  ASSERT_EQ(paragraph->runs_.size(), 2ull);
+  ASSERT_EQ(paragraph->runs_.GetRun(0).start, 0ull);
+  ASSERT_EQ(paragraph->runs_.GetRun(0).end, 15ull);
+  ASSERT_EQ(paragraph->runs_.GetRun(1).start, 15ull);
+  ASSERT_EQ(paragraph->runs_.GetRun(1).end, 22ull);
+  ASSERT_EQ(paragraph->runs_.GetRun(1).style.font_size, 20);
+
+  paragraph->Layout(GetTestCanvasWidth());
+  paragraph->Paint(GetCanvas(), 10.0, 15.0);
+  ASSERT_TRUE(Snapshot());
+}
+
+TEST_F(ParagraphTest, SharedShapedRuns) {
+  auto build = [](const std::u16string& text, double font_size) {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+    txt::TextStyle text_style;
+    text_style.font_family = "Roboto";
+    text_style.font_size = font_size;
+    text_style.color = SK_ColorBLACK;
+    builder.PushStyle(text_style);
+    builder.AddText(text);
+    builder.Pop();
+    auto paragraph = builder.Build();
+    paragraph->Layout(GetTestCanvasWidth());
+    return paragraph;
+  };
+
+  txt::Paragraph::PurgeShapedRunCache();
+  auto first = build(u"Delete", 14);
+  auto second = build(u"Delete", 14);
+  auto larger = build(u"Delete", 20);
+  auto other = build(u"Reply", 14);
+
+  ASSERT_EQ(first->records_.size(), 1ull);
+  ASSERT_EQ(second->records_.size(), 1ull);
+  ASSERT_EQ(larger->records_.size(), 1ull);
+  ASSERT_EQ(other->records_.size(), 1ull);
+
+  // Paragraphs with the same text and style share their text blobs.
+  ASSERT_EQ(first->records_[0].text(), second->records_[0].text());
+  ASSERT_NE(first->records_[0].text(), larger->records_[0].text());
+  ASSERT_NE(first->records_[0].text(), other->records_[0].text());
+
+  // Shared runs are positioned like runs laid out from scratch.
+  txt::Paragraph::PurgeShapedRunCache();
+  auto fresh = build(u"Delete", 14);
+  ASSERT_NE(first->records_[0].text(), fresh->records_[0].text());
+  ASSERT_EQ(first->records_[0].text()->bounds(),
+            fresh->records_[0].text()->bounds());
+  ASSERT_EQ(first->GetMaxIntrinsicWidth(), fresh->GetMaxIntrinsicWidth());
+
+  second->Paint(GetCanvas(), 10.0, 15.0);
+  ASSERT_TRUE(Snapshot());
+}
+
+TEST_F(ParagraphTest, SharedShapedRunsKeepWordContext) {
+  // Builds a paragraph of |prefix| followed by |text|, which is styled
+  // differently and so starts a new run in the middle of a word.
+  auto build = [](const std::u16string& prefix, const std::u16string& text,
+                  const std::string& font_family) {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+    txt::TextStyle text_style;
+    text_style.font_family = font_family;
+    text_style.font_size = 30;
+    text_style.color = SK_ColorBLACK;
+    txt::TextStyle prefix_style = text_style;
+    prefix_style.font_size = 20;
+    builder.PushStyle(prefix_style);
+    builder.AddText(prefix);
+    builder.Pop();
+    builder.PushStyle(text_style);
+    builder.AddText(text);
+    builder.Pop();
+    auto paragraph = builder.Build();
+    paragraph->Layout(GetTestCanvasWidth());
+    return paragraph;
+  };
+
+  auto check = [&](const std::u16string& prefix, const std::u16string& text,
+                   const std::string& font_family) {
+    // Shape |text| on its own first so that its run is in the cache.
+    txt::Paragraph::PurgeShapedRunCache();
+    build(u"", text, font_family);
+    auto joined = build(prefix, text, font_family);
+
+    txt::Paragraph::PurgeShapedRunCache();
+    auto fresh = build(prefix, text, font_family);
+
+    ASSERT_EQ(joined->records_.size(), fresh->records_.size());
+    for (size_t i = 0; i < joined->records_.size(); ++i) {
+      ASSERT_EQ(joined->records_[i].text()->bounds(),
+                fresh->records_[i].text()->bounds());
+    }
+    ASSERT_EQ(joined->glyph_lines_.size(), fresh->glyph_lines_.size());
+    for (size_t i = 0; i < joined->glyph_lines_.size(); ++i) {
+      const auto& joined_positions = joined->glyph_lines_[i].positions;
+      const auto& fresh_positions = fresh->glyph_lines_[i].positions;
+      ASSERT_EQ(joined_positions.size(), fresh_positions.size());
+      for (size_t j = 0; j < joined_positions.size(); ++j) {
+        ASSERT_EQ(joined_positions[j].x_pos.start,
+                  fresh_positions[j].x_pos.start);
+        ASSERT_EQ(joined_positions[j].x_pos.end, fresh_positions[j].x_pos.end);
+      }
+    }
+  };
+
+  // A style change in the middle of a word with a ligature across it.
+  check(u"of", u"fice", "Roboto");
+  // Joined Arabic letters, which take different forms inside a word than at
+  // its start.
+  check(u"\u0633", u"\u0644\u0627\u0645", "Katibeh");
+}
+
+TEST_F(ParagraphTest, LayoutCacheBudget) {
+  const char* text = "Cached words cached words cached words";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.color = SK_ColorBLACK;
+
+  auto build = [&]() {
+    txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    return builder.Build();
+  };
+
+  txt::Paragraph::PurgeShapedRunCache();
+  minikin::Layout::purgeCaches();
+  const minikin::CacheStats initial = minikin::Layout::getCacheStats();
+  ASSERT_EQ(initial.entries, 0ull);
+  ASSERT_EQ(initial.bytes, 0ull);
+
+  build()->Layout(GetTestCanvasWidth());
+  const minikin::CacheStats first = minikin::Layout::getCacheStats();
+  ASSERT_GT(first.misses, initial.misses);
+  ASSERT_GT(first.entries, 0ull);
+  ASSERT_GT(first.bytes, 0ull);
+  ASSERT_LE(first.bytes, first.budget);
+
+  // Laying out the same text again only hits the cache. Drop the shaped runs
+  // that paragraphs share so that the text is laid out by minikin again.
+  txt::Paragraph::PurgeShapedRunCache();
+  build()->Layout(GetTestCanvasWidth());
+  const minikin::CacheStats second = minikin::Layout::getCacheStats();
+  ASSERT_GT(second.hits, first.hits);
+  ASSERT_EQ(second.misses, first.misses);
+  ASSERT_EQ(second.bytes, first.bytes);
+
+  // Shrinking the budget evicts right away.
+  minikin::Layout::setCacheBudget(0);
+  const minikin::CacheStats trimmed = minikin::Layout::getCacheStats();
+  ASSERT_EQ(trimmed.entries, 0ull);
+  ASSERT_EQ(trimmed.bytes, 0ull);
+  ASSERT_GE(trimmed.evictions, second.evictions + second.entries);
+
+  minikin::Layout::setCacheBudget(first.budget);
+}
+
 }  // namespace txt